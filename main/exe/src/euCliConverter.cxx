@@ -2,16 +2,144 @@
 #include "eudaq/DataConverter.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/StdEventConverter.hh"
 #include <iostream>
 #include "eudaq/Utils.hh"
 
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace{
+  struct Job{
+    eudaq::EventSPC ev;
+    eudaq::PreparedEventSP prep;
+    bool done = false;
+  };
+
+  // One thread reads the events, n_worker threads prepare them for the
+  // writer (i.e. convert them) and the calling thread writes them in the
+  // order they were read. The events are handed to the workers in turn,
+  // except for those with a converter keeping a state per stream: all events
+  // of such a stream are prepared by the same worker in their order.
+  void ConvertParallel(eudaq::FileReaderUP &reader, eudaq::FileWriterUP &writer, size_t n_worker,
+		       size_t skip_events, size_t max_events, bool print_ev_in){
+    std::mutex mx;
+    std::condition_variable cv;
+    std::vector<std::deque<std::shared_ptr<Job>>> todo(n_worker);
+    std::deque<std::shared_ptr<Job>> order;
+    const size_t max_inflight = 64 * n_worker;
+    size_t next_worker = 0;
+    bool reading = true;
+    bool exiting = false;
+    std::string error;
+
+    std::thread reading_thread([&](){
+      try{
+	while(true){
+	  auto ev = reader->GetNextEvent();
+	  if(!ev)
+	    break;
+	  if(skip_events > 0 && ev->GetEventNumber() > 0 && ev->GetEventNumber() < skip_events)
+	    continue;
+	  if(print_ev_in)
+	    ev->Print(std::cout);
+	  auto job = std::make_shared<Job>();
+	  job->ev = ev;
+	  uint32_t stream;
+	  size_t worker = eudaq::StdEventConverter::FindStateStream(ev, stream) ?
+	    stream % n_worker : next_worker++ % n_worker;
+	  std::unique_lock<std::mutex> lk(mx);
+	  cv.wait(lk, [&](){return order.size() < max_inflight || exiting;});
+	  if(exiting)
+	    break;
+	  order.push_back(job);
+	  todo[worker].push_back(job);
+	  lk.unlock();
+	  cv.notify_all();
+	  if(max_events > 0 && ev->GetEventN() > max_events)
+	    break;
+	}
+      }catch(const std::exception &e){
+	std::unique_lock<std::mutex> lk(mx);
+	error = e.what();
+      }
+      std::unique_lock<std::mutex> lk(mx);
+      reading = false;
+      lk.unlock();
+      cv.notify_all();
+    });
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < n_worker; i++){
+      workers.emplace_back([&, i](){
+	auto &q = todo[i];
+	std::unique_lock<std::mutex> lk(mx);
+	while(true){
+	  cv.wait(lk, [&](){return !q.empty() || !reading || exiting;});
+	  if(q.empty()){
+	    if(!reading || exiting)
+	      break;
+	    continue;
+	  }
+	  auto job = q.front();
+	  q.pop_front();
+	  lk.unlock();
+	  eudaq::PreparedEventSP prep;
+	  std::string err;
+	  try{
+	    prep = writer->PrepareEvent(job->ev);
+	  }catch(const std::exception &e){
+	    err = e.what();
+	  }
+	  lk.lock();
+	  job->prep = prep;
+	  job->done = true;
+	  if(!err.empty())
+	    error = err;
+	  cv.notify_all();
+	}
+	eudaq::StdEventConverter::ReleaseThreadInstances();
+      });
+    }
+
+    std::unique_lock<std::mutex> lk(mx);
+    while(true){
+      cv.wait(lk, [&](){return (!order.empty() && order.front()->done) ||
+			  (order.empty() && !reading) || !error.empty();});
+      if(!error.empty() || order.empty())
+	break;
+      auto job = order.front();
+      order.pop_front();
+      lk.unlock();
+      cv.notify_all();
+      writer->WritePrepared(job->ev, job->prep);
+      if (job->ev->GetEventN() % 1000 == 0 and job->ev->GetEventN()) {
+	std::cout << "\r" << job->ev->GetEventN() << std::flush; }
+      lk.lock();
+    }
+    exiting = true;
+    std::string err = error;
+    lk.unlock();
+    cv.notify_all();
+    reading_thread.join();
+    for(auto &t: workers)
+      t.join();
+    if(!err.empty())
+      EUDAQ_THROW("Converter: " + err);
+  }
+}
+
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line DataConverter", "2.0", "The Data Converter launcher of EUDAQ");
   eudaq::Option<std::string> file_input(op, "i", "input", "", "string","input file");
   eudaq::Option<std::string> file_output(op, "o", "output", "", "string","output file");
+  eudaq::Option<std::string> type_input(op, "it", "input_type", "", "string", "input file type, overrides the file extension (e.g. native-mmap)");
   eudaq::OptionFlag iprint(op, "ip", "iprint", "enable print of input Event");
   eudaq::Option<size_t> max_events(op, "m", "max_events", 0, "maximum number of events to be converted");
   eudaq::Option<size_t> skip_events(op, "s", "skip_events", 0, "number of events to skip");
+  eudaq::Option<size_t> n_threads(op, "j", "threads", 0, "number of threads converting the events in parallel, 0 to convert in the writing thread");
 
   try{
     op.Parse(argv); }
@@ -30,14 +158,34 @@ int main(int /*argc*/, const char **argv) {
   
   if(type_in == "raw")
     type_in = "native";
+  if(!type_input.Value().empty())
+    type_in = type_input.Value();
   if(type_out == "raw")
     type_out = "native";
+  if(type_in == "rawz")
+    type_in = "native-z";
+  if(type_out == "rawz")
+    type_out = "native-z";
   
   eudaq::FileReaderUP reader;
   eudaq::FileWriterUP writer;
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
-  if(!type_out.empty())
+  if(!type_out.empty()){
     writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path, infile_path);
+    if(!writer)
+      writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
+  }
+  if(writer && n_threads.Value() > 0){
+    try{
+      ConvertParallel(reader, writer, n_threads.Value(), skip_events.Value(), max_events.Value(), print_ev_in);
+    }catch (const eudaq::Exception &e){
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::cout << std::endl;
+    EUDAQ_INFO_OUT("Finished", "Converter");
+    return 0;
+  }
   while(true){
     auto ev = reader->GetNextEvent();
     if (skip_events.Value() > 0){
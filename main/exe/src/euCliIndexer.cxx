@@ -0,0 +1,28 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/EventIndex.hh"
+#include <iostream>
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Event Indexer", "2.0",
+			 "Create the sidecar event index (.raw.idx) of a native .raw file");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "input file");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  std::string infile_path = file_input.Value();
+  if(infile_path.empty()){
+    std::cout << "option --help to get help" << std::endl;
+    return 1;
+  }
+  try{
+    size_t n = eudaq::EventIndex::Build(infile_path);
+    std::cout << "Indexed " << n << " events into " << eudaq::EventIndex::IndexPath(infile_path) << std::endl;
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  return 0;
+}
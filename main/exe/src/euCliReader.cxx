@@ -13,6 +13,7 @@ int main(int /*argc*/, const char **argv) {
   eudaq::Option<uint32_t> triggerh(op, "TG", "triggerhigh", 0, "uint32_t", "trigger number high");
   eudaq::Option<uint32_t> timestampl(op, "ts", "timestamp", 0, "uint32_t", "timestamp low");
   eudaq::Option<uint32_t> timestamph(op, "TS", "timestamphigh", 0, "uint32_t", "timestamp high");
+  eudaq::Option<std::string> type_input(op, "it", "input_type", "", "string", "input file type, overrides the file extension (e.g. native-mmap)");
   eudaq::OptionFlag stat(op, "s", "statistics", "enable print of statistics");
   eudaq::OptionFlag stdev(op, "std", "stdevent", "enable converter of StdEvent");
 
@@ -22,6 +23,10 @@ int main(int /*argc*/, const char **argv) {
   std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
   if(type_in=="raw")
     type_in = "native";
+  if(type_in=="rawz")
+    type_in = "native-z";
+  if(!type_input.Value().empty())
+    type_in = type_input.Value();
 
   bool stdev_v = stdev.Value();
 
@@ -38,10 +43,32 @@ int main(int /*argc*/, const char **argv) {
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
   uint32_t event_count = 0;
 
+  // jump to the lower bound through the event index, if the file has one
+  bool seeked = false;
+  char seek_key = 0;
+  if(eventl_v!=0){
+    seeked = reader->SeekEvent(eventl_v);
+    seek_key = 'e';
+  }
+  else if(triggerl_v!=0){
+    seeked = reader->SeekTrigger(triggerl_v);
+    seek_key = 't';
+  }
+  else if(timestampl_v!=0){
+    seeked = reader->SeekTimestamp(timestampl_v);
+    seek_key = 's';
+  }
+  // stop at the upper bound of the seeked key, if it only increases
+  bool stop_early = seeked && reader->SeekOrdered();
+
   while(1){
     auto ev = reader->GetNextEvent();
     if(!ev)
       break;
+    if(stop_early && ((seek_key=='e' && eventh_v!=0 && ev->GetEventN() >= eventh_v) ||
+		      (seek_key=='t' && triggerh_v!=0 && ev->GetTriggerN() >= triggerh_v) ||
+		      (seek_key=='s' && timestamph_v!=0 && ev->GetTimestampBegin() > timestamph_v)))
+      break;
     bool in_range_evn = false;
     if(eventl_v!=0 || eventh_v!=0){
       uint32_t ev_n = ev->GetEventN();
@@ -85,6 +112,9 @@ int main(int /*argc*/, const char **argv) {
     
     event_count ++;
   }
-  std::cout<< "There are "<< event_count << "Events"<<std::endl;
+  if(seeked)
+    std::cout<< "Read "<< event_count << " Events starting from the indexed position"<<std::endl;
+  else
+    std::cout<< "There are "<< event_count << "Events"<<std::endl;
   return 0;
 }
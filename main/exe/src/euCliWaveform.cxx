@@ -0,0 +1,305 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/StandardWaveform.hh"
+#include "eudaq/WaveformKernels.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace eudaq;
+
+namespace {
+  typedef std::vector<float> Samples;
+  // the channels of one event
+  typedef std::vector<Samples> Channels;
+
+  // The loops StandardWaveform used before the kernels, as the reference
+  float RefIntegral(const Samples &s, uint16_t min, uint16_t max, bool abs){
+    float integral = 0;
+    for(uint16_t i = min; i <= max; i++)
+      integral += abs ? std::fabs(s.at(i)) : s.at(i);
+    return integral / (float)(max - (int)min);
+  }
+
+  uint16_t RefIndexMin(const Samples &s, int min, int max){
+    return uint16_t(std::min_element(&s.at(min), &s.at(max)) - &s.at(0));
+  }
+
+  uint16_t RefIndexMax(const Samples &s, int min, int max){
+    return uint16_t(std::max_element(&s.at(min), &s.at(max)) - &s.at(0));
+  }
+
+  float RefMedian(const Samples &s, uint32_t min, uint32_t max){
+    Samples c(s.begin() + min, s.begin() + max + 1);
+    std::sort(c.begin(), c.end());
+    size_t n = c.size();
+    return n % 2 ? c[n / 2] : 0.5f * (c[n / 2 - 1] + c[n / 2]);
+  }
+
+  void RefPeaksAbove(const Samples &s, uint16_t min, uint16_t max, float threshold,
+                     std::vector<uint16_t> &peaks){
+    peaks.clear();
+    uint16_t low(min), high;
+    for(int j = min + 1; j <= max - 1; j++){
+      float val = std::fabs(s.at(j));
+      if(val > threshold && std::fabs(s.at(j - 1)) < threshold)
+        low = j;
+      if(val > threshold && std::fabs(s.at(j + 1)) < threshold){
+        high = j;
+        if(high > low + 5){
+          auto min_el = std::min_element(s.begin() + low, s.begin() + high);
+          auto max_el = std::max_element(s.begin() + low, s.begin() + high);
+          auto peak = std::fabs(*max_el) > std::fabs(*min_el) ? max_el : min_el;
+          uint16_t pos = uint16_t(peak - s.begin());
+          if(peaks.empty() || pos > peaks.back() + 35)
+            peaks.push_back(pos);
+        }
+      }
+    }
+  }
+
+  size_t RefCrossing(const float *s, size_t n, float t, bool rising, bool last){
+    for(size_t k = 1; k < n; k++){
+      size_t i = last ? n - k : k;
+      if(rising ? (s[i-1] < t && t <= s[i]) : (s[i-1] > t && t >= s[i]))
+        return i;
+    }
+    return n;
+  }
+
+  // DRS4 like events: 1024 samples in mV, 16 bit quantised, with noise and
+  // one to three negative pulses per channel
+  std::vector<Channels> Generate(uint32_t n_events, uint32_t n_channels, uint32_t seed){
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> noise(0, 2.5);
+    std::uniform_real_distribution<float> uni(0, 1);
+    std::vector<Channels> events(n_events, Channels(n_channels, Samples(1024)));
+    for(auto &ev: events){
+      for(auto &s: ev){
+        float base = uni(gen) * 10 - 5;
+        std::vector<std::pair<float, float>> pulses(1 + int(uni(gen) * 3));
+        for(auto &p: pulses)
+          p = std::make_pair(50 + uni(gen) * 900, 20 + uni(gen) * 400);
+        for(size_t i = 0; i < s.size(); i++){
+          float x = base + noise(gen);
+          for(auto &p: pulses){
+            float d = (i - p.first) / 6.f;
+            if(d > -3)
+              x -= p.second * std::exp(-(d + std::exp(-d))) * 1.6f;
+          }
+          s[i] = std::round(x * 65535 / 1000.f) / 65535 * 1000.f;
+        }
+      }
+    }
+    return events;
+  }
+
+  // The waveforms of the raw DRS4 events: trigger cell and timestamp blocks,
+  // then a name and a sample block per active channel
+  std::vector<Channels> ReadDRS4(std::string path, const std::string &type, uint32_t n_events){
+    auto reader = Factory<FileReader>::MakeUnique(str2hash(type), path);
+    std::vector<Channels> events;
+    if(!reader)
+      return events;
+    double offset = 0;
+    while(events.size() < n_events){
+      auto ev = reader->GetNextEvent();
+      if(!ev)
+        break;
+      if(ev->GetDescription() != "DRS4RawDataEvent")
+        continue;
+      if(ev->IsBORE()){
+        offset = std::stod(ev->GetTag("BaselineOffset", "0"));
+        continue;
+      }
+      if(ev->IsEORE())
+        continue;
+      Channels channels;
+      for(uint32_t b = 3; b < ev->NumBlocks(); b += 2){
+        auto block = ev->GetBlock(b);
+        Samples s(block.size() / sizeof(uint16_t));
+        for(size_t i = 0; i < s.size(); i++){
+          uint16_t raw = uint16_t(block[2 * i] | block[2 * i + 1] << 8);
+          s[i] = float((raw / 65535. - 0.5 + offset) * 1000);
+        }
+        channels.push_back(s);
+      }
+      if(!channels.empty())
+        events.push_back(channels);
+    }
+    return events;
+  }
+
+  // Compares StandardWaveform and the kernels with the reference loops on
+  // random ranges, returns the number of mismatches
+  uint64_t Compare(const std::vector<Channels> &events, uint32_t seed, uint64_t &checks){
+    std::mt19937 gen(seed);
+    uint64_t bad = 0;
+    std::vector<uint16_t> ref_peaks, peaks;
+    for(auto &ev: events){
+      for(auto &s: ev){
+        if(s.size() < 16)
+          continue;
+        StandardWaveform wf(0, "DRS4");
+        wf.SetNSamples(s.size());
+        wf.SetWaveform(s.data());
+        std::uniform_int_distribution<int> idx(0, int(s.size()) - 1);
+        for(int k = 0; k < 8; k++){
+          int a = idx(gen), b = idx(gen);
+          if(a > b)
+            std::swap(a, b);
+          if(a == b)
+            continue;
+          bad += wf.getIndexMin(a, b) != RefIndexMin(s, a, b);
+          bad += wf.getIndexMax(a, b) != RefIndexMax(s, a, b);
+          // sums are accumulated in several lanes, allow for the rounding
+          for(bool abs: {false, true}){
+            float ref = RefIntegral(s, a, b, abs);
+            bad += std::fabs(wf.getIntegral(a, b, abs) - ref) > 1e-4 * (1 + std::fabs(ref)) * (b - a);
+          }
+          bad += wf.getMedian(a, b) != RefMedian(s, a, b);
+          float t = s[a + (b - a) / 2];
+          for(bool rising: {true, false}){
+            bad += waveform::Crossing(&s[a], b - a, t, rising) != RefCrossing(&s[a], b - a, t, rising, false);
+            bad += waveform::LastCrossing(&s[a], b - a, t, rising) != RefCrossing(&s[a], b - a, t, rising, true);
+          }
+          checks += 9;
+        }
+        uint16_t max = uint16_t(s.size() - 5);
+        for(float threshold: {10.f, 30.f, 100.f}){
+          RefPeaksAbove(s, 5, max, threshold, ref_peaks);
+          wf.getAllPeaksAbove(5, max, threshold, peaks);
+          bad += peaks != ref_peaks;
+          checks++;
+        }
+      }
+    }
+    return bad;
+  }
+
+  // keeps the timed results from being optimised away
+  volatile double g_sink;
+
+  double Elapsed(std::chrono::steady_clock::time_point start, size_t n_events){
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / n_events;
+  }
+
+  // The analysis of a pulse in [begin, end) after a baseline in [0, begin),
+  // with the reference loops and with Analyse, in us per event
+  void TimeAnalysis(const std::vector<Channels> &events, const std::vector<waveform::Isa> &isas){
+    waveform::Params p;
+    p.baseline_begin = 0;
+    p.baseline_end = 100;
+    p.begin = 100;
+    p.end = 1000;
+    p.polarity = -1;
+    p.threshold = 20;
+    double sink = 0;
+    std::vector<uint16_t> peaks;
+    auto start = std::chrono::steady_clock::now();
+    for(auto &ev: events){
+      for(auto &s: ev){
+        if(s.size() < p.end)
+          continue;
+        float base = RefIntegral(s, 0, 99, false) * 99 / 100;
+        float integral = RefIntegral(s, 100, 999, false) * 899 - base * 900;
+        uint16_t ipeak = RefIndexMin(s, 100, 1000);
+        float amplitude = base - s[ipeak];
+        size_t leading = RefCrossing(&s[100], 900, base - p.threshold, false, false);
+        size_t cfd = RefCrossing(&s[100], ipeak - 100 + 1, base - p.cfd_fraction * amplitude, false, true);
+        RefPeaksAbove(s, 100, 999, p.threshold, peaks);
+        sink += integral + amplitude + leading + cfd + peaks.size();
+      }
+    }
+    g_sink = sink;
+    std::cout << "reference loops: " << Elapsed(start, events.size()) << " us/event" << std::endl;
+
+    std::vector<waveform::Result> results;
+    std::vector<const float *> channels;
+    for(auto isa: isas){
+      waveform::SetMaxIsa(isa);
+      sink = 0;
+      start = std::chrono::steady_clock::now();
+      for(auto &ev: events){
+        channels.clear();
+        for(auto &s: ev)
+          if(s.size() >= p.end)
+            channels.push_back(s.data());
+        results.resize(channels.size());
+        waveform::Analyse(channels.data(), channels.size(), p, results.data());
+        for(size_t c = 0; c < channels.size(); c++){
+          peaks.clear();
+          waveform::PeaksAbove(channels[c] + 100, 900, p.threshold, peaks);
+          sink += results[c].integral + results[c].amplitude + results[c].threshold_time + results[c].cfd_time + peaks.size();
+        }
+      }
+      double elapsed = Elapsed(start, events.size());
+      g_sink = sink;
+      std::cout << waveform::IsaName(waveform::GetIsa()) << " kernels: " << elapsed << " us/event" << std::endl;
+    }
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Waveform Kernel Check", "2.1", "Compares the waveform kernels of each instruction set with the former StandardWaveform loops");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "DRS4 raw data file, synthetic events if empty");
+  eudaq::Option<std::string> type_input(op, "it", "input_type", "", "string", "input file type, overrides the file extension (e.g. native-mmap)");
+  eudaq::Option<uint32_t> n_events(op, "n", "events", 2000, "uint32_t", "number of events");
+  eudaq::Option<uint32_t> n_channels(op, "c", "channels", 4, "uint32_t", "channels per synthetic event");
+  eudaq::Option<uint32_t> seed(op, "s", "seed", 7, "uint32_t", "seed of the synthetic events and of the ranges");
+  eudaq::Option<std::string> max_isa(op, "isa", "isa", "all", "string", "instruction set to check: scalar, sse2, avx2 or all");
+
+  op.Parse(argv);
+
+  std::vector<waveform::Isa> isas;
+  std::string isa_v = max_isa.Value();
+  if(isa_v == "scalar" || isa_v == "all")
+    isas.push_back(waveform::Isa::SCALAR);
+  if(isa_v == "sse2" || isa_v == "all")
+    isas.push_back(waveform::Isa::SSE2);
+  if(isa_v == "avx2" || isa_v == "all")
+    isas.push_back(waveform::Isa::AVX2);
+  if(isas.empty()){
+    std::cerr << "Unknown instruction set: " << isa_v << std::endl;
+    return 1;
+  }
+
+  std::vector<Channels> events;
+  std::string infile_path = file_input.Value();
+  if(infile_path.empty()){
+    events = Generate(n_events.Value(), n_channels.Value(), seed.Value());
+  }
+  else{
+    std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
+    if(type_in=="raw")
+      type_in = "native";
+    if(type_in=="rawz")
+      type_in = "native-z";
+    if(!type_input.Value().empty())
+      type_in = type_input.Value();
+    events = ReadDRS4(infile_path, type_in, n_events.Value());
+  }
+  if(events.empty()){
+    std::cerr << "No waveforms to check" << std::endl;
+    return 1;
+  }
+  std::cout << events.size() << " events" << std::endl;
+
+  uint64_t total_bad = 0;
+  for(auto isa: isas){
+    waveform::SetMaxIsa(isa);
+    if(waveform::GetIsa() != isa)
+      std::cout << waveform::IsaName(isa) << " not supported by this CPU, ";
+    uint64_t checks = 0;
+    uint64_t bad = Compare(events, seed.Value(), checks);
+    std::cout << waveform::IsaName(waveform::GetIsa()) << ": " << bad << " mismatches of " << checks << std::endl;
+    total_bad += bad;
+  }
+  TimeAnalysis(events, isas);
+  return total_bad ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+#ifndef EUDAQ_INCLUDED_AsyncFileWriter
+#define EUDAQ_INCLUDED_AsyncFileWriter
+
+#include "eudaq/FileWriter.hh"
+#include "eudaq/Platform.hh"
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+
+namespace eudaq {
+
+  // Write-behind stage in front of another FileWriter.
+  // WriteEvent() only queues the event; a dedicated thread takes all queued
+  // events at once, serializes and writes them while the queue fills up
+  // again, and flushes the file whenever the queue runs empty.
+  // A full queue blocks the caller (back-pressure) instead of dropping.
+  class DLLEXPORT AsyncFileWriter : public FileWriter {
+  public:
+    AsyncFileWriter(FileWriterSP writer, size_t capacity);
+    ~AsyncFileWriter() override;
+    void WriteEvent(EventSPC ev) override;
+    void Flush() override;
+    uint64_t FileBytes() const override;
+
+    size_t QueueSize();
+    size_t QueueHighWater() const {return m_high_water;};
+    uint64_t BlockedCount() const {return m_blocked_n;};
+    uint64_t BlockedMicroseconds() const {return m_blocked_us;};
+
+  private:
+    void Writing();
+    FileWriterSP m_writer;
+    size_t m_capacity;
+    std::mutex m_mx;
+    std::condition_variable m_cv_push;
+    std::condition_variable m_cv_pop;
+    std::deque<EventSPC> m_queue;
+    bool m_busy;
+    bool m_exit;
+    std::string m_error;
+    std::atomic<size_t> m_high_water;
+    std::atomic<uint64_t> m_blocked_n;
+    std::atomic<uint64_t> m_blocked_us;
+    std::atomic<uint64_t> m_filebytes;
+    std::thread m_thread;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_AsyncFileWriter
@@ -18,10 +18,12 @@ namespace eudaq {
     BufferSerializer(InIt first, InIt last)
         : m_data(first, last), m_offset(0) {}
     BufferSerializer(Deserializer &);
+    // keeps the capacity, so a serializer can be reused without reallocating
     void clear() {
       m_data.clear();
       m_offset = 0;
     }
+    void reserve(size_t n) { m_data.reserve(n); }
     const unsigned char &operator[](size_t i) const { return m_data[i]; }
     size_t size() const { return m_data.size(); }
     virtual bool HasData() { return m_data.size() != 0; }
@@ -2,7 +2,8 @@
 #define EUDAQ_INCLUDED_DataCollector
 #include "eudaq/CommandReceiver.hh"
 #include "eudaq/FileWriter.hh"
-#include "eudaq/DataSender.hh"
+#include "eudaq/AsyncFileWriter.hh"
+#include "eudaq/MonitorPublisher.hh"
 #include "eudaq/DataReceiver.hh"
 #include "eudaq/Event.hh"
 #include "eudaq/Configuration.hh"
@@ -62,13 +63,13 @@ namespace eudaq {
   private:
     std::string m_data_addr;
     FileWriterSP m_writer;
-    std::mutex m_mtx_sender;
-    std::map<std::string, std::shared_ptr<DataSender>> m_senders;
+    std::shared_ptr<AsyncFileWriter> m_async_writer;
+    MonitorPublisher m_publisher;
     std::string m_fwpatt;
     std::string m_fwtype;
     uint32_t m_dct_n;
     uint32_t m_evt_c;
-    uint32_t m_fraction;
+    uint32_t m_write_queue;
     ConfigurationSPC m_conf;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
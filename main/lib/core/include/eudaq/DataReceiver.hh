@@ -19,6 +19,7 @@
 #include <future>
 #include <thread>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <type_traits>
@@ -30,6 +31,12 @@ namespace eudaq {
 
   class DLLEXPORT DataReceiver{
   public:
+    // what DataHandler does with an Event when the receive queue is full
+    enum class QueuePolicy {
+      BLOCK,       // stop reading the sockets until there is room again
+      DROP_NEWEST, // discard the Event just received
+      DROP_OLDEST  // discard the oldest queued Event
+    };
     DataReceiver();
     virtual ~DataReceiver();
     virtual void OnConnect(ConnectionSPC id);
@@ -37,7 +44,36 @@ namespace eudaq {
     virtual void OnReceive(ConnectionSPC id, EventSP ev);
     std::string Listen(const std::string &addr);
     void StopListen();//TODO: remove this method later
+    void SetReceiveQueue(size_t capacity, uint64_t max_bytes, QueuePolicy policy);
+    void ConfigureReceiveQueue(ConfigurationSPC conf);
+    void SetDecodeThreads(size_t n);
+    size_t ReceiveQueueSize();
+    uint64_t ReceiveQueueBytes();
+    size_t ReceiveQueueHighWater() const {return m_qu_high_water;};
+    uint64_t ReceiveDroppedCount() const {return m_qu_dropped_n;};
+    uint64_t ReceiveBlockedCount() const {return m_qu_blocked_n;};
+    uint64_t ReceiveBlockedMicroseconds() const {return m_qu_blocked_us;};
   private:
+    struct QueueEntry{
+      EventSP ev;
+      std::future<EventSP> fut; // Event still being decoded by a worker
+      ConnectionSPC con; // nullptr marks an Event dropped in place
+      size_t bytes;
+      bool IsEvent() const {return ev || fut.valid();};
+    };
+    struct DecodeJob{
+      std::string packet;
+      std::promise<EventSP> result;
+    };
+    void PushConnection(ConnectionSPC con);
+    void PushEvent(ConnectionSPC con, std::string &&packet);
+    void PushEntry(QueueEntry &&entry);
+    bool IsQueueFull(size_t bytes) const;
+    bool DropOldest();
+    bool ClearQueue();
+    void StartDecoders();
+    void StopDecoders();
+    void Decoding();
     void DataHandler(TransportEvent &ev);
     bool Deamon();
     bool AsyncReceiving();
@@ -55,8 +91,28 @@ namespace eudaq {
     std::future<bool> m_fut_deamon;
     std::mutex m_mx_qu_ev;
     std::mutex m_mx_deamon;
-    std::queue<std::pair<EventSP, ConnectionSPC>> m_qu_ev;
+    // ring of received Events and connection changes, guarded by m_mx_qu_ev
+    std::vector<QueueEntry> m_qu_ring;
+    size_t m_qu_head;
+    size_t m_qu_slots;
+    size_t m_qu_ev_n;
+    uint64_t m_qu_bytes;
+    size_t m_qu_capacity;
+    uint64_t m_qu_max_bytes;
+    QueuePolicy m_qu_policy;
+    std::atomic<size_t> m_qu_high_water;
+    std::atomic<uint64_t> m_qu_dropped_n;
+    std::atomic<uint64_t> m_qu_blocked_n;
+    std::atomic<uint64_t> m_qu_blocked_us;
     std::condition_variable m_cv_not_empty;
+    std::condition_variable m_cv_not_full;
+    // decode workers, the ring keeps the arrival order of their results
+    size_t m_decode_n;
+    std::vector<std::thread> m_decoders;
+    std::deque<DecodeJob> m_decode_jobs;
+    std::mutex m_mx_decode;
+    std::condition_variable m_cv_decode;
+    bool m_decode_exit;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
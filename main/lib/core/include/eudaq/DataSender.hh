@@ -4,6 +4,7 @@
 
 #include "eudaq/Platform.hh"
 #include "eudaq/Event.hh"
+#include "eudaq/BufferSerializer.hh"
 #include <string>
 #include <future>
 #include <thread>
@@ -21,8 +22,13 @@ class TransportClient;
       ~DataSender();
       void Connect(const std::string & server);
       void SendEvent(EventSPC ev);
+      // sends an event which has been serialized already
+      void SendBuffer(const BufferSerializer &buf);
+      void SetNoDelay(bool enable);
+      void SetCork(bool enable);
   private:
       bool AsyncSending();
+      void SendSerialized(const EventSPC &ev);
       std::string m_type, m_name;
       std::unique_ptr<TransportClient> m_dataclient;
       uint64_t m_packetCounter;
@@ -31,6 +37,9 @@ class TransportClient;
       std::mutex m_mx_qu_ev; 
       std::queue<EventSPC> m_qu_ev;
       std::condition_variable m_cv_not_empty;
+      std::mutex m_mx_send;
+      BufferSerializer m_ser;
+      bool m_cork;
   };
 
 }
@@ -5,10 +5,12 @@
 #include "eudaq/Time.hh"
 #include "eudaq/Exception.hh"
 #include "eudaq/Platform.hh"
+#include "eudaq/Serializer.hh"
 
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace eudaq{
   class DLLEXPORT Deserializer {
@@ -35,13 +37,26 @@ namespace eudaq{
     void read(unsigned char *dst, size_t size);
     void PreRead(uint32_t &t);
     void PreRead(uint8_t *dst, size_t size);
+
+    // Zero-copy access for deserializers reading from memory which outlives
+    // the deserializer (e.g. a mapped file). GetBacking() returns the owner of
+    // that memory, or nullptr if the data has to be copied out with read().
+    virtual std::shared_ptr<const void> GetBacking() const;
+    // Returns a pointer to the next size bytes and skips over them.
+    // Only valid if GetBacking() is not nullptr.
+    const uint8_t *Borrow(size_t size);
   protected:
     bool m_interrupting;
 
   private:
     template <typename T> friend struct ReadHelper;
+    template <typename T>
+    void read_elements(std::vector<T> &t, size_t len, std::true_type);
+    template <typename T>
+    void read_elements(std::vector<T> &t, size_t len, std::false_type);
     virtual void Deserialize(unsigned char *, size_t) = 0;
     virtual void PreDeserialize(unsigned char *, size_t) = 0;
+    virtual const uint8_t *BorrowDeserialize(size_t);
   };
 
   template <typename T> struct ReadHelper {
@@ -73,22 +88,33 @@ namespace eudaq{
                                    "only supports integers of size > 1 byte!");
       unsigned char buf[sizeof(T)];
       ds.Deserialize(buf, sizeof(T));
-      T t = 0;
+      T t;
+#ifdef EUDAQ_LITTLE_ENDIAN
+      std::memcpy(&t, buf, sizeof t);
+#else
+      t = 0;
       for (size_t i = 0; i < sizeof t; ++i) {
         t <<= 8;
         t += buf[sizeof t - 1 - i];
       }
+#endif
       return t;
     }
     static float read_float(Deserializer &ds) {
       unsigned char buf[sizeof(float)];
       ds.Deserialize(buf, sizeof buf);
+#ifdef EUDAQ_LITTLE_ENDIAN
+      float f;
+      std::memcpy(&f, buf, sizeof f);
+      return f;
+#else
       unsigned t = 0;
       for (size_t i = 0; i < sizeof t; ++i) {
         t <<= 8;
         t += buf[sizeof t - 1 - i];
       }
       return *(float *)&t;
+#endif
     }
     static double read_double(Deserializer &ds) {
       union {
@@ -98,12 +124,14 @@ namespace eudaq{
       } u;
       // unsigned char buf[sizeof (double)];
       ds.Deserialize(u.b, sizeof u.b);
+#ifndef EUDAQ_LITTLE_ENDIAN
       uint64_t t = 0;
       for (size_t i = 0; i < sizeof t; ++i) {
         t <<= 8;
         t += u.b[sizeof t - 1 - i];
       }
       u.i = t;
+#endif
       return u.d;
     }
   };
@@ -130,7 +158,20 @@ namespace eudaq{
   template <typename T> inline void Deserializer::read(std::vector<T> &t) {
     unsigned len = 0;
     read(len);
-    t.reserve(len);
+    read_elements(t, len, IsBulkCopyable<T>());
+  }
+
+  template <typename T>
+  inline void Deserializer::read_elements(std::vector<T> &t, size_t len, std::true_type) {
+    size_t n = t.size();
+    t.resize(n + len);
+    if (len)
+      Deserialize(reinterpret_cast<unsigned char *>(&t[n]), len * sizeof(T));
+  }
+
+  template <typename T>
+  inline void Deserializer::read_elements(std::vector<T> &t, size_t len, std::false_type) {
+    t.reserve(t.size() + len);
     for (size_t i = 0; i < len; ++i) {
       t.push_back(read<T>());
     }
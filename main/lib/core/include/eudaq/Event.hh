@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include <ostream>
+#include <cstring>
 
 #include "eudaq/Serializable.hh"
 #include "eudaq/Serializer.hh"
@@ -28,6 +29,23 @@ namespace eudaq {
   Factory<Event>::Instance<>();  
 #endif
 
+  // Non-owning view of the payload of a data block. It is valid as long as
+  // the event it was taken from is alive and its blocks are not modified.
+  class DLLEXPORT BlockView {
+  public:
+    BlockView() :m_data(nullptr), m_size(0){};
+    BlockView(const uint8_t *data, size_t size) :m_data(data), m_size(size){};
+    const uint8_t *data() const {return m_data;};
+    size_t size() const {return m_size;};
+    bool empty() const {return m_size == 0;};
+    const uint8_t *begin() const {return m_data;};
+    const uint8_t *end() const {return m_data + m_size;};
+    const uint8_t &operator[](size_t i) const {return m_data[i];};
+  private:
+    const uint8_t *m_data;
+    size_t m_size;
+  };
+
   using EventUP = Factory<Event>::UP_BASE; 
   using EventSP = Factory<Event>::SP_BASE;
   using EventSPC = Factory<Event>::SPC_BASE;
@@ -40,13 +58,15 @@ namespace eudaq {
       FLAG_FAKE = 0x4,
       FLAG_PACK = 0x8,
       FLAG_TRIG = 0x10,
-      FLAG_TIME = 0x20
+      FLAG_TIME = 0x20,
+      FLAG_BATCH = 0x40
     };
 
     Event();
     // Event(const &&ev);
     
     Event(Deserializer & ds);
+    ~Event() override;
     virtual void Serialize(Serializer &) const;
     virtual void Print(std::ostream & os, size_t offset = 0) const;
     
@@ -65,6 +85,7 @@ namespace eudaq {
     void SetFlagPacket();
     void SetFlagTimestamp();
     void SetFlagTrigger();
+    void SetFlagBatch();
     
     bool IsBORE() const;
     bool IsEORE() const;
@@ -72,8 +93,10 @@ namespace eudaq {
     bool IsFlagPacket() const;
     bool IsFlagTimestamp() const;
     bool IsFlagTrigger() const;    
+    bool IsFlagBatch() const;
     
     void AddSubEvent(EventSPC ev);
+    void ReserveSubEvents(uint32_t n);
     uint32_t GetNumSubEvent() const;
     EventSPC GetSubEvent(uint32_t i) const;
     std::vector<EventSPC> GetSubEvents() const;
@@ -116,29 +139,39 @@ namespace eudaq {
 
     //from RawdataEvent
     std::vector<uint8_t> GetBlock(uint32_t i) const;
+    BlockView GetBlockView(uint32_t i) const;
     size_t GetNumBlock() const;
     size_t NumBlocks() const;
     std::vector<uint32_t> GetBlockNumList() const;
+
+    // Number of payload buffers of destroyed events kept per thread for
+    // reuse by the next events of that thread, 0 (default) disables it.
+    static void SetBlockPoolSize(size_t n);
     
     /// Add a data block as std::vector
     template <typename T>
     size_t AddBlock(uint32_t id, const std::vector<T> &data){
-      m_blocks[id]=make_vector(data);
-      return m_blocks.size();
+      return AddBlock(id, data.data(), data.size() * sizeof(T));
     }
 
     /// Add a data block as array with given size
     template <typename T>
     size_t AddBlock(uint32_t id, const T *data, size_t bytes){
-      m_blocks[id]=make_vector(data, bytes);
-      return m_blocks.size();
+      uint8_t *dst = NewBlock(id, bytes);
+      if(bytes)
+        std::memcpy(dst, data, bytes);
+      return GetNumBlock();
     }
 
+    /// Add a data block referring to memory kept alive by backing, no copy
+    void AddBlockRef(uint32_t id, const BlockView &data, std::shared_ptr<const void> backing);
+
     template <typename T>
     void AppendBlock(size_t index, const std::vector<T> &data) {
-      auto &&src = make_vector(data);
-      auto &&dst = m_blocks[index];
-      dst.insert(dst.end(), src.begin(), src.end());
+      size_t bytes = data.size() * sizeof(T);
+      uint8_t *dst = GrowBlock(index, bytes);
+      if(bytes)
+        std::memcpy(dst, data.data(), bytes);
     }
 
     //TODO: remove, clearn up
@@ -151,17 +184,20 @@ namespace eudaq {
     }
     
   private:
-    template <typename T>
-      static std::vector<uint8_t> make_vector(const T *data, size_t bytes) {
-      const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
-      return std::vector<uint8_t>(ptr, ptr + bytes);
-    }
-
-    template <typename T>
-    static std::vector<uint8_t> make_vector(const std::vector<T> &data) {
-      const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&data[0]);
-      return std::vector<uint8_t>(ptr, ptr + data.size() * sizeof(T));
-    }
+    // A data block either lives in m_block_data at offset, or in memory
+    // owned by a zero-copy Deserializer (ext != nullptr).
+    struct BlockEntry {
+      uint32_t id;
+      size_t offset;
+      size_t size;
+      const uint8_t *ext;
+    };
+    const BlockEntry *FindBlock(uint32_t id) const;
+    BlockEntry &InsertBlock(uint32_t id);
+    uint8_t *NewBlock(uint32_t id, size_t bytes);
+    uint8_t *GrowBlock(uint32_t id, size_t bytes);
+    size_t AllocBlockData(size_t bytes);
+    void ReleaseBlockData(const BlockEntry &e);
     
   private:
     uint32_t m_type;
@@ -176,7 +212,10 @@ namespace eudaq {
     uint64_t m_ts_end;
     std::string m_dspt;
     std::map<std::string, std::string> m_tags;
-    std::map<uint32_t, std::vector<uint8_t>> m_blocks;
+    std::vector<BlockEntry> m_block_table; // sorted by id
+    std::vector<uint8_t> m_block_data;
+    size_t m_block_dead; // bytes in m_block_data of replaced blocks
+    std::vector<std::shared_ptr<const void>> m_block_backing;
     std::vector<EventSPC> m_sub_events;
   };
 }
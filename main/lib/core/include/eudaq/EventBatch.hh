@@ -0,0 +1,58 @@
+#ifndef EUDAQ_INCLUDED_EventBatch
+#define EUDAQ_INCLUDED_EventBatch
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+#include <vector>
+
+namespace eudaq{
+
+  // Many triggers of one producer sent as a single event (FLAG_BATCH), to
+  // save the per-event cost at high trigger rates. Block 0 holds one
+  // fixed-size little-endian record per trigger: trigger number (32 bit),
+  // timestamp begin and end (64 bit each), then the payload of the
+  // producer. The payload size is kept in the tag EUDAQ_BATCH_PAYLOAD.
+  // The event of record i has the event number of the batch plus i, the
+  // flags of the batch and block 0 holding the payload. The tags and BORE
+  // of the batch go with its first record, EORE with its last one.
+  class DLLEXPORT EventBatch{
+  public:
+    explicit EventBatch(EventSPC ev);
+    size_t Size() const {return m_n;};
+    uint32_t GetTriggerN(size_t i) const;
+    uint64_t GetTimestampBegin(size_t i) const;
+    uint64_t GetTimestampEnd(size_t i) const;
+    BlockView GetPayload(size_t i) const;
+    // The event of record i, sharing the memory of the batch
+    EventUP Unpack(size_t i) const;
+
+    static const char m_tag_payload[];
+    static const size_t m_header_size = 20;
+  private:
+    const uint8_t *Record(size_t i) const;
+    EventSPC m_ev;
+    BlockView m_data;
+    size_t m_record_size;
+    size_t m_n;
+  };
+
+  class DLLEXPORT EventBatchWriter{
+  public:
+    explicit EventBatchWriter(size_t payload_size);
+    // Appends a record, the returned payload is to be filled by the caller
+    uint8_t *Add(uint32_t tg, uint64_t ts_begin, uint64_t ts_end);
+    size_t Size() const {return m_n;};
+    bool Empty() const {return m_n == 0;};
+    // Moves the records into ev and starts a new batch
+    void Fill(Event &ev);
+  private:
+    size_t m_payload_size;
+    size_t m_n;
+    uint32_t m_tg_first;
+    uint64_t m_ts_first;
+    uint64_t m_ts_last;
+    std::vector<uint8_t> m_data;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_EventBatch
@@ -0,0 +1,185 @@
+#ifndef EUDAQ_INCLUDED_EventBuilder
+#define EUDAQ_INCLUDED_EventBuilder
+
+#include "eudaq/Event.hh"
+#include "eudaq/Configuration.hh"
+#include "eudaq/Platform.hh"
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+
+namespace eudaq {
+
+  // Merges the event streams of several producers into packet events.
+  // Fragments are matched by trigger number, event number, both of them, or
+  // by overlapping timestamp windows. Every stream is assumed to deliver its
+  // fragments in order, so a key is final as soon as all streams have moved
+  // past it; the lowest such watermark is kept in an ordered index instead of
+  // scanning all streams on every fragment.
+  // A stream that stays silent longer than the timeout, or lags more than the
+  // given number of triggers, no longer holds back the others; the affected
+  // events are emitted without its fragment and tagged EUDAQ_INCOMPLETE with
+  // the number of missing streams. The number of buffered fragments is
+  // bounded as well, the oldest event is forced out when it is exceeded.
+  // Fragments arriving after their event was emitted are counted as late and
+  // dropped, fragments that nobody else matched are counted as orphans.
+  // Not thread-safe, the owner serializes Push() and the other calls.
+  class DLLEXPORT EventBuilder{
+  public:
+    enum Key : uint32_t {
+      TRIGGER = 0x1,
+      EVENT = 0x2,
+      TIMESTAMP = 0x4
+    };
+    using Output = std::function<void(EventUP)>;
+    // extends a trigger counter of limited width across its wrap-arounds;
+    // epoch follows the highest trigger of all streams, a stream without
+    // history starts from it instead of from the first wrap
+    struct TriggerCounter{
+      bool any = false;
+      uint64_t raw = 0;
+      uint64_t ext = 0;
+      uint64_t Extend(uint64_t raw, uint64_t mask, TriggerCounter &epoch);
+    };
+    static uint64_t MakeKey(uint32_t key, uint64_t mask, TriggerCounter &tg,
+			    TriggerCounter &epoch, const Event &ev);
+    // an end of run without the trigger or timestamp to be matched by, it
+    // only ends the stream
+    static bool IsEndMarker(uint32_t key, const Event &ev);
+
+    EventBuilder(uint32_t key, const std::string &dspt, Output out);
+    void Configure(const Configuration &conf);
+    void SetTimeout(uint32_t ms){m_timeout = std::chrono::milliseconds(ms);};
+    void SetTriggerBits(uint32_t bits);
+    void SetTimestampTolerance(uint64_t tol){m_ts_tol = tol;};
+    void SetMaxTriggers(uint64_t n){m_max_keys = n;};
+    void SetMaxPending(size_t n){m_max_pending = n;};
+
+    void AddStream(uint32_t id);
+    void RemoveStream(uint32_t id);
+    void Push(uint32_t id, EventSPC ev);
+    void Push(uint32_t id, EventSPC ev, uint64_t key);
+    void Poll();
+    void Flush();
+    void Reset();
+
+    bool HasStream(uint32_t id) const;
+    uint64_t TriggerMask() const {return m_trigger_mask;};
+    uint64_t LastKey() const {return m_key_last;};
+    uint64_t Floor() const;
+    size_t Streams() const {return m_n_live;};
+    size_t PendingSize() const {return m_frag_n;};
+    uint64_t BuiltCount() const {return m_built_n;};
+    uint64_t PartialCount() const {return m_partial_n;};
+    uint64_t LateCount() const {return m_late_n;};
+    uint64_t OrphanCount() const {return m_orphan_n;};
+    const std::map<uint32_t, uint64_t> &MissingCounts() const {return m_missing;};
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    struct Fragment{
+      EventSPC ev;
+      uint64_t beg;
+      uint64_t end;
+      Clock::time_point arrival;
+    };
+    struct Stream{
+      uint32_t id;
+      bool live;
+      bool started;
+      uint64_t mark;
+      TriggerCounter tg;
+      uint64_t head_beg;
+      uint64_t head_end;
+      size_t pos_mark;
+      size_t pos_beg;
+      size_t pos_end;
+      std::deque<Fragment> frags;
+    };
+    // binary min-heap of streams, every stream knows its position in it
+    class StreamHeap{
+    public:
+      StreamHeap(uint64_t Stream::*key, size_t Stream::*pos):m_key(key), m_pos(pos){};
+      void Push(Stream *st);
+      void Erase(Stream *st);
+      // the key of the stream has grown
+      void Raise(Stream *st);
+      void Clear(){m_v.clear();};
+      bool Empty() const {return m_v.empty();};
+      Stream *Top() const {return m_v.front();};
+      void Below(uint64_t key, std::vector<Stream*> &sts, size_t i = 0) const;
+    private:
+      void Place(size_t i, Stream *st);
+      void Up(size_t i);
+      void Down(size_t i);
+      uint64_t Stream::*m_key;
+      size_t Stream::*m_pos;
+      std::vector<Stream*> m_v;
+    };
+    struct Pending{
+      uint64_t key;
+      std::vector<EventSPC> evs;
+      std::vector<uint32_t> ids;
+      Clock::time_point arrival;
+    };
+
+    void PushKey(Stream &st, EventSPC ev, uint64_t key);
+    Pending &GetPending(uint64_t key, Clock::time_point now);
+    Pending &PendingAt(size_t i){return m_pending[(m_pend_beg + i) & (m_pending.size() - 1)];};
+    void PopPending();
+    void SetMark(Stream &st, uint64_t mark);
+    void EndStream(Stream &st);
+    Stream &GetStream(uint32_t id);
+    void Build(bool flush);
+    bool BuildKey(bool flush, Clock::time_point now);
+    bool BuildWindow(bool flush, Clock::time_point now);
+    void Emit(EventUP ev, size_t n_ids, size_t n_orphan, size_t n_missing);
+    void EraseStreamIfDone(Stream &st);
+    void IndexHead(Stream &st);
+    void UnindexHead(Stream &st);
+
+    uint32_t m_key;
+    std::string m_dspt;
+    Output m_out;
+    Clock::duration m_timeout;
+    uint64_t m_trigger_mask;
+    uint64_t m_ts_tol;
+    uint64_t m_max_keys;
+    size_t m_max_pending;
+
+    std::map<uint32_t, Stream> m_streams;
+    StreamHeap m_marks;
+    Stream *m_st_last;
+    size_t m_n_live;
+    size_t m_n_idle;
+    size_t m_frag_n;
+
+    //key matching, pending events ordered by key in a ring of power of two
+    //size starting at m_pend_beg, emptied slots keep their buffers
+    std::vector<Pending> m_pending;
+    size_t m_pend_beg;
+    size_t m_pend_n;
+    TriggerCounter m_tg_epoch;
+    uint64_t m_key_last;
+    uint64_t m_key_max;
+    bool m_key_any;
+
+    //timestamp windows, heads of the stream queues by begin and end
+    StreamHeap m_heads_beg;
+    StreamHeap m_heads_end;
+    std::vector<Stream*> m_window;
+    uint64_t m_ts_last;
+
+    uint64_t m_built_n;
+    uint64_t m_partial_n;
+    uint64_t m_late_n;
+    uint64_t m_orphan_n;
+    std::map<uint32_t, uint64_t> m_missing;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_EventBuilder
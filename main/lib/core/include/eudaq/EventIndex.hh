@@ -0,0 +1,73 @@
+#ifndef EUDAQ_INCLUDED_EventIndex
+#define EUDAQ_INCLUDED_EventIndex
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eudaq{
+  class FileSerializer;
+
+  // Sidecar index of a native .raw file, stored next to it as <file>.idx
+  // One fixed-size little-endian record per top-level event.
+  struct DLLEXPORT EventIndexEntry{
+    uint64_t offset;
+    uint32_t event_n;
+    uint32_t trigger_n;
+    uint64_t ts_begin;
+    uint64_t ts_end;
+    uint32_t stream_n;
+    uint32_t flags;
+  };
+
+  class DLLEXPORT EventIndex{
+  public:
+    EventIndex() = default;
+    static std::string IndexPath(const std::string &rawfile);
+    // Loads the index of rawfile, returns false if there is none.
+    bool Load(const std::string &rawfile);
+    // Scans rawfile and writes its index, returns the number of events.
+    static size_t Build(const std::string &rawfile);
+
+    size_t Size() const {return m_entries.size();};
+    const EventIndexEntry &Entry(size_t i) const {return m_entries.at(i);};
+    // Returns the earliest entry in the file with a key >= n, or nullptr if
+    // there is none. Reading on from there finds every event with key >= n.
+    const EventIndexEntry *FindEvent(uint32_t n) const;
+    const EventIndexEntry *FindTrigger(uint32_t n) const;
+    const EventIndexEntry *FindTimestamp(uint64_t ts) const;
+    // True if the key never decreases from one event to the next in the file
+    bool EventsOrdered() const {return m_by_event.keys.empty();};
+    bool TriggersOrdered() const {return m_by_trigger.keys.empty();};
+    bool TimestampsOrdered() const {return m_by_ts.keys.empty();};
+
+    static const char m_magic[8];
+    static const uint32_t m_version = 1;
+    static const uint32_t m_record_size = 40;
+    // Lookup table for a key which is not ordered in the file, empty if it is:
+    // the sorted keys and, for each, the first entry with a key not below it.
+    struct KeyTable{
+      std::vector<uint64_t> keys;
+      std::vector<uint32_t> first;
+    };
+  private:
+    std::vector<EventIndexEntry> m_entries;
+    KeyTable m_by_event;
+    KeyTable m_by_trigger;
+    KeyTable m_by_ts;
+  };
+
+  class DLLEXPORT EventIndexWriter{
+  public:
+    EventIndexWriter(const std::string &rawfile, bool overwrite = false);
+    ~EventIndexWriter();
+    void Write(const Event &ev, uint64_t offset);
+    void Flush();
+  private:
+    std::unique_ptr<FileSerializer> m_ser;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_EventIndex
@@ -17,6 +17,7 @@ namespace eudaq{
     ~FileDeserializer();
     virtual bool HasData();
     bool ReadEvent(int ver, EventSP &ev, size_t skip = 0);
+    void Seek(uint64_t pos);
     
   private:
     virtual void Deserialize(uint8_t *data, size_t len);
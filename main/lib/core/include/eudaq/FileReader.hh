@@ -30,6 +30,15 @@ namespace eudaq{
     void SetConfiguration(ConfigurationSPC c) {m_conf = c;};
     ConfigurationSPC GetConfiguration() const {return m_conf;};
     virtual EventSPC GetNextEvent() {return nullptr;};
+    // Random access, positions the reader such that GetNextEvent() returns
+    // the event with the smallest event/trigger number or begin timestamp
+    // not below the given value. Returns false if not supported or not found.
+    virtual bool SeekEvent(uint32_t) {return false;};
+    virtual bool SeekTrigger(uint32_t) {return false;};
+    virtual bool SeekTimestamp(uint64_t) {return false;};
+    // True if the key of the last successful Seek never decreases in the
+    // rest of the file, so reading may stop at an upper bound of that key.
+    virtual bool SeekOrdered() const {return false;};
     static FileReaderSP Make(std::string type, std::string path);
   private:
     ConfigurationSPC m_conf;
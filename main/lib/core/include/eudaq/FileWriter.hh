@@ -26,6 +26,13 @@ namespace eudaq {
   using FileWriterUP = Factory<FileWriter>::UP_BASE;
   using FileWriterSP = Factory<FileWriter>::SP_BASE;
 
+  // Writer specific result of FileWriter::PrepareEvent
+  class DLLEXPORT PreparedEvent {
+  public:
+    virtual ~PreparedEvent() = default;
+  };
+  using PreparedEventSP = std::shared_ptr<PreparedEvent>;
+
   //----------DOC-MARK-----BEG*DEC-----DOC-MARK----------
   class DLLEXPORT FileWriter {
   public:
@@ -34,6 +41,12 @@ namespace eudaq {
     void SetConfiguration(ConfigurationSPC c) {m_conf = c;};
     ConfigurationSPC GetConfiguration() const {return m_conf;};
     virtual void WriteEvent(EventSPC) {};
+    // Writing with several threads (e.g. euCliConverter -j): PrepareEvent
+    // does the work which may run concurrently for different events, like
+    // the conversion. WritePrepared is then called in the order of the events.
+    virtual PreparedEventSP PrepareEvent(EventSPC) {return nullptr;};
+    virtual void WritePrepared(EventSPC ev, PreparedEventSP) {WriteEvent(ev);};
+    virtual void Flush() {};
     virtual uint64_t FileBytes() const {return 0;};
     static FileWriterSP Make(std::string type, std::string path);
   private:
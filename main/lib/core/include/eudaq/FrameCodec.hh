@@ -0,0 +1,59 @@
+#ifndef EUDAQ_INCLUDED_FrameCodec
+#define EUDAQ_INCLUDED_FrameCodec
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Serializer.hh"
+#include "eudaq/Deserializer.hh"
+#include <string>
+#include <vector>
+
+namespace eudaq {
+
+  // Block compression of the frames of the native-z file format.
+  // zlib, LZ4 and zstd are optional and only available if the library was
+  // found when eudaq was built.
+  class DLLEXPORT FrameCodec {
+  public:
+    enum Type : uint32_t {
+      NONE = 0,
+      ZLIB = 1,
+      LZ4 = 2,
+      ZSTD = 3
+    };
+
+    static bool IsAvailable(Type t);
+    static Type FromString(const std::string &name);
+    static std::string ToString(Type t);
+    // The best codec of this build: zstd, LZ4, zlib or NONE in this order.
+    static Type Default();
+
+    static void Compress(Type t, int level, const uint8_t *src, size_t len,
+                         std::vector<uint8_t> &dst);
+    static void Decompress(Type t, const uint8_t *src, size_t len,
+                           uint8_t *dst, size_t rawlen);
+  };
+
+  // Layout of the native-z file: the file header (magic, version) followed
+  // by independently compressed frames, each holding a few MB of natively
+  // serialized events behind this header.
+  struct DLLEXPORT FrameHeader {
+    uint32_t codec;
+    uint32_t n_event;
+    uint32_t event_first;
+    uint32_t event_last;
+    uint32_t trigger_first;
+    uint32_t trigger_last;
+    uint64_t ts_first;
+    uint64_t ts_last;
+    uint64_t raw_bytes;
+    uint64_t stored_bytes;
+
+    void Serialize(Serializer &ser) const;
+    void Deserialize(Deserializer &des);
+    static const size_t m_size = 56;
+    static const char m_file_magic[8];
+    static const uint32_t m_file_version = 1;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_FrameCodec
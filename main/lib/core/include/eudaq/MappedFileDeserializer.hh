@@ -0,0 +1,38 @@
+#ifndef EUDAQ_INCLUDED_MappedFileDeserializer
+#define EUDAQ_INCLUDED_MappedFileDeserializer
+
+#include "eudaq/Deserializer.hh"
+#include "eudaq/Platform.hh"
+#include <memory>
+#include <string>
+
+namespace eudaq{
+  class MappedFile;
+
+  // Deserializer reading from a memory-mapped file.
+  // Blocks read through Borrow() point directly into the mapping, which is
+  // kept alive by the events referring to it (see GetBacking()).
+  class DLLEXPORT MappedFileDeserializer : public Deserializer {
+  public:
+    MappedFileDeserializer(const std::string &fname);
+    ~MappedFileDeserializer();
+    bool HasData() override;
+    std::shared_ptr<const void> GetBacking() const override;
+
+    uint64_t Tell() const {return m_pos;};
+    void Seek(uint64_t pos);
+    uint64_t FileBytes() const;
+
+  private:
+    void Deserialize(uint8_t *data, size_t len) override;
+    void PreDeserialize(uint8_t *data, size_t len) override;
+    const uint8_t *BorrowDeserialize(size_t len) override;
+    void Require(size_t len);
+    bool Remap();
+    std::string m_fname;
+    std::shared_ptr<MappedFile> m_map;
+    uint64_t m_pos;
+    uint64_t m_stat_size;
+  };
+}
+#endif // EUDAQ_INCLUDED_MappedFileDeserializer
@@ -0,0 +1,82 @@
+#ifndef EUDAQ_INCLUDED_MonitorPublisher
+#define EUDAQ_INCLUDED_MonitorPublisher
+
+#include "eudaq/DataSender.hh"
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/Platform.hh"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace eudaq {
+
+  // Fans the events of a DataCollector out to its monitors without ever
+  // holding up data taking. Publish() only samples and queues the event, a
+  // publisher thread serializes every sampled event once and hands the same
+  // buffer to all monitors. Every monitor is served by its own thread from
+  // its own bounded queue; when a monitor does not keep up, its oldest
+  // buffers are dropped.
+  // Events are sampled by fraction (every n-th) and by rate (at most so many
+  // per second), BORE and EORE always pass.
+  class DLLEXPORT MonitorPublisher{
+  public:
+    MonitorPublisher(const std::string &type, const std::string &name);
+    ~MonitorPublisher();
+    void SetFraction(uint32_t n){m_fraction = n;};
+    void SetRate(double hz);
+    void SetQueueSize(size_t n){m_capacity = n ? n : 1;};
+
+    void Subscribe(const std::string &server);
+    void Clear();
+    void Publish(EventSPC ev);
+
+    size_t Subscribers();
+    uint64_t SampledCount() const {return m_sampled_n;};
+    uint64_t DroppedCount();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using Buffer = std::shared_ptr<const BufferSerializer>;
+    struct Subscriber{
+      std::unique_ptr<DataSender> sender;
+      std::mutex mx;
+      std::condition_variable cv;
+      std::deque<Buffer> queue;
+      uint64_t dropped_n;
+      bool exit;
+      bool done;
+    };
+    using SubscriberSP = std::shared_ptr<Subscriber>;
+    void Serializing();
+    static void Sending(SubscriberSP sub);
+
+    std::string m_type;
+    std::string m_name;
+    std::atomic<uint32_t> m_fraction;
+    std::atomic<int64_t> m_interval_ns;
+    std::atomic<size_t> m_capacity;
+
+    std::mutex m_mx;
+    std::condition_variable m_cv;
+    std::deque<EventSPC> m_queue;
+    std::vector<SubscriberSP> m_subs;
+    uint64_t m_seen_n;
+    Clock::time_point m_next;
+    std::atomic<uint64_t> m_sampled_n;
+    uint64_t m_dropped_n;
+    size_t m_reserve;
+    bool m_busy;
+    bool m_exit;
+    std::thread m_thread;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_MonitorPublisher
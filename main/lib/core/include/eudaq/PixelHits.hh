@@ -0,0 +1,79 @@
+#ifndef EUDAQ_INCLUDED_PixelHits
+#define EUDAQ_INCLUDED_PixelHits
+
+#include "eudaq/Serializable.hh"
+#include "eudaq/Serializer.hh"
+#include "eudaq/Deserializer.hh"
+#include "eudaq/Platform.hh"
+
+#include <vector>
+#include <cstdint>
+
+namespace eudaq {
+
+  /// Zero-suppressed hits of one frame of a StandardPlane, stored as columns:
+  /// 16-bit coordinates and only the selected optional columns, a 32-bit
+  /// value, a timestamp in picoseconds and a pivot flag. A hit has the value
+  /// 1 without a value column, time 0 without a time column and no pivot
+  /// without a pivot column. The columns are serialized in bulk.
+  class DLLEXPORT PixelHits : public Serializable {
+  public:
+    enum COLUMNS {
+      COL_VALUE = 0x1,
+      COL_TIME = 0x2,
+      COL_PIVOT = 0x4
+    };
+    explicit PixelHits(int columns = 0);
+    PixelHits(Deserializer &);
+    void Serialize(Serializer &) const override;
+
+    int Columns() const { return m_columns; }
+    bool HasColumn(int col) const { return (m_columns & col) != 0; }
+    size_t Size() const { return m_x.size(); }
+    bool Empty() const { return m_x.empty(); }
+    /// Memory of the hits in bytes
+    size_t Bytes() const;
+
+    void Reserve(size_t n);
+    void Resize(size_t n);
+    void Clear();
+    void Push(uint16_t x, uint16_t y, int32_t value = 1, uint64_t time_ps = 0, bool pivot = false) {
+      m_x.push_back(x);
+      m_y.push_back(y);
+      if (m_columns & COL_VALUE)
+        m_value.push_back(value);
+      if (m_columns & COL_TIME)
+        m_time.push_back(time_ps);
+      if (m_columns & COL_PIVOT)
+        m_pivot.push_back(pivot);
+    }
+    /// Append n hits, the columns not given (null) get their defaults
+    void Append(size_t n, const uint16_t *x, const uint16_t *y, const int32_t *value = nullptr,
+                const uint64_t *time_ps = nullptr, const uint8_t *pivot = nullptr);
+    void Set(size_t i, uint16_t x, uint16_t y, int32_t value, uint64_t time_ps, bool pivot);
+    void SetPivot(size_t i, bool pivot);
+
+    uint16_t X(size_t i) const { return m_x[i]; }
+    uint16_t Y(size_t i) const { return m_y[i]; }
+    int32_t Value(size_t i) const { return (m_columns & COL_VALUE) ? m_value[i] : 1; }
+    uint64_t Time(size_t i) const { return (m_columns & COL_TIME) ? m_time[i] : 0; }
+    bool Pivot(size_t i) const { return (m_columns & COL_PIVOT) ? m_pivot[i] != 0 : false; }
+
+    /// The columns, empty if not selected
+    const std::vector<uint16_t> &XColumn() const { return m_x; }
+    const std::vector<uint16_t> &YColumn() const { return m_y; }
+    const std::vector<int32_t> &ValueColumn() const { return m_value; }
+    const std::vector<uint64_t> &TimeColumn() const { return m_time; }
+    const std::vector<uint8_t> &PivotColumn() const { return m_pivot; }
+
+  private:
+    uint32_t m_columns;
+    std::vector<uint16_t> m_x, m_y;
+    std::vector<int32_t> m_value;
+    std::vector<uint64_t> m_time;
+    std::vector<uint8_t> m_pivot;
+  };
+
+} // namespace eudaq
+
+#endif // EUDAQ_INCLUDED_PixelHits
@@ -38,6 +38,16 @@ using std::size_t;
 #define DLLEXPORT
 #endif
 
+// EUDAQ_LITTLE_ENDIAN is defined if the byte order of the host matches the
+// (little-endian) byte order of the serialized data.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define EUDAQ_LITTLE_ENDIAN
+#endif
+#elif defined(_WIN32)
+#define EUDAQ_LITTLE_ENDIAN
+#endif
+
 
 #include <memory>
 
@@ -10,9 +10,23 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstring>
+#include <type_traits>
 
 namespace eudaq {
 
+  // Arithmetic types whose in-memory representation is identical to the
+  // serialized one, so that contiguous arrays of them can be copied in bulk.
+  template <typename T> struct IsBulkCopyable
+    : std::integral_constant<bool,
+#ifdef EUDAQ_LITTLE_ENDIAN
+                             std::is_arithmetic<T>::value &&
+                             !std::is_same<T, bool>::value
+#else
+                             false
+#endif
+                             > {};
+
   class InterruptedException : public std::exception {
     const char *what() const throw() { return "InterruptedException"; }
   };
@@ -31,6 +45,10 @@ namespace eudaq {
     virtual uint64_t GetCheckSum();
   private:
     template <typename T> friend struct WriteHelper;
+    template <typename T>
+    void write_elements(const std::vector<T> &t, std::true_type);
+    template <typename T>
+    void write_elements(const std::vector<T> &t, std::false_type);
     virtual void Serialize(const uint8_t *, size_t) = 0;
   };
 
@@ -63,14 +81,23 @@ namespace eudaq {
       static_assert(sizeof(v) > 1, "Called write_int() in Serializer.hh which "
                                    "only supports integers of size > 1 byte!");
       T t = v;
+#ifdef EUDAQ_LITTLE_ENDIAN
+      sr.Serialize(reinterpret_cast<const uint8_t *>(&t), sizeof t);
+#else
       uint8_t buf[sizeof v];
       for (size_t i = 0; i < sizeof v; ++i) {
         buf[i] = static_cast<uint8_t>(t & 0xff);
         t >>= 8;
       }
       sr.Serialize(buf, sizeof v);
+#endif
     }
     static void write_float(Serializer &sr, const float &v) {
+#ifdef EUDAQ_LITTLE_ENDIAN
+      uint8_t buf[sizeof v];
+      std::memcpy(buf, &v, sizeof v);
+      sr.Serialize(buf, sizeof v);
+#else
       unsigned t = *(unsigned *)&v;
       uint8_t buf[sizeof t];
       for (size_t i = 0; i < sizeof t; ++i) {
@@ -78,8 +105,14 @@ namespace eudaq {
         t >>= 8;
       }
       sr.Serialize(buf, sizeof t);
+#endif
     }
     static void write_double(Serializer &sr, const double &v) {
+#ifdef EUDAQ_LITTLE_ENDIAN
+      uint8_t buf[sizeof v];
+      std::memcpy(buf, &v, sizeof v);
+      sr.Serialize(buf, sizeof v);
+#else
       uint64_t t = *(uint64_t *)&v;
       uint8_t buf[sizeof t];
       for (size_t i = 0; i < sizeof t; ++i) {
@@ -87,6 +120,7 @@ namespace eudaq {
         t >>= 8;
       }
       sr.Serialize(buf, sizeof t);
+#endif
     }
   };
 
@@ -115,7 +149,18 @@ namespace eudaq {
   template <typename T> inline void Serializer::write(const std::vector<T> &t) {
     unsigned len = t.size();
     write(len);
-    for (size_t i = 0; i < len; ++i) {
+    write_elements(t, IsBulkCopyable<T>());
+  }
+
+  template <typename T>
+  inline void Serializer::write_elements(const std::vector<T> &t, std::true_type) {
+    if (!t.empty())
+      Serialize(reinterpret_cast<const uint8_t *>(t.data()), t.size() * sizeof(T));
+  }
+
+  template <typename T>
+  inline void Serializer::write_elements(const std::vector<T> &t, std::false_type) {
+    for (size_t i = 0; i < t.size(); ++i) {
       write(t[i]);
     }
   }
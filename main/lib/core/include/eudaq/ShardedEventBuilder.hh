@@ -0,0 +1,93 @@
+#ifndef EUDAQ_INCLUDED_ShardedEventBuilder
+#define EUDAQ_INCLUDED_ShardedEventBuilder
+
+#include "eudaq/EventBuilder.hh"
+#include "eudaq/Platform.hh"
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace eudaq {
+
+  // Runs the trigger or event number matching of an EventBuilder on several
+  // threads. Fragments are distributed by key modulo the number of shards,
+  // every shard builds its events with its own EventBuilder, and the built
+  // events are merged back into key order before they are handed to the
+  // output one at a time. Streams are added to and ended in all shards.
+  // With zero shards everything runs in the calling thread.
+  // Push() and the stream calls are serialized by the owner, the output is
+  // called from the shard threads.
+  class DLLEXPORT ShardedEventBuilder{
+  public:
+    ShardedEventBuilder(uint32_t key, const std::string &dspt, EventBuilder::Output out);
+    ~ShardedEventBuilder();
+    void Configure(const Configuration &conf);
+
+    void AddStream(uint32_t id);
+    void RemoveStream(uint32_t id);
+    void Push(uint32_t id, EventSPC ev);
+    void Poll();
+    void Reset();
+
+    bool HasStream(uint32_t id) const;
+    size_t Shards() const {return m_shards.size();};
+    size_t PendingSize();
+    uint64_t PartialCount();
+    uint64_t LateCount();
+    uint64_t OrphanCount();
+    std::map<uint32_t, uint64_t> MissingCounts();
+
+  private:
+    enum JobType {PUSH, ADD, END, RESET};
+    struct Job{
+      JobType type;
+      uint32_t id;
+      EventSPC ev;
+      uint64_t key;
+    };
+    struct Shard{
+      std::unique_ptr<EventBuilder> evb;
+      std::mutex mx;
+      std::condition_variable cv;
+      std::vector<Job> jobs;
+      std::vector<std::pair<uint64_t, EventUP>> built;
+      std::deque<std::pair<uint64_t, EventUP>> out;
+      uint64_t floor;
+      uint64_t queued_floor;
+      size_t pending_n;
+      uint64_t partial_n;
+      uint64_t late_n;
+      uint64_t orphan_n;
+      std::map<uint32_t, uint64_t> missing;
+      bool exit;
+      std::thread thread;
+    };
+    std::unique_ptr<EventBuilder> MakeBuilder(EventBuilder::Output out);
+    void StartShards(uint32_t n);
+    void StopShards();
+    void Post(Shard &sd, Job &&job);
+    void Running(Shard *sd);
+    void Merge();
+
+    uint32_t m_key;
+    std::string m_dspt;
+    EventBuilder::Output m_out;
+    std::unique_ptr<Configuration> m_conf;
+    std::unique_ptr<EventBuilder> m_evb;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::map<uint32_t, EventBuilder::TriggerCounter> m_counters;
+    EventBuilder::TriggerCounter m_tg_epoch;
+    uint64_t m_trigger_mask;
+    std::mutex m_mx_merge;
+    bool m_merge_any;
+    uint64_t m_merge_last;
+    uint64_t m_late_n;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_ShardedEventBuilder
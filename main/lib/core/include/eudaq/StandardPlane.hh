@@ -6,6 +6,7 @@
 #include "eudaq/Deserializer.hh"
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
+#include "eudaq/PixelHits.hh"
 
 #include <vector>
 #include <string>
@@ -21,7 +22,8 @@ namespace eudaq {
       FLAG_ACCUMULATE = 0x8, // Multiple frames should be accumulated for output
       FLAG_WITHPIVOT = 0x10000, // Include before/after pivot boolean per pixel
       FLAG_WITHSUBMAT = 0x20000, // Include Submatrix ID per pixel
-      FLAG_DIFFCOORDS = 0x40000 // Each frame can have different coordinates (in ZS mode)
+      FLAG_DIFFCOORDS = 0x40000, // Each frame can have different coordinates (in ZS mode)
+      FLAG_COMPACT = 0x80000 // Hits are stored as PixelHits (see SetSizeCompact)
     };
     typedef double pixel_t;
     typedef double coord_t;
@@ -33,6 +35,15 @@ namespace eudaq {
     void SetSizeRaw(uint32_t w, uint32_t h, uint32_t frames = 1, int flags = 0);
     void SetSizeZS(uint32_t w, uint32_t h, uint32_t npix, uint32_t frames = 1,
                    int flags = 0);
+    // Zero suppressed, with the hits of each frame in compact columns
+    // (PixelHits::COLUMNS), for sensors with up to 65536 pixels per side.
+    // The accessors below read them, the vector ones through a copy as double.
+    void SetSizeCompact(uint32_t w, uint32_t h, int columns, uint32_t frames = 1,
+                        int flags = 0);
+    bool IsCompact() const { return (m_flags & FLAG_COMPACT) != 0; }
+    // The hits of a compact plane, to reserve and append them in bulk
+    PixelHits &Hits(uint32_t frame = 0);
+    const PixelHits &Hits(uint32_t frame = 0) const;
 
     template <typename T>
       void SetPixel(uint32_t index, uint32_t x, uint32_t y, T pix,
@@ -51,6 +62,8 @@ namespace eudaq {
       SetPixelHelper(index, x, y, (double)pix, 0, false, frame);
     }
     void PushPixel(uint16_t x, uint16_t y, double adc, double charge){
+      if (IsCompact()) // no charge column
+        return PushPixelHelper(x, y, adc, 0, false, 0);
       m_x[0].push_back(x);
       m_y[0].push_back(y);
       m_pix[0].push_back(adc);
@@ -128,6 +141,11 @@ namespace eudaq {
     const std::vector<pixel_t> &
       GetFrame(const std::vector<std::vector<pixel_t>> &v, uint32_t f) const;
     void SetupResult() const;
+    // fills the vectors below from the hits of a compact plane
+    void SyncView() const;
+    const PixelHits &HitsAt(uint32_t index, uint32_t frame) const;
+    // a compact plane whose hits are the result as they are
+    bool DirectHits() const;
 
     std::string m_type;
     std::string m_sensor;
@@ -139,12 +157,15 @@ namespace eudaq {
 
     // Timestamp of this plane in picoseconds
     uint64_t m_timestamp{};
-    std::vector<std::vector<pixel_t>> m_pix;
-    std::vector<std::vector<pixel_t>> m_charge;
-    std::vector<std::vector<coord_t>> m_x, m_y;
-    std::vector<std::vector<uint64_t>> m_time;
-    std::vector<std::vector<bool>> m_pivot;
+    // for compact planes a view of m_hits, filled on demand
+    mutable std::vector<std::vector<pixel_t>> m_pix;
+    mutable std::vector<std::vector<pixel_t>> m_charge;
+    mutable std::vector<std::vector<coord_t>> m_x, m_y;
+    mutable std::vector<std::vector<uint64_t>> m_time;
+    mutable std::vector<std::vector<bool>> m_pivot;
     std::vector<uint32_t> m_mat;
+    std::vector<PixelHits> m_hits;
+    mutable bool m_view_valid{};
 
     mutable const std::vector<pixel_t> *m_result_pix;
     mutable const std::vector<coord_t> *m_result_x, *m_result_y;
@@ -25,9 +25,7 @@ namespace eudaq {
       uint16_t GetNSamples() const {return m_n_samples;}
       template <typename T>
       void SetWaveform(T (*data)) {//todo: FIx issue with template
-        m_samples.clear();
-        for (size_t i = 0; i < m_n_samples;i++)
-          m_samples.push_back(data[i]);
+        m_samples.assign(data, data + m_n_samples);
       } //todo: FIx issue with template
 //	void SetWaveform(float* data);
       std::vector<float>* GetData() const{return &m_samples;};
@@ -64,6 +62,7 @@ namespace eudaq {
       float getMedian(uint32_t min, uint32_t max) const;
 
       std::vector<uint16_t> * getAllPeaksAbove(uint16_t min, uint16_t max, float threshold) const;
+      void getAllPeaksAbove(uint16_t min, uint16_t max, float threshold, std::vector<uint16_t> &peaks) const;
       std::pair<uint16_t, float> getMaxPeak() const;
       float getSpreadInRange(int min, int max) const{return (getMaxInRange(min,max)-getMinInRange(min,max));};
       float getPeakToPeak(int min, int max) const{return getSpreadInRange(min,max);}
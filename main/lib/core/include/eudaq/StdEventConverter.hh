@@ -22,7 +22,23 @@ namespace eudaq{
     StdEventConverter(const StdEventConverter&) = delete;
     StdEventConverter& operator = (const StdEventConverter&) = delete;
     bool Converting(EventSPC d1, StdEventSP d2, ConfigurationSPC conf) const override = 0;
+    // Called on the instance of a thread before it converts the first event
+    // of a run, and after the last one. State of a run belongs here.
+    virtual void BeginRun(uint32_t /*run_n*/, ConfigurationSPC /*conf*/){};
+    virtual void EndRun(){};
+    // True if converting an event depends on the earlier events of its
+    // stream. Such events are then converted in order by a single thread.
+    virtual bool KeepsStreamState() const {return false;};
+
     static bool Convert(EventSPC d1, StdEventSP d2, ConfigurationSPC conf);
+    // The instance of converter id kept for the calling thread, nullptr if
+    // no such converter is registered. Starts run run_n of the instance.
+    static StdEventConverter *GetThreadInstance(uint32_t id, uint32_t run_n, ConfigurationSPC conf);
+    // Ends the run of all instances of the calling thread and deletes them.
+    static void ReleaseThreadInstances();
+    // Looks for ev or a sub-event of it whose converter keeps a state per
+    // stream and sets stream to its stream number. False if there is none.
+    static bool FindStateStream(EventSPC ev, uint32_t &stream);
   };
 
 }
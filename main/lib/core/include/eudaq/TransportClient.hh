@@ -21,6 +21,16 @@ namespace eudaq {
 
     virtual ~TransportClient();
     static TransportClient* CreateClient(const std::string &name);
+
+    /** Controls how small packets are put on the wire, transports without
+     * such a notion ignore them.
+     * NoDelay sends every packet immediately (TCP_NODELAY), Cork holds back
+     * partial frames until Flush() is called or the kernel times out
+     * (TCP_CORK), so that bursts of small packets share frames.
+     */
+    virtual void SetNoDelay(bool) {}
+    virtual void SetCork(bool) {}
+    virtual void Flush() {}
   };
 }
 
@@ -26,8 +26,11 @@ namespace eudaq {
     ConnectionInfoTCP(const ConnectionInfoTCP&) = delete;
     ConnectionInfoTCP& operator = (const ConnectionInfoTCP&) = delete;   
     ConnectionInfoTCP(SOCKET fd, const std::string &host = "")
-      : m_fd(fd), m_host(host), m_len(0), m_buf(""), ConnectionInfo("") {}
+      : ConnectionInfo(""), m_fd(fd), m_host(host), m_len(0),
+        m_head(0), m_tail(0) {}
     void append(size_t length, const char *data);
+    char *recvbuffer(size_t length);
+    void recvcommit(size_t length);
     bool havepacket() const;
     std::string getpacket();
     SOCKET GetFd() const { return m_fd; }
@@ -40,7 +43,11 @@ namespace eudaq {
     SOCKET m_fd;
     std::string m_host;
     size_t m_len;
-    std::string m_buf;
+    // receive buffer, unread bytes are [m_head, m_tail); it is compacted
+    // instead of erased from the front, so the storage is reused
+    std::vector<char> m_buf;
+    size_t m_head;
+    size_t m_tail;
   };
   
   class TCPServer : public TransportServer {
@@ -61,10 +68,16 @@ namespace eudaq {
     
     int m_port;
     SOCKET m_srvsock;
+#if EUDAQ_PLATFORM_IS(LINUX)
+    int m_epfd;
+#else
     SOCKET m_maxfd;
     fd_set m_fdset;
+#endif
 
     std::shared_ptr<ConnectionInfoTCP> GetInfo(SOCKET fd) const;
+    void AcceptConnection();
+    bool ReceiveFrom(SOCKET fd);
   };
 
   class TCPClient : public TransportClient {
@@ -76,6 +89,9 @@ namespace eudaq {
                             const ConnectionInfo &id = ConnectionInfo::ALL,
                             bool = false);
     virtual void ProcessEvents(int timeout = -1);
+    void SetNoDelay(bool enable) override;
+    void SetCork(bool enable) override;
+    void Flush() override;
     static const std::string name;
   private:
     void OpenConnection();
@@ -83,6 +99,7 @@ namespace eudaq {
     int m_port;
     SOCKET m_sock;
     std::shared_ptr<ConnectionInfoTCP> m_buf;
+    bool m_cork;
   };
 }
 
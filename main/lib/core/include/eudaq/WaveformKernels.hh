@@ -0,0 +1,73 @@
+#ifndef EUDAQ_INCLUDED_WaveformKernels
+#define EUDAQ_INCLUDED_WaveformKernels
+
+#include "eudaq/Platform.hh"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eudaq{
+  // Analysis kernels over the float samples of a waveform, vectorised with
+  // AVX2 or SSE2 if the CPU has them (chosen at run time) and scalar
+  // otherwise. All kernels take the first sample and the number of samples,
+  // indices are relative to the first sample. Sums are accumulated in
+  // several lanes and can differ from a sequential sum by rounding.
+  namespace waveform{
+    enum class Isa{SCALAR, SSE2, AVX2};
+    // The instruction set in use: the best one of the CPU, up to SetMaxIsa
+    DLLEXPORT Isa GetIsa();
+    // Limits the instruction set, e.g. to compare with the scalar kernels
+    DLLEXPORT void SetMaxIsa(Isa isa);
+    DLLEXPORT const char *IsaName(Isa isa);
+
+    DLLEXPORT float Sum(const float *s, size_t n);
+    DLLEXPORT float AbsSum(const float *s, size_t n);
+    // First index of the minimum and of the maximum, n if there are no samples
+    DLLEXPORT void MinMax(const float *s, size_t n, size_t &imin, size_t &imax);
+    // First i with s[i-1] < t <= s[i] (rising) or s[i-1] > t >= s[i]
+    // (falling), n if there is none
+    DLLEXPORT size_t Crossing(const float *s, size_t n, float t, bool rising);
+    // The same, the last such i
+    DLLEXPORT size_t LastCrossing(const float *s, size_t n, float t, bool rising);
+    // Fractional index where the line from sample i-1 to sample i reaches t
+    inline float CrossingTime(const float *s, size_t i, float t){
+      return float(i - 1) + (t - s[i-1]) / (s[i] - s[i-1]);
+    }
+    // Median, the mean of the two central samples for an even number
+    DLLEXPORT float Median(const float *s, size_t n);
+    // Pulses with |s| above the threshold for more than min_width samples.
+    // A pulse starts after a sample below the threshold and ends before
+    // one, the pulses cut by the ends of the samples are not found. Appends
+    // the index of the largest |s| of each pulse, if it is more than
+    // min_distance after the previous one.
+    DLLEXPORT void PeaksAbove(const float *s, size_t n, float threshold, std::vector<uint16_t> &peaks,
+                              size_t min_width = 5, size_t min_distance = 35);
+
+    struct Params{
+      size_t baseline_begin = 0; // the baseline is the mean of these samples
+      size_t baseline_end = 0;
+      size_t begin = 0;          // signal window
+      size_t end = 0;
+      int polarity = 1;          // sign of the pulses
+      float threshold = 0;       // leading edge threshold, above the baseline
+      float cfd_fraction = 0.5;  // of the amplitude, for constant fraction timing
+    };
+
+    struct Result{
+      float baseline = 0;
+      float integral = 0;        // of the signal window above the baseline
+      size_t peak = 0;           // index of the pulse maximum
+      float amplitude = 0;       // of the pulse maximum above the baseline
+      float threshold_time = -1; // fractional index of the leading edge, -1 if none
+      float cfd_time = -1;       // fractional index of the last constant fraction
+                                 // crossing before the peak, -1 if none
+    };
+
+    // Analyses all channels of an event, integral, amplitude and thresholds
+    // are in the direction of the polarity
+    DLLEXPORT void Analyse(const float *const *channels, size_t n_channels, const Params &p,
+                           Result *results);
+  }
+}
+
+#endif // EUDAQ_INCLUDED_WaveformKernels
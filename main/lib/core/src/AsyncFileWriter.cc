@@ -0,0 +1,97 @@
+#include "eudaq/AsyncFileWriter.hh"
+#include "eudaq/Exception.hh"
+#include <chrono>
+
+namespace eudaq {
+
+  AsyncFileWriter::AsyncFileWriter(FileWriterSP writer, size_t capacity)
+    :m_writer(writer), m_capacity(capacity ? capacity : 1), m_busy(false), m_exit(false),
+     m_high_water(0), m_blocked_n(0), m_blocked_us(0), m_filebytes(0){
+    if(!m_writer)
+      EUDAQ_THROW("AsyncFileWriter: no FileWriter to write to");
+    m_thread = std::thread(&AsyncFileWriter::Writing, this);
+  }
+
+  AsyncFileWriter::~AsyncFileWriter(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    m_exit = true;
+    lk.unlock();
+    m_cv_pop.notify_all();
+    if(m_thread.joinable())
+      m_thread.join();
+  }
+
+  void AsyncFileWriter::WriteEvent(EventSPC ev){
+    std::unique_lock<std::mutex> lk(m_mx);
+    if(!m_error.empty())
+      EUDAQ_THROW("AsyncFileWriter: " + m_error);
+    if(m_queue.size() >= m_capacity){
+      auto tp_start = std::chrono::steady_clock::now();
+      m_cv_push.wait(lk, [this](){return m_queue.size() < m_capacity || !m_error.empty();});
+      m_blocked_n ++;
+      m_blocked_us += std::chrono::duration_cast<std::chrono::microseconds>
+	(std::chrono::steady_clock::now() - tp_start).count();
+      if(!m_error.empty())
+	EUDAQ_THROW("AsyncFileWriter: " + m_error);
+    }
+    m_queue.push_back(ev);
+    if(m_queue.size() > m_high_water)
+      m_high_water = m_queue.size();
+    lk.unlock();
+    m_cv_pop.notify_one();
+  }
+
+  void AsyncFileWriter::Flush(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    m_cv_push.wait(lk, [this](){return (m_queue.empty() && !m_busy) || !m_error.empty();});
+    if(!m_error.empty())
+      EUDAQ_THROW("AsyncFileWriter: " + m_error);
+    m_writer->Flush();
+  }
+
+  uint64_t AsyncFileWriter::FileBytes() const{
+    return m_filebytes;
+  }
+
+  size_t AsyncFileWriter::QueueSize(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    return m_queue.size();
+  }
+
+  void AsyncFileWriter::Writing(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    while(true){
+      m_cv_pop.wait(lk, [this](){return !m_queue.empty() || m_exit;});
+      if(m_queue.empty())
+	break;
+      // take everything queued so far and write it as one batch
+      std::deque<EventSPC> batch;
+      batch.swap(m_queue);
+      m_busy = true;
+      lk.unlock();
+      m_cv_push.notify_all();
+      try{
+	for(auto &ev: batch)
+	  m_writer->WriteEvent(ev);
+	batch.clear();
+	lk.lock();
+	if(m_queue.empty()){
+	  lk.unlock();
+	  m_writer->Flush();
+	  lk.lock();
+	}
+      }catch (const std::exception &e){
+	if(!lk.owns_lock())
+	  lk.lock();
+	m_error = e.what();
+      }
+      m_filebytes = m_writer->FileBytes();
+      m_busy = false;
+      m_cv_push.notify_all();
+      if(!m_error.empty()){
+	m_queue.clear();
+	break;
+      }
+    }
+  }
+}
@@ -12,10 +12,11 @@ namespace eudaq {
   Factory<DataCollector>::Instance<const std::string&, const std::string&>(); //TODO
   
   DataCollector::DataCollector(const std::string &name, const std::string &runcontrol)
-    :CommandReceiver("DataCollector", name, runcontrol){
+    :CommandReceiver("DataCollector", name, runcontrol),
+     m_publisher("DataCollector", name){
     m_dct_n= str2hash(GetFullName());
     m_evt_c = 0;
-    m_fraction = 1;
+    m_write_queue = 0;
   }
 
   DataCollector::~DataCollector(){  
@@ -80,7 +81,11 @@ namespace eudaq {
       m_fwtype = conf->Get("EUDAQ_FW", "native");
       m_fwpatt = conf->Get("EUDAQ_FW_PATTERN", "$12D_run$6R$X");
       m_dct_n = conf->Get("EUDAQ_ID", m_dct_n);
-      m_fraction = conf->Get("EUDAQ_DATACOL_SEND_MONITOR_FRACTION", 10);
+      m_publisher.SetFraction(conf->Get("EUDAQ_DATACOL_SEND_MONITOR_FRACTION", 10));
+      m_publisher.SetRate(conf->Get("EUDAQ_DATACOL_SEND_MONITOR_RATE", 0.0));
+      m_publisher.SetQueueSize(conf->Get("EUDAQ_DATACOL_SEND_MONITOR_QUEUE", 64));
+      m_write_queue = conf->Get("EUDAQ_DATACOL_WRITE_QUEUE", 0);
+      ConfigureReceiveQueue(conf);
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const Exception &e) {
@@ -95,22 +100,26 @@ namespace eudaq {
     try {
       m_data_addr = Listen(m_data_addr);
       SetStatusTag("_SERVER", m_data_addr);
+      m_async_writer.reset();
       m_writer = Factory<FileWriter>::Create<std::string&>(str2hash(m_fwtype), m_fwpatt);
+      if(m_writer){
+	m_writer->SetConfiguration(GetConfiguration());
+	if(m_write_queue){
+	  m_async_writer = std::make_shared<AsyncFileWriter>(m_writer, m_write_queue);
+	  m_writer = m_async_writer;
+	}
+      }
       m_evt_c = 0;
 
       std::string mn_str = GetConfiguration()->Get("EUDAQ_MN", "");
       std::vector<std::string> col_mn_name = split(mn_str, ";,", true);
       std::string cur_backup = GetConfiguration()->GetCurrentSectionName();
       GetConfiguration()->SetSection("");
+      m_publisher.Clear();
       for(auto &mn_name: col_mn_name){
 	std::string mn_addr =  GetConfiguration()->Get("Monitor."+mn_name, "");
-	std::unique_lock<std::mutex> lk(m_mtx_sender);
-	if(!mn_addr.empty()){
-	  m_senders[mn_addr]
-	    = std::shared_ptr<DataSender>(new DataSender("DataCollector", GetName()));
-	  m_senders[mn_addr]->Connect(mn_addr);
-	}
-	lk.unlock();
+	if(!mn_addr.empty())
+	  m_publisher.Subscribe(mn_addr);
       }
       GetConfiguration()->SetSection(cur_backup);
       DoStartRun();
@@ -126,10 +135,12 @@ namespace eudaq {
     EUDAQ_INFO("RUN #" + std::to_string(GetRunNumber()) + " is to be stopped...");
     try {
       DoStopRun();
-      std::unique_lock<std::mutex> lk(m_mtx_sender);
-      m_senders.clear();
-      lk.unlock();
+      // no more events are written once the listener has stopped
       StopListen();
+      auto file_writer = m_writer;
+      if(file_writer)
+	file_writer->Flush();
+      m_publisher.Clear();
       CommandReceiver::OnStopRun();
     } catch (const Exception &e) {
       std::string msg = "Error stopping for run " + std::to_string(GetRunNumber()) + ": " + e.what();
@@ -142,9 +153,7 @@ namespace eudaq {
     EUDAQ_INFO(GetFullName() + " is to be reset...");
     try{
       DoReset();
-      std::unique_lock<std::mutex> lk(m_mtx_sender);
-      m_senders.clear();
-      lk.unlock();
+      m_publisher.Clear();
       StopListen();
       CommandReceiver::OnReset();
     } catch (const std::exception &e) {
@@ -164,7 +173,21 @@ namespace eudaq {
     
   void DataCollector::OnStatus(){
     SetStatusTag("EventN", std::to_string(m_evt_c));
-    SetStatusTag("MonitorEventN", std::to_string(float(m_evt_c/m_fraction)));
+    SetStatusTag("MonitorEventN", std::to_string(m_publisher.SampledCount()));
+    SetStatusTag("MonitorDroppedN", std::to_string(m_publisher.DroppedCount()));
+    SetStatusTag("RecvQueue", std::to_string(ReceiveQueueSize()));
+    SetStatusTag("RecvQueueMax", std::to_string(ReceiveQueueHighWater()));
+    SetStatusTag("RecvQueueBytes", std::to_string(ReceiveQueueBytes()));
+    SetStatusTag("RecvDroppedN", std::to_string(ReceiveDroppedCount()));
+    SetStatusTag("RecvBlockedN", std::to_string(ReceiveBlockedCount()));
+    SetStatusTag("RecvBlockedMs", std::to_string(ReceiveBlockedMicroseconds()/1000));
+    auto async_writer = m_async_writer;
+    if(async_writer){
+      SetStatusTag("WriteQueue", std::to_string(async_writer->QueueSize()));
+      SetStatusTag("WriteQueueMax", std::to_string(async_writer->QueueHighWater()));
+      SetStatusTag("WriteBlockedN", std::to_string(async_writer->BlockedCount()));
+      SetStatusTag("WriteBlockedMs", std::to_string(async_writer->BlockedMicroseconds()/1000));
+    }
     DoStatus();
     // if(m_writer && m_writer->FileBytes()){
     //   SetStatusTag("FILEBYTES", std::to_string(m_writer->FileBytes()));
@@ -201,18 +224,7 @@ namespace eudaq {
 	file_writer->WriteEvent(ev);
       else
 	EUDAQ_THROW("FileWriter is not created before writing.");
-      std::unique_lock<std::mutex> lk(m_mtx_sender);
-      auto senders = m_senders;
-      lk.unlock();
-      if(m_evt_c%m_fraction != 0){
-	return;
-      }
-      for(auto &e: senders){
-	if(e.second)
-	  e.second->SendEvent(ev);
-	else
-	  EUDAQ_THROW("DataCollector::WriterEvent, using a null pointer of DataSender");
-      }
+      m_publisher.Publish(ev);
     }catch (const Exception &e) {
       std::string msg = "Exception writing to file: ";
       msg += e.what();
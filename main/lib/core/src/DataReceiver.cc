@@ -7,10 +7,69 @@
 #include <ostream>
 #include <ctime>
 #include <iomanip>
+#include <algorithm>
+#include <cstring>
 namespace eudaq {
+
+  namespace{
+    // the limit of the former receive queue
+    static const size_t DEFAULT_QUEUE_CAPACITY = 50000;
+
+    // Reads an Event from a received packet. The packet is moved in and kept
+    // alive by the Event, whose data blocks point into it.
+    class PacketDeserializer : public Deserializer{
+    public:
+      PacketDeserializer(std::string &&packet)
+	:m_buf(std::make_shared<const std::string>(std::move(packet))), m_offset(0){};
+      bool HasData() override {return m_offset < m_buf->size();};
+      std::shared_ptr<const void> GetBacking() const override {return m_buf;};
+    private:
+      void Deserialize(uint8_t *data, size_t len) override{
+	PreDeserialize(data, len);
+	m_offset += len;
+      }
+      void PreDeserialize(uint8_t *data, size_t len) override{
+	if(!len)
+	  return;
+	std::memcpy(data, BorrowAt(len), len);
+      }
+      const uint8_t *BorrowDeserialize(size_t len) override{
+	const uint8_t *data = BorrowAt(len);
+	m_offset += len;
+	return data;
+      }
+      const uint8_t *BorrowAt(size_t len) const{
+	if(len + m_offset > m_buf->size())
+	  EUDAQ_THROW("Deserialize asked for " + std::to_string(len) + ", only have " +
+		      std::to_string(m_buf->size() - m_offset));
+	return reinterpret_cast<const uint8_t*>(m_buf->data()) + m_offset;
+      }
+      std::shared_ptr<const std::string> m_buf;
+      size_t m_offset;
+    };
+
+    static EventSP decode_packet(std::string &&packet){
+      PacketDeserializer ser(std::move(packet));
+      uint32_t id;
+      ser.PreRead(id);
+      return Factory<Event>::MakeUnique<Deserializer&>(id, ser);
+    }
+
+    static void warn_dropped(uint64_t n){
+      // every power of two, so that a spill does not flood the log
+      if(n && !(n & (n - 1)))
+	EUDAQ_WARN("DataReceiver: Receive queue is full, " + std::to_string(n)
+		   + " Events dropped so far");
+    }
+  }
   
   DataReceiver::DataReceiver()
-    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"){
+    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"),
+     m_qu_head(0), m_qu_slots(0), m_qu_ev_n(0), m_qu_bytes(0),
+     m_qu_capacity(DEFAULT_QUEUE_CAPACITY), m_qu_max_bytes(0),
+     m_qu_policy(QueuePolicy::DROP_OLDEST), m_qu_high_water(0),
+     m_qu_dropped_n(0), m_qu_blocked_n(0), m_qu_blocked_us(0),
+     m_decode_n(0), m_decode_exit(false){
   }
 
   DataReceiver::~DataReceiver(){
@@ -28,6 +87,217 @@ namespace eudaq {
   
   void DataReceiver::OnReceive(ConnectionSPC id, EventSP ev){
   }
+
+  void DataReceiver::SetReceiveQueue(size_t capacity, uint64_t max_bytes,
+				     QueuePolicy policy){
+    if(!capacity)
+      EUDAQ_THROW("DataReceiver: Capacity of the receive queue must not be 0");
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    m_qu_capacity = capacity;
+    m_qu_max_bytes = max_bytes;
+    m_qu_policy = policy;
+    m_cv_not_full.notify_all();
+  }
+
+  void DataReceiver::ConfigureReceiveQueue(ConfigurationSPC conf){
+    size_t capacity = conf->Get("EUDAQ_DATA_RECV_QUEUE", DEFAULT_QUEUE_CAPACITY);
+    uint64_t max_bytes = conf->Get("EUDAQ_DATA_RECV_QUEUE_BYTES", uint64_t(0));
+    std::string policy = lcase(conf->Get("EUDAQ_DATA_RECV_QUEUE_POLICY", "drop_oldest"));
+    if(policy == "block")
+      SetReceiveQueue(capacity, max_bytes, QueuePolicy::BLOCK);
+    else if(policy == "drop_newest")
+      SetReceiveQueue(capacity, max_bytes, QueuePolicy::DROP_NEWEST);
+    else if(policy == "drop_oldest")
+      SetReceiveQueue(capacity, max_bytes, QueuePolicy::DROP_OLDEST);
+    else
+      EUDAQ_THROW("DataReceiver: Unknown EUDAQ_DATA_RECV_QUEUE_POLICY: " + policy);
+    SetDecodeThreads(conf->Get("EUDAQ_DATA_RECV_DECODE_THREADS", 0));
+  }
+
+  void DataReceiver::SetDecodeThreads(size_t n){
+    // takes effect with the next Listen()
+    m_decode_n = n;
+  }
+
+  void DataReceiver::StartDecoders(){
+    m_decode_exit = false;
+    while(m_decoders.size() < m_decode_n)
+      m_decoders.emplace_back(&DataReceiver::Decoding, this);
+  }
+
+  void DataReceiver::StopDecoders(){
+    std::unique_lock<std::mutex> lk(m_mx_decode);
+    m_decode_exit = true;
+    m_cv_decode.notify_all();
+    lk.unlock();
+    for(auto &t: m_decoders)
+      t.join();
+    m_decoders.clear();
+  }
+
+  void DataReceiver::Decoding(){
+    for(;;){
+      std::unique_lock<std::mutex> lk(m_mx_decode);
+      while(m_decode_jobs.empty() && !m_decode_exit)
+	m_cv_decode.wait(lk);
+      if(m_decode_jobs.empty())
+	return;
+      DecodeJob job = std::move(m_decode_jobs.front());
+      m_decode_jobs.pop_front();
+      lk.unlock();
+      try{
+	job.result.set_value(decode_packet(std::move(job.packet)));
+      }
+      catch(...){
+	job.result.set_exception(std::current_exception());
+      }
+    }
+  }
+
+  size_t DataReceiver::ReceiveQueueSize(){
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    return m_qu_ev_n;
+  }
+
+  uint64_t DataReceiver::ReceiveQueueBytes(){
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    return m_qu_bytes;
+  }
+
+  bool DataReceiver::IsQueueFull(size_t bytes) const {
+    // a single Event is always accepted, even above the byte budget
+    if(!m_qu_ev_n)
+      return false;
+    return m_qu_ev_n >= m_qu_capacity ||
+      (m_qu_max_bytes && m_qu_bytes + bytes > m_qu_max_bytes);
+  }
+
+  void DataReceiver::PushEntry(QueueEntry &&entry){
+    if(m_qu_slots == m_qu_ring.size()){
+      std::vector<QueueEntry> ring(std::max<size_t>(64, m_qu_ring.size() * 2));
+      for(size_t i = 0; i < m_qu_slots; ++i)
+	ring[i] = std::move(m_qu_ring[(m_qu_head + i) % m_qu_ring.size()]);
+      m_qu_ring.swap(ring);
+      m_qu_head = 0;
+    }
+    bool was_empty = !m_qu_slots;
+    if(entry.IsEvent()){
+      m_qu_ev_n++;
+      m_qu_bytes += entry.bytes;
+      if(m_qu_ev_n > m_qu_high_water)
+	m_qu_high_water = m_qu_ev_n;
+    }
+    m_qu_ring[(m_qu_head + m_qu_slots) % m_qu_ring.size()] = std::move(entry);
+    m_qu_slots++;
+    if(was_empty)
+      m_cv_not_empty.notify_all();
+  }
+
+  bool DataReceiver::DropOldest(){
+    bool dropped = false;
+    for(size_t i = 0; i < m_qu_slots; ++i){
+      auto &e = m_qu_ring[(m_qu_head + i) % m_qu_ring.size()];
+      if(e.IsEvent()){
+	m_qu_ev_n--;
+	m_qu_bytes -= e.bytes;
+	// connection changes ahead of it stay in place
+	e.ev.reset();
+	e.fut = std::future<EventSP>();
+	e.con.reset();
+	e.bytes = 0;
+	dropped = true;
+	break;
+      }
+    }
+    while(m_qu_slots && !m_qu_ring[m_qu_head].con){
+      m_qu_head = (m_qu_head + 1) % m_qu_ring.size();
+      m_qu_slots--;
+    }
+    return dropped;
+  }
+
+  bool DataReceiver::ClearQueue(){
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    bool had_entries = m_qu_slots;
+    for(auto &e: m_qu_ring){
+      e.ev.reset();
+      e.fut = std::future<EventSP>();
+      e.con.reset();
+    }
+    m_qu_head = 0;
+    m_qu_slots = 0;
+    m_qu_ev_n = 0;
+    m_qu_bytes = 0;
+    m_cv_not_full.notify_all();
+    return had_entries;
+  }
+
+  void DataReceiver::PushConnection(ConnectionSPC con){
+    QueueEntry entry;
+    entry.con = con;
+    entry.bytes = 0;
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    PushEntry(std::move(entry));
+  }
+
+  void DataReceiver::PushEvent(ConnectionSPC con, std::string &&packet){
+    QueueEntry entry;
+    entry.con = con;
+    entry.bytes = packet.size();
+    size_t bytes = entry.bytes;
+    DecodeJob job;
+    bool decode_later = !m_decoders.empty();
+    if(decode_later){
+      job.packet = std::move(packet);
+      entry.fut = job.result.get_future();
+    }
+    else{
+      try{
+	entry.ev = decode_packet(std::move(packet));
+      }
+      catch(const std::exception &e){
+	EUDAQ_ERROR("DataReceiver: Unable to decode Event from " + con->GetName()
+		    + ": " + e.what());
+	return;
+      }
+    }
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    if(IsQueueFull(bytes)){
+      if(m_qu_policy == QueuePolicy::BLOCK){
+	m_qu_blocked_n++;
+	auto tp_block = std::chrono::steady_clock::now();
+	// keep waking up, so that a stopped receiver does not hang here
+	while(IsQueueFull(bytes) && m_is_listening && m_qu_policy == QueuePolicy::BLOCK)
+	  m_cv_not_full.wait_for(lk, std::chrono::milliseconds(100));
+	m_qu_blocked_us += std::chrono::duration_cast<std::chrono::microseconds>
+	  (std::chrono::steady_clock::now() - tp_block).count();
+      }
+      if(m_qu_policy == QueuePolicy::DROP_OLDEST){
+	uint64_t n = 0;
+	// the Events being forwarded cannot be dropped any more
+	while(IsQueueFull(bytes) && DropOldest())
+	  n = ++m_qu_dropped_n;
+	if(n){
+	  lk.unlock();
+	  warn_dropped(n);
+	  lk.lock();
+	}
+      }
+      if(IsQueueFull(bytes)){
+	uint64_t n = ++m_qu_dropped_n;
+	lk.unlock();
+	warn_dropped(n);
+	return;
+      }
+    }
+    PushEntry(std::move(entry));
+    lk.unlock();
+    if(decode_later){
+      std::unique_lock<std::mutex> lk_decode(m_mx_decode);
+      m_decode_jobs.push_back(std::move(job));
+      m_cv_decode.notify_one();
+    }
+  }
   
   void DataReceiver::DataHandler(TransportEvent &ev) {
     auto con = ev.id;
@@ -42,9 +312,7 @@ namespace eudaq {
       for (size_t i = 0; i < m_vt_con.size(); ++i){
 	if (m_vt_con[i] == con){
 	  m_vt_con.erase(m_vt_con.begin() + i);
-	  std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	  m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
-	  m_cv_not_empty.notify_all();
+	  PushConnection(con);
 	  has_con_for_discon = true;
 	}
       }
@@ -87,23 +355,10 @@ namespace eudaq {
         con->SetState(1); // successfully identified
 	EUDAQ_INFO("DataReceiver: Connection from " + to_string(*con));
 	m_vt_con.push_back(con);
-	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
-	m_cv_not_empty.notify_all();
+	PushConnection(con);
       }
       else{ //identified connection  
-	BufferSerializer ser(ev.packet.begin(), ev.packet.end());
-	uint32_t id;
-	ser.PreRead(id);
-	auto ev_con = std::make_pair<EventSP, ConnectionSPC>
-	  (Factory<Event>::MakeUnique<Deserializer&>(id, ser), con);
-	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(ev_con);
-	if(m_qu_ev.size() > 50000){
-	  m_qu_ev.pop();
-	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full.");
-	}
-	m_cv_not_empty.notify_all();
+	PushEvent(con, std::move(ev.packet));
       }
       break;
     default:
@@ -121,34 +376,56 @@ namespace eudaq {
   }
 
   bool DataReceiver::AsyncForwarding(){
-    while(!m_is_async_rcv_return){
+    // entries taken out of the ring still count as queued until they are
+    // handed off, so the limits hold for the forwarded batch as well
+    const size_t max_batch = 64;
+    std::vector<QueueEntry> batch;
+    for(;;){
       std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-      while(m_qu_ev.empty()){
-	while(m_cv_not_empty.wait_for(lk, std::chrono::seconds(1))
-	      ==std::cv_status::timeout){
-	  if(m_is_async_rcv_return){
-	    for(auto &con: m_vt_con){
-	      OnDisconnect(con);
+      while(!m_qu_slots && !m_is_async_rcv_return)
+	m_cv_not_empty.wait_for(lk, std::chrono::milliseconds(100));
+      if(!m_qu_slots)
+	break;
+      size_t n = std::min(m_qu_slots, max_batch);
+      for(size_t i = 0; i < n; ++i)
+	batch.push_back(std::move(m_qu_ring[(m_qu_head + i) % m_qu_ring.size()]));
+      m_qu_head = (m_qu_head + n) % m_qu_ring.size();
+      m_qu_slots -= n;
+      lk.unlock();
+      for(auto &e: batch){
+	if(!e.con)
+	  continue;
+	if(e.IsEvent()){
+	  EventSP ev = e.ev;
+	  bool decoded = true;
+	  if(!ev){
+	    try{
+	      ev = e.fut.get();
+	    }
+	    catch(const std::exception &ex){
+	      EUDAQ_ERROR("DataReceiver: Unable to decode Event from " + e.con->GetName()
+			  + ": " + ex.what());
+	      decoded = false;
 	    }
-	    m_vt_con.clear();
-	    return 0;
 	  }
+	  e.ev.reset();
+	  lk.lock();
+	  m_qu_ev_n--;
+	  m_qu_bytes -= e.bytes;
+	  lk.unlock();
+	  m_cv_not_full.notify_all();
+	  if(decoded)
+	    OnReceive(e.con, ev);
 	}
-      }
-      auto ev = m_qu_ev.front().first;
-      auto con = m_qu_ev.front().second;
-      m_qu_ev.pop();
-      lk.unlock();
-      if(ev){
-	OnReceive(con, ev);
-      }
-      else{
-	if(con->GetState())
-	  OnConnect(con);
 	else{
-	  OnDisconnect(con);
+	  if(e.con->GetState())
+	    OnConnect(e.con);
+	  else{
+	    OnDisconnect(e.con);
+	  }
 	}
       }
+      batch.clear();
     }
     //clear remaining connections
     for(auto &con: m_vt_con){
@@ -177,6 +454,11 @@ namespace eudaq {
     
     m_last_addr = dataserver->ConnectionString();
     m_dataserver.reset(dataserver);
+    StartDecoders();
+    m_qu_high_water = 0;
+    m_qu_dropped_n = 0;
+    m_qu_blocked_n = 0;
+    m_qu_blocked_us = 0;
     m_is_listening = true;
     m_is_async_rcv_return = false;
     m_fut_async_rcv = std::async(std::launch::async, &DataReceiver::AsyncReceiving, this); 
@@ -223,9 +505,8 @@ namespace eudaq {
 	  if(m_fut_async_fwd.valid()){
 	    m_fut_async_fwd.get();
 	  }
-	  if(!m_qu_ev.empty()){
+	  if(ClearQueue()){
 	    EUDAQ_WARN("DataReceiver: Data buffer is not empty during the stopping");
-	    m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
 	  }
 	  if(m_dataserver)
 	    m_dataserver.reset();
@@ -233,6 +514,7 @@ namespace eudaq {
 	catch(...){
 	  EUDAQ_WARN("DataReceiver: Deamon catches an execption when closing server");
 	}
+	StopDecoders();
       }
     }    
     try{
@@ -244,9 +526,8 @@ namespace eudaq {
       if(m_fut_async_fwd.valid()){
 	m_fut_async_fwd.get();
       }
-      if(!m_qu_ev.empty()){
+      if(ClearQueue()){
 	EUDAQ_WARN("DataReceiver: Data buffer is not empty during the exiting");
-	m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
       }
       if(m_dataserver)
 	m_dataserver.reset();
@@ -254,6 +535,7 @@ namespace eudaq {
     catch(...){
       EUDAQ_ERROR("DataReceiver: Execption from deamon exiting");
     }
+    StopDecoders();
   return true;    
   }
 
@@ -7,10 +7,19 @@
 
 namespace eudaq {
 
+  namespace {
+    // initial size of the reused serialization buffer, it grows to the
+    // largest event sent and stays there
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+  }
+
   DataSender::DataSender(const std::string & type, const std::string & name)
     : m_type(type),
     m_name(name),
-    m_packetCounter(0) {}
+    m_packetCounter(0),
+    m_cork(false) {
+    m_ser.reserve(DEFAULT_BUFFER_SIZE);
+  }
 
 
   DataSender::~DataSender(){
@@ -92,11 +101,40 @@ namespace eudaq {
     m_cv_not_empty.notify_all();
     */
 
-    BufferSerializer ser;
-    ev->Serialize(ser);
+    SendSerialized(ev);
+  }
+
+  void DataSender::SendSerialized(const EventSPC &ev){
+    std::unique_lock<std::mutex> lk(m_mx_send);
+    m_ser.clear();
+    ev->Serialize(m_ser);
     m_packetCounter += 1;
     //TODO: catch exception below
-    m_dataclient->SendPacket(ser);
+    m_dataclient->SendPacket(m_ser);
+    if(m_cork && ev->IsEORE())
+      m_dataclient->Flush();
+  }
+
+  void DataSender::SendBuffer(const BufferSerializer &buf){
+    if (!m_dataclient)
+      EUDAQ_THROW("DataSender:: Transport not connected error");
+    std::unique_lock<std::mutex> lk(m_mx_send);
+    m_packetCounter += 1;
+    m_dataclient->SendPacket(buf);
+  }
+
+  void DataSender::SetNoDelay(bool enable){
+    if (!m_dataclient)
+      EUDAQ_THROW("DataSender:: Transport not connected error");
+    m_dataclient->SetNoDelay(enable);
+  }
+
+  void DataSender::SetCork(bool enable){
+    if (!m_dataclient)
+      EUDAQ_THROW("DataSender:: Transport not connected error");
+    std::unique_lock<std::mutex> lk(m_mx_send);
+    m_dataclient->SetCork(enable);
+    m_cork = enable;
   }
 
   bool DataSender::AsyncSending(){
@@ -113,11 +151,7 @@ namespace eudaq {
       auto ev = m_qu_ev.front();
       m_qu_ev.pop();
       lk.unlock();
-      BufferSerializer ser;
-      ev->Serialize(ser);
-      m_packetCounter += 1;
-      //TODO: catch exception below
-      m_dataclient->SendPacket(ser);
+      SendSerialized(ev);
     }
 
     return true;
@@ -30,4 +30,16 @@ namespace eudaq{
     PreDeserialize(dst, size);
   }
 
+  std::shared_ptr<const void> Deserializer::GetBacking() const{
+    return nullptr;
+  }
+
+  const uint8_t *Deserializer::Borrow(size_t size){
+    return BorrowDeserialize(size);
+  }
+
+  const uint8_t *Deserializer::BorrowDeserialize(size_t){
+    EUDAQ_THROW("Deserializer: zero-copy access is not supported by this deserializer");
+  }
+
 }
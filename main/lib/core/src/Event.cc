@@ -1,6 +1,8 @@
 #include "eudaq/Event.hh"
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
+#include <algorithm>
+#include <atomic>
 
 namespace eudaq {
   
@@ -12,6 +14,18 @@ namespace eudaq {
   std::map<uint32_t, typename Factory<Event>::UP_BASE (*)()>&
   Factory<Event>::Instance<>();
 
+  namespace{
+    std::atomic<size_t> block_pool_size(0);
+    std::vector<std::vector<uint8_t>> &BlockPool(){
+      thread_local std::vector<std::vector<uint8_t>> pool;
+      return pool;
+    }
+  }
+
+  void Event::SetBlockPoolSize(size_t n){
+    block_pool_size = n;
+  }
+
   EventUP Event::MakeUnique(const std::string& dspt){
     EventUP ev = Factory<Event>::MakeUnique<>(cstr2hash("RawEvent"));
     ev->SetType(cstr2hash("RawEvent"));
@@ -39,10 +53,11 @@ namespace eudaq {
   }
   
   Event::Event()
-    :m_type(0), m_version(2), m_flags(0), m_stm_n(0), m_run_n(0), m_ev_n(0), m_tg_n(0), m_extend(0), m_ts_begin(0), m_ts_end(0){
+    :m_type(0), m_version(2), m_flags(0), m_stm_n(0), m_run_n(0), m_ev_n(0), m_tg_n(0), m_extend(0), m_ts_begin(0), m_ts_end(0), m_block_dead(0){
   }  
   
-  Event::Event(Deserializer & ds) {
+  Event::Event(Deserializer & ds)
+    :m_block_dead(0){
     ds.read(m_type);
     ds.read(m_version);
     ds.read(m_flags);
@@ -55,7 +70,28 @@ namespace eudaq {
     ds.read(m_ts_end);
     ds.read(m_dspt);
     ds.read(m_tags);
-    ds.read(m_blocks);
+    bool borrow = bool(ds.GetBacking());
+    uint32_t n_block;
+    for(ds.read(n_block); n_block>0; n_block--){
+      uint32_t id;
+      uint32_t len;
+      ds.read(id);
+      ds.read(len);
+      if(borrow){
+	auto &e = InsertBlock(id);
+	e.ext = ds.Borrow(len);
+	e.size = len;
+	// Borrow() may have remapped the file, the block lives in the new mapping
+	auto backing = ds.GetBacking();
+	if(m_block_backing.empty() || m_block_backing.back() != backing)
+	  m_block_backing.push_back(std::move(backing));
+      }
+      else{
+	uint8_t *dst = NewBlock(id, len);
+	if(len)
+	  ds.read(dst, len);
+      }
+    }
     uint32_t n_subev;
     for(ds.read(n_subev); n_subev>0; n_subev--){
       uint32_t evid;
@@ -66,16 +102,32 @@ namespace eudaq {
   }
 
 
+  Event::~Event(){
+    size_t n = block_pool_size;
+    if(n && m_block_data.capacity()){
+      auto &pool = BlockPool();
+      if(pool.size() < n){
+	m_block_data.clear();
+	pool.push_back(std::move(m_block_data));
+      }
+    }
+  }
+
   void Event::AddSubEvent(EventSPC ev){
     bool exist = false;
     for(auto &e : m_sub_events){
       if(ev == e){
 	exist = true;
+	break;
       }
     }
     if(!exist && ev)
-      m_sub_events.push_back(ev);
+      m_sub_events.push_back(std::move(ev));
     }
+
+  void Event::ReserveSubEvents(uint32_t n){
+    m_sub_events.reserve(n);
+  }
   
   void Event::SetTimestamp(uint64_t tb, uint64_t te, bool flag){
     m_ts_begin = tb;
@@ -97,7 +149,13 @@ namespace eudaq {
     ser.write(m_ts_end);
     ser.write(m_dspt);
     ser.write(m_tags);
-    ser.write(m_blocks);
+    ser.write((uint32_t)m_block_table.size());
+    for(auto &e: m_block_table){
+      ser.write(e.id);
+      ser.write((uint32_t)e.size);
+      if(e.size)
+	ser.append(e.ext ? e.ext : &m_block_data[e.offset], e.size);
+    }
     ser.write((uint32_t)m_sub_events.size());
     for(auto &ev: m_sub_events){
       ser.write(*ev);
@@ -105,20 +163,118 @@ namespace eudaq {
   }
 
   std::vector<uint8_t> Event::GetBlock(uint32_t i) const{
-    auto it = m_blocks.find(i);
-    if(it == m_blocks.end()){
+    auto v = GetBlockView(i);
+    return std::vector<uint8_t>(v.begin(), v.end());
+  }
+
+  BlockView Event::GetBlockView(uint32_t i) const{
+    auto e = FindBlock(i);
+    if(!e){
       EUDAQ_WARN(std::string("RAWDATAEVENT:: no bolck with ID ") + std::to_string(i) + " exists");
+      return BlockView();
     }
-    return it->second;
+    return BlockView(e->ext ? e->ext : m_block_data.data() + e->offset, e->size);
   }
 
   std::vector<uint32_t> Event::GetBlockNumList() const {
     std::vector<uint32_t> vnum;
-    for(auto &e : m_blocks){
-      vnum.push_back(e.first);
+    for(auto &e : m_block_table){
+      vnum.push_back(e.id);
     }
     return vnum;
   }
+
+  void Event::AddBlockRef(uint32_t id, const BlockView &data, std::shared_ptr<const void> backing){
+    auto &e = InsertBlock(id);
+    e.ext = data.data();
+    e.size = data.size();
+    if(m_block_backing.empty() || m_block_backing.back() != backing)
+      m_block_backing.push_back(std::move(backing));
+  }
+
+  const Event::BlockEntry *Event::FindBlock(uint32_t id) const{
+    auto it = std::lower_bound(m_block_table.begin(), m_block_table.end(), id,
+			       [](const BlockEntry &e, uint32_t id){return e.id < id;});
+    if(it == m_block_table.end() || it->id != id)
+      return nullptr;
+    return &*it;
+  }
+
+  // Returns the (empty) entry of block id, a previous block id is dropped.
+  Event::BlockEntry &Event::InsertBlock(uint32_t id){
+    auto it = std::lower_bound(m_block_table.begin(), m_block_table.end(), id,
+			       [](const BlockEntry &e, uint32_t id){return e.id < id;});
+    if(it == m_block_table.end() || it->id != id)
+      it = m_block_table.insert(it, BlockEntry());
+    else
+      ReleaseBlockData(*it);
+    *it = {id, 0, 0, nullptr};
+    return *it;
+  }
+
+  uint8_t *Event::NewBlock(uint32_t id, size_t bytes){
+    auto &e = InsertBlock(id);
+    e.offset = AllocBlockData(bytes);
+    e.size = bytes;
+    return m_block_data.data() + e.offset;
+  }
+
+  // Extends block id by bytes and returns the location of the new bytes.
+  uint8_t *Event::GrowBlock(uint32_t id, size_t bytes){
+    auto it = std::lower_bound(m_block_table.begin(), m_block_table.end(), id,
+			       [](const BlockEntry &e, uint32_t id){return e.id < id;});
+    if(it == m_block_table.end() || it->id != id)
+      return NewBlock(id, bytes);
+    if(!it->ext && it->offset + it->size == m_block_data.size()){
+      m_block_data.resize(m_block_data.size() + bytes);
+      it->size += bytes;
+      return m_block_data.data() + it->offset + it->size - bytes;
+    }
+    // not the last block in m_block_data, move it to the end
+    size_t i = it - m_block_table.begin();
+    size_t offset = AllocBlockData(it->size + bytes);
+    BlockEntry &e = m_block_table[i];
+    if(e.size)
+      std::memcpy(m_block_data.data() + offset, e.ext ? e.ext : m_block_data.data() + e.offset, e.size);
+    ReleaseBlockData(e);
+    e.offset = offset;
+    e.ext = nullptr;
+    e.size += bytes;
+    return m_block_data.data() + offset + e.size - bytes;
+  }
+
+  // Returns the offset of bytes new bytes at the end of m_block_data
+  size_t Event::AllocBlockData(size_t bytes){
+    if(m_block_data.capacity() == 0){
+      auto &pool = BlockPool();
+      if(!pool.empty()){
+	m_block_data.swap(pool.back());
+	pool.pop_back();
+      }
+    }
+    else if(m_block_dead && m_block_dead >= m_block_data.size() / 2){
+      // compact the payload of the blocks still in use
+      std::vector<uint8_t> data;
+      data.reserve(m_block_data.size() - m_block_dead + bytes);
+      for(auto &e: m_block_table){
+	if(e.ext || !e.size)
+	  continue;
+	size_t offset = data.size();
+	data.insert(data.end(), m_block_data.begin() + e.offset, m_block_data.begin() + e.offset + e.size);
+	e.offset = offset;
+      }
+      m_block_data.swap(data);
+      m_block_dead = 0;
+    }
+    size_t offset = m_block_data.size();
+    m_block_data.resize(offset + bytes);
+    return offset;
+  }
+
+  void Event::ReleaseBlockData(const BlockEntry &e){
+    if(!e.ext)
+      m_block_dead += e.size;
+  }
   
   void Event::Print(std::ostream & os, size_t offset) const{
     os << std::string(offset, ' ') << "<Event>\n";
@@ -141,7 +297,7 @@ namespace eudaq {
       }
       os << std::string(offset + 2, ' ') << "</Tags>\n";
     }
-    os << std::string(offset + 2, ' ')<<"<Block_Size>"<<m_blocks.size()<<"</Block_Size>\n";
+    os << std::string(offset + 2, ' ')<<"<Block_Size>"<<GetNumBlock()<<"</Block_Size>\n";
 
     if(!m_sub_events.empty()){
       os << std::string(offset + 2, ' ') << "<SubEvents>\n";
@@ -175,6 +331,7 @@ namespace eudaq {
   void Event::SetFlagPacket(){SetFlagBit(FLAG_PACK);}
   void Event::SetFlagTimestamp(){SetFlagBit(FLAG_TIME);}
   void Event::SetFlagTrigger(){SetFlagBit(FLAG_TRIG);}
+  void Event::SetFlagBatch(){SetFlagBit(FLAG_BATCH);}
     
   bool Event::IsBORE() const { return IsFlagBit(FLAG_BORE);}
   bool Event::IsEORE() const { return IsFlagBit(FLAG_EORE);}
@@ -182,6 +339,7 @@ namespace eudaq {
   bool Event::IsFlagPacket() const {return IsFlagBit(FLAG_PACK);}
   bool Event::IsFlagTimestamp() const {return IsFlagBit(FLAG_TIME);}
   bool Event::IsFlagTrigger() const {return IsFlagBit(FLAG_TRIG);}    
+  bool Event::IsFlagBatch() const {return IsFlagBit(FLAG_BATCH);}
     
   uint32_t Event::GetNumSubEvent() const {return m_sub_events.size();}
   EventSPC Event::GetSubEvent(uint32_t i) const {return m_sub_events.at(i);}
@@ -216,8 +374,8 @@ namespace eudaq {
   uint32_t Event::GetEventNumber()const {return m_ev_n;}
   uint32_t Event::GetRunNumber()const {return m_run_n;}
 
-  size_t Event::GetNumBlock() const { return m_blocks.size(); }
-  size_t Event::NumBlocks() const { return m_blocks.size(); }
+  size_t Event::GetNumBlock() const { return m_block_table.size(); }
+  size_t Event::NumBlocks() const { return GetNumBlock(); }
 
   std::string Event::GetTag(const std::string &name, const char *def) const{
     return GetTag(name, std::string(def));
@@ -0,0 +1,121 @@
+#include "eudaq/EventBatch.hh"
+#include "eudaq/Exception.hh"
+
+namespace eudaq {
+
+  const char EventBatch::m_tag_payload[] = "EUDAQ_BATCH_PAYLOAD";
+
+  namespace{
+    template <typename T> T decode(const uint8_t *p){
+      T t = 0;
+      for (size_t i = 0; i < sizeof t; ++i) {
+	t <<= 8;
+	t += p[sizeof t - 1 - i];
+      }
+      return t;
+    }
+
+    template <typename T> void encode(uint8_t *p, T t){
+      for (size_t i = 0; i < sizeof t; ++i) {
+	p[i] = uint8_t(t);
+	t >>= 8;
+      }
+    }
+  }
+
+  EventBatch::EventBatch(EventSPC ev)
+    :m_ev(std::move(ev)), m_record_size(0), m_n(0){
+    if(!m_ev->IsFlagBatch())
+      EUDAQ_THROW("EventBatch: "+m_ev->GetDescription()+" is not a batch of triggers");
+    m_record_size = m_header_size + m_ev->GetTag(m_tag_payload, size_t(0));
+    m_data = m_ev->GetBlockView(0);
+    if(m_data.size() % m_record_size)
+      EUDAQ_THROW("EventBatch: block of "+std::to_string(m_data.size())+
+		  " bytes is no multiple of the record size "+std::to_string(m_record_size));
+    m_n = m_data.size() / m_record_size;
+  }
+
+  const uint8_t *EventBatch::Record(size_t i) const{
+    if(i >= m_n)
+      EUDAQ_THROW("EventBatch: no record "+std::to_string(i));
+    return m_data.data() + i * m_record_size;
+  }
+
+  uint32_t EventBatch::GetTriggerN(size_t i) const{
+    return decode<uint32_t>(Record(i));
+  }
+
+  uint64_t EventBatch::GetTimestampBegin(size_t i) const{
+    return decode<uint64_t>(Record(i) + 4);
+  }
+
+  uint64_t EventBatch::GetTimestampEnd(size_t i) const{
+    return decode<uint64_t>(Record(i) + 12);
+  }
+
+  BlockView EventBatch::GetPayload(size_t i) const{
+    return BlockView(Record(i) + m_header_size, m_record_size - m_header_size);
+  }
+
+  EventUP EventBatch::Unpack(size_t i) const{
+    const uint8_t *rec = Record(i);
+    uint32_t type = m_ev->GetType();
+    EventUP ev = Factory<Event>::MakeUnique<>(type);
+    if(!ev)
+      EUDAQ_THROW("EventBatch: unknown event type of "+m_ev->GetDescription());
+    ev->SetType(type);
+    ev->SetVersion(m_ev->GetVersion());
+    ev->SetExtendWord(m_ev->GetExtendWord());
+    ev->SetDescription(m_ev->GetDescription());
+    uint32_t flag = m_ev->GetFlag() & ~(Event::FLAG_BATCH | Event::FLAG_BORE | Event::FLAG_EORE);
+    if(i == 0)
+      flag |= m_ev->GetFlag() & Event::FLAG_BORE;
+    if(i + 1 == m_n)
+      flag |= m_ev->GetFlag() & Event::FLAG_EORE;
+    ev->SetFlag(flag);
+    ev->SetRunN(m_ev->GetRunN());
+    ev->SetEventN(m_ev->GetEventN() + i);
+    ev->SetDeviceN(m_ev->GetDeviceN());
+    ev->SetStreamN(m_ev->GetStreamN());
+    // the trigger and timestamp flags are those of the batch
+    ev->SetTriggerN(decode<uint32_t>(rec), false);
+    ev->SetTimestamp(decode<uint64_t>(rec + 4), decode<uint64_t>(rec + 12), false);
+    if(i == 0){
+      for(auto &tag: m_ev->GetTags())
+	if(tag.first != m_tag_payload)
+	  ev->SetTag(tag.first, tag.second);
+    }
+    ev->AddBlockRef(0, GetPayload(i), m_ev);
+    return ev;
+  }
+
+  EventBatchWriter::EventBatchWriter(size_t payload_size)
+    :m_payload_size(payload_size), m_n(0), m_tg_first(0), m_ts_first(0), m_ts_last(0){
+  }
+
+  uint8_t *EventBatchWriter::Add(uint32_t tg, uint64_t ts_begin, uint64_t ts_end){
+    if(!m_n){
+      m_tg_first = tg;
+      m_ts_first = ts_begin;
+    }
+    m_ts_last = ts_end;
+    m_n++;
+    size_t offset = m_data.size();
+    m_data.resize(offset + EventBatch::m_header_size + m_payload_size);
+    uint8_t *rec = &m_data[offset];
+    encode(rec, tg);
+    encode(rec + 4, ts_begin);
+    encode(rec + 12, ts_end);
+    return rec + EventBatch::m_header_size;
+  }
+
+  void EventBatchWriter::Fill(Event &ev){
+    ev.AddBlock(0, m_data);
+    ev.SetTag(EventBatch::m_tag_payload, m_payload_size);
+    ev.SetTriggerN(m_tg_first);
+    ev.SetTimestamp(m_ts_first, m_ts_last);
+    ev.SetFlagBatch();
+    m_data.clear();
+    m_n = 0;
+  }
+}
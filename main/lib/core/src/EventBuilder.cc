@@ -0,0 +1,523 @@
+#include "eudaq/EventBuilder.hh"
+#include "eudaq/EventBatch.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+
+namespace eudaq {
+
+  namespace{
+    void warn_count(uint64_t n, const std::string &what){
+      // every power of two, a lagging stream would flood the log otherwise
+      if(n && !(n & (n - 1)))
+	EUDAQ_WARN("EventBuilder: " + std::to_string(n) + " " + what + " so far");
+    }
+  }
+
+  EventBuilder::EventBuilder(uint32_t key, const std::string &dspt, Output out)
+    :m_key(key), m_dspt(dspt), m_out(out), m_timeout(0),
+     m_trigger_mask(0xffffffff), m_ts_tol(0), m_max_keys(0), m_max_pending(100000),
+     m_marks(&Stream::mark, &Stream::pos_mark), m_st_last(nullptr),
+     m_n_live(0), m_n_idle(0), m_frag_n(0), m_pend_beg(0), m_pend_n(0), m_key_last(0), m_key_max(0),
+     m_key_any(false), m_heads_beg(&Stream::head_beg, &Stream::pos_beg),
+     m_heads_end(&Stream::head_end, &Stream::pos_end), m_ts_last(0), m_built_n(0), m_partial_n(0), m_late_n(0), m_orphan_n(0){
+    if(!m_key || (m_key & ~(TRIGGER | EVENT | TIMESTAMP)))
+      EUDAQ_THROW("EventBuilder: unknown matching key " + std::to_string(m_key));
+    if((m_key & TIMESTAMP) && m_key != TIMESTAMP)
+      EUDAQ_THROW("EventBuilder: timestamp windows can not be combined with other keys");
+    if(!m_out)
+      EUDAQ_THROW("EventBuilder: no output for the built events");
+  }
+
+  void EventBuilder::Configure(const Configuration &conf){
+    SetTimeout(conf.Get("EUDAQ_EVB_TIMEOUT_MS", 0));
+    SetTriggerBits(conf.Get("EUDAQ_EVB_TRIGGER_BITS", 32));
+    SetTimestampTolerance(conf.Get("EUDAQ_EVB_TIMESTAMP_TOLERANCE", uint64_t(0)));
+    SetMaxTriggers(conf.Get("EUDAQ_EVB_MAX_TRIGGERS", uint64_t(0)));
+    SetMaxPending(conf.Get("EUDAQ_EVB_MAX_PENDING", uint64_t(100000)));
+  }
+
+  void EventBuilder::SetTriggerBits(uint32_t bits){
+    if(bits == 0 || bits > 32)
+      EUDAQ_THROW("EventBuilder: trigger counter width has to be 1 to 32 bits, not "
+		  + std::to_string(bits));
+    m_trigger_mask = (uint64_t(1) << bits) - 1;
+  }
+
+  EventBuilder::Stream &EventBuilder::GetStream(uint32_t id){
+    // fragments mostly come in bursts from one stream
+    if(m_st_last && m_st_last->id == id && m_st_last->live)
+      return *m_st_last;
+    auto it = m_streams.find(id);
+    if(it == m_streams.end()){
+      it = m_streams.emplace(id, Stream()).first;
+      it->second.id = id;
+      it->second.live = false;
+    }
+    auto &st = it->second;
+    if(!st.live){
+      st.live = true;
+      st.started = false;
+      st.tg = TriggerCounter();
+      st.mark = 0;
+      m_n_live ++;
+      m_n_idle ++;
+    }
+    m_st_last = &st;
+    return st;
+  }
+
+  bool EventBuilder::HasStream(uint32_t id) const{
+    auto it = m_streams.find(id);
+    return it != m_streams.end() && it->second.live;
+  }
+
+  void EventBuilder::AddStream(uint32_t id){
+    GetStream(id);
+  }
+
+  void EventBuilder::RemoveStream(uint32_t id){
+    auto it = m_streams.find(id);
+    if(it == m_streams.end())
+      return;
+    EndStream(it->second);
+    Build(false);
+  }
+
+  void EventBuilder::EndStream(Stream &st){
+    if(!st.live)
+      return;
+    st.live = false;
+    m_n_live --;
+    if(st.started)
+      m_marks.Erase(&st);
+    else
+      m_n_idle --;
+    EraseStreamIfDone(st);
+  }
+
+  void EventBuilder::EraseStreamIfDone(Stream &st){
+    if(!st.live && st.frags.empty()){
+      if(m_st_last == &st)
+	m_st_last = nullptr;
+      m_streams.erase(st.id);
+    }
+  }
+
+  void EventBuilder::SetMark(Stream &st, uint64_t mark){
+    st.mark = mark;
+    if(st.started)
+      m_marks.Raise(&st);
+    else{
+      st.started = true;
+      m_n_idle --;
+      m_marks.Push(&st);
+    }
+  }
+
+  uint64_t EventBuilder::TriggerCounter::Extend(uint64_t r, uint64_t mask, TriggerCounter &epoch){
+    // relative to the highest trigger seen so far
+    r &= mask;
+    if(!any && epoch.any)
+      *this = epoch;
+    uint64_t e = r;
+    if(any){
+      uint64_t delta = (r - raw) & mask;
+      if(delta <= mask / 2)
+	e = ext + delta;
+      else{
+	uint64_t back = mask + 1 - delta;
+	e = ext > back ? ext - back : 0;
+      }
+    }
+    if(!any || e > ext){
+      any = true;
+      raw = r;
+      ext = e;
+    }
+    if(!epoch.any || ext > epoch.ext)
+      epoch = *this;
+    return e;
+  }
+
+  uint64_t EventBuilder::MakeKey(uint32_t key, uint64_t mask, TriggerCounter &tg,
+				 TriggerCounter &epoch, const Event &ev){
+    uint64_t k = 0;
+    if(key & TRIGGER){
+      if(!(ev.GetFlag() & Event::FLAG_TRIG))
+	EUDAQ_THROW("EventBuilder: event without trigger number ("+ev.GetDescription()+")");
+      k = tg.Extend(ev.GetTriggerN(), mask, epoch);
+    }
+    if(key & EVENT)
+      k = (k << 32) | ev.GetEventN();
+    return k;
+  }
+
+  bool EventBuilder::IsEndMarker(uint32_t key, const Event &ev){
+    uint32_t flag = ev.GetFlag();
+    return (flag & Event::FLAG_EORE) &&
+      (((key & TRIGGER) && !(flag & Event::FLAG_TRIG)) ||
+       ((key & TIMESTAMP) && !(flag & Event::FLAG_TIME)));
+  }
+
+  uint64_t EventBuilder::Floor() const{
+    // lowest key which may still be emitted
+    uint64_t floor = m_key_any ? m_key_last + 1 : 0;
+    if(m_n_idle)
+      return floor;
+    uint64_t low = m_marks.Empty() ? uint64_t(-1) : m_marks.Top()->mark + 1;
+    if(m_pend_n)
+      low = std::min(low, m_pending[m_pend_beg].key);
+    return std::max(floor, low);
+  }
+
+  void EventBuilder::IndexHead(Stream &st){
+    st.head_beg = st.frags.front().beg;
+    st.head_end = st.frags.front().end;
+    m_heads_beg.Push(&st);
+    m_heads_end.Push(&st);
+  }
+
+  void EventBuilder::UnindexHead(Stream &st){
+    m_heads_beg.Erase(&st);
+    m_heads_end.Erase(&st);
+  }
+
+  void EventBuilder::Push(uint32_t id, EventSPC ev){
+    if(ev->GetFlag() & Event::FLAG_BATCH){
+      // one trigger after the other, each sharing the memory of the batch
+      EventBatch batch(std::move(ev));
+      for(size_t i = 0; i < batch.Size(); i++)
+	Push(id, batch.Unpack(i));
+      return;
+    }
+    if(IsEndMarker(m_key, *ev)){
+      RemoveStream(id);
+      return;
+    }
+    auto &st = GetStream(id);
+    if(!(m_key & TIMESTAMP)){
+      uint64_t key = MakeKey(m_key, m_trigger_mask, st.tg, m_tg_epoch, *ev);
+      PushKey(st, std::move(ev), key);
+      return;
+    }
+    // the clock is only needed to expire fragments
+    auto now = m_timeout.count() ? Clock::now() : Clock::time_point();
+    bool eore = ev->IsEORE();
+    if(!ev->IsFlagTimestamp())
+      EUDAQ_THROW("EventBuilder: event without timestamp ("+ev->GetDescription()+")");
+    uint64_t beg = ev->GetTimestampBegin();
+    uint64_t end = std::max(ev->GetTimestampEnd(), beg + 1);
+    if(end <= m_ts_last)
+      warn_count(++m_late_n, "late fragments dropped");
+    else{
+      st.frags.push_back(Fragment{std::move(ev), beg, end, now});
+      m_frag_n ++;
+      if(st.frags.size() == 1)
+	IndexHead(st);
+      if(!st.started || end > st.mark)
+	SetMark(st, end);
+    }
+    if(eore)
+      EndStream(st);
+    Build(false);
+  }
+
+  void EventBuilder::Push(uint32_t id, EventSPC ev, uint64_t key){
+    if(m_key & TIMESTAMP)
+      EUDAQ_THROW("EventBuilder: timestamp windows are not matched by key");
+    PushKey(GetStream(id), std::move(ev), key);
+  }
+
+  void EventBuilder::PushKey(Stream &st, EventSPC ev, uint64_t key){
+    uint32_t id = st.id;
+    auto now = m_timeout.count() ? Clock::now() : Clock::time_point();
+    bool eore = ev->GetFlag() & Event::FLAG_EORE;
+    if(m_key_any && key <= m_key_last)
+      warn_count(++m_late_n, "late fragments dropped");
+    else{
+      auto &p = GetPending(key, now);
+      p.evs.push_back(std::move(ev));
+      // streams are ordered, so only a repeated key can be a second fragment
+      bool seen = st.started && key <= st.mark &&
+	(key == st.mark || std::find(p.ids.begin(), p.ids.end(), id) != p.ids.end());
+      if(!seen)
+	p.ids.push_back(id);
+      m_frag_n ++;
+      m_key_max = std::max(m_key_max, key);
+    }
+    if(!st.started || key > st.mark)
+      SetMark(st, key);
+    if(eore)
+      EndStream(st);
+    Build(false);
+  }
+
+  EventBuilder::Pending &EventBuilder::GetPending(uint64_t key, Clock::time_point now){
+    // a new key is mostly above all pending ones, and consecutive triggers
+    // leave no gaps, so the distance to the first one is tried before a search
+    size_t i = m_pend_n;
+    if(m_pend_n && PendingAt(m_pend_n - 1).key >= key){
+      uint64_t d = key - std::min(key, PendingAt(0).key);
+      if(d < m_pend_n && PendingAt(d).key == key)
+	return PendingAt(d);
+      size_t lo = 0;
+      while(lo < i){
+	size_t mid = (lo + i) / 2;
+	if(PendingAt(mid).key < key)
+	  lo = mid + 1;
+	else
+	  i = mid;
+      }
+      if(i < m_pend_n && PendingAt(i).key == key)
+	return PendingAt(i);
+    }
+    if(m_pend_n == m_pending.size()){
+      std::vector<Pending> v(std::max<size_t>(16, 2 * m_pending.size()));
+      for(size_t j = 0; j < m_pend_n; j++)
+	v[j] = std::move(PendingAt(j));
+      m_pending.swap(v);
+      m_pend_beg = 0;
+    }
+    // the free slot behind the last key moves down to its place
+    for(size_t j = m_pend_n; j > i; j--)
+      std::swap(PendingAt(j), PendingAt(j - 1));
+    m_pend_n ++;
+    auto &p = PendingAt(i);
+    p.key = key;
+    p.arrival = now;
+    p.evs.reserve(m_n_live);
+    p.ids.reserve(m_n_live);
+    return p;
+  }
+
+  void EventBuilder::PopPending(){
+    auto &p = PendingAt(0);
+    p.evs.clear();
+    p.ids.clear();
+    m_pend_beg = (m_pend_beg + 1) & (m_pending.size() - 1);
+    m_pend_n --;
+  }
+
+  void EventBuilder::Poll(){
+    Build(false);
+  }
+
+  void EventBuilder::Flush(){
+    Build(true);
+  }
+
+  void EventBuilder::Reset(){
+    m_pending.clear();
+    m_pend_beg = 0;
+    m_pend_n = 0;
+    m_st_last = nullptr;
+    m_tg_epoch = TriggerCounter();
+    m_heads_beg.Clear();
+    m_heads_end.Clear();
+    m_marks.Clear();
+    for(auto it = m_streams.begin(); it != m_streams.end();){
+      if(!it->second.live){
+	it = m_streams.erase(it);
+	continue;
+      }
+      it->second.frags.clear();
+      it->second.started = false;
+      it->second.tg = TriggerCounter();
+      it->second.mark = 0;
+      ++it;
+    }
+    m_n_idle = m_n_live;
+    m_frag_n = 0;
+    m_key_last = 0;
+    m_key_max = 0;
+    m_key_any = false;
+    m_ts_last = 0;
+    m_built_n = 0;
+    m_partial_n = 0;
+    m_late_n = 0;
+    m_orphan_n = 0;
+    m_missing.clear();
+  }
+
+  void EventBuilder::Build(bool flush){
+    auto now = m_timeout.count() ? Clock::now() : Clock::time_point();
+    if(m_key & TIMESTAMP)
+      while(BuildWindow(flush, now));
+    else
+      while(BuildKey(flush, now));
+  }
+
+  bool EventBuilder::BuildKey(bool flush, Clock::time_point now){
+    if(!m_pend_n)
+      return false;
+    auto &p = PendingAt(0);
+    bool ready = !m_n_idle && (m_marks.Empty() || p.key <= m_marks.Top()->mark);
+    if(!ready && !flush &&
+       !(m_timeout.count() && now - p.arrival >= m_timeout) &&
+       !(m_max_keys && m_key_max - p.key > m_max_keys) &&
+       !(m_max_pending && m_frag_n > m_max_pending))
+      return false;
+    auto ev = Event::MakeUnique(m_dspt);
+    ev->SetFlagPacket();
+    if(m_key & TRIGGER)
+      ev->SetTriggerN(uint32_t((m_key & EVENT) ? p.key >> 32 : p.key));
+    ev->ReserveSubEvents(p.evs.size());
+    bool ts = false;
+    for(auto &sub: p.evs){
+      if(!ts && sub->IsFlagTimestamp()){
+	ev->SetTimestamp(sub->GetTimestampBegin(), sub->GetTimestampEnd());
+	ts = true;
+      }
+      ev->AddSubEvent(std::move(sub));
+    }
+    size_t n_ids = p.ids.size();
+    size_t n_frag = p.evs.size();
+    size_t n_missing = 0;
+    if(n_ids < m_n_live)
+      for(auto &e: m_streams)
+	if(e.second.live && std::find(p.ids.begin(), p.ids.end(), e.first) == p.ids.end()){
+	  m_missing[e.first] ++;
+	  n_missing ++;
+	}
+    m_key_last = p.key;
+    m_key_any = true;
+    m_frag_n -= n_frag;
+    PopPending();
+    Emit(std::move(ev), n_ids, n_frag, n_missing);
+    return true;
+  }
+
+  bool EventBuilder::BuildWindow(bool flush, Clock::time_point now){
+    if(m_heads_end.Empty())
+      return false;
+    auto &f = m_heads_end.Top()->frags.front();
+    uint64_t beg = f.beg;
+    uint64_t end = f.end;
+    bool ready = !m_n_idle && (m_marks.Empty() || m_marks.Top()->mark >= end + m_ts_tol);
+    if(!ready && !flush &&
+       !(m_timeout.count() && now - f.arrival >= m_timeout) &&
+       !(m_max_pending && m_frag_n > m_max_pending))
+      return false;
+    // streams which have not yet covered the window
+    size_t n_missing = 0;
+    if(!ready)
+      for(auto &e: m_streams)
+	if(e.second.live && (!e.second.started || e.second.mark < end + m_ts_tol)){
+	  m_missing[e.first] ++;
+	  n_missing ++;
+	}
+    auto ev = Event::MakeUnique(m_dspt);
+    ev->SetFlagPacket();
+    ev->SetTimestamp(beg, end);
+    // only streams whose head starts inside the window contribute
+    m_window.clear();
+    m_heads_beg.Below(end + m_ts_tol, m_window);
+    size_t n_ids = 0;
+    size_t n_done = 0;
+    for(auto st: m_window){
+      UnindexHead(*st);
+      bool used = false;
+      for(auto fit = st->frags.begin(); fit != st->frags.end() && fit->beg < end + m_ts_tol;){
+	if(fit->end + m_ts_tol > beg){
+	  auto &sub = fit->ev;
+	  if(!ev->IsFlagTrigger() && sub->IsFlagTrigger())
+	    ev->SetTriggerN(sub->GetTriggerN());
+	  ev->AddSubEvent(sub);
+	  used = true;
+	}
+	// fragments reaching beyond the window stay for the next one
+	if(fit->end <= end){
+	  fit = st->frags.erase(fit);
+	  m_frag_n --;
+	  n_done ++;
+	}
+	else
+	  ++fit;
+      }
+      if(used)
+	n_ids ++;
+      if(!st->frags.empty())
+	IndexHead(*st);
+      else
+	EraseStreamIfDone(*st);
+    }
+    m_ts_last = std::max(m_ts_last, end);
+    Emit(std::move(ev), n_ids, n_done, n_missing);
+    return true;
+  }
+
+  void EventBuilder::Emit(EventUP ev, size_t n_ids, size_t n_orphan, size_t n_missing){
+    m_built_n ++;
+    if(n_missing){
+      ev->SetTag("EUDAQ_INCOMPLETE", std::to_string(n_missing));
+      warn_count(++m_partial_n, "incomplete events");
+    }
+    if(n_ids < 2 && m_streams.size() > 1)
+      for(size_t i = 0; i < n_orphan; i++)
+	warn_count(++m_orphan_n, "orphan fragments");
+    m_out(std::move(ev));
+  }
+
+  void EventBuilder::StreamHeap::Place(size_t i, Stream *st){
+    m_v[i] = st;
+    st->*m_pos = i;
+  }
+
+  void EventBuilder::StreamHeap::Push(Stream *st){
+    m_v.push_back(st);
+    Up(m_v.size() - 1);
+  }
+
+  void EventBuilder::StreamHeap::Erase(Stream *st){
+    size_t i = st->*m_pos;
+    Stream *last = m_v.back();
+    m_v.pop_back();
+    if(i < m_v.size()){
+      Place(i, last);
+      Up(i);
+      Down(last->*m_pos);
+    }
+  }
+
+  void EventBuilder::StreamHeap::Raise(Stream *st){
+    Down(st->*m_pos);
+  }
+
+  void EventBuilder::StreamHeap::Up(size_t i){
+    Stream *st = m_v[i];
+    while(i){
+      size_t p = (i - 1) / 2;
+      if(m_v[p]->*m_key <= st->*m_key)
+	break;
+      Place(i, m_v[p]);
+      i = p;
+    }
+    Place(i, st);
+  }
+
+  void EventBuilder::StreamHeap::Down(size_t i){
+    Stream *st = m_v[i];
+    size_t n = m_v.size();
+    while(2 * i + 1 < n){
+      size_t c = 2 * i + 1;
+      if(c + 1 < n && m_v[c + 1]->*m_key < m_v[c]->*m_key)
+	c ++;
+      if(st->*m_key <= m_v[c]->*m_key)
+	break;
+      Place(i, m_v[c]);
+      i = c;
+    }
+    Place(i, st);
+  }
+
+  void EventBuilder::StreamHeap::Below(uint64_t key, std::vector<Stream*> &sts, size_t i) const{
+    // children are never smaller, a subtree at or above the key is skipped
+    if(i >= m_v.size() || m_v[i]->*m_key >= key)
+      return;
+    sts.push_back(m_v[i]);
+    Below(key, sts, 2 * i + 1);
+    Below(key, sts, 2 * i + 2);
+  }
+}
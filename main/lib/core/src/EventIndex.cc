@@ -0,0 +1,156 @@
+#include "eudaq/EventIndex.hh"
+#include "eudaq/FileSerializer.hh"
+#include "eudaq/MappedFileDeserializer.hh"
+#include "eudaq/Logger.hh"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace eudaq {
+
+  const char EventIndex::m_magic[8] = {'E', 'U', 'D', 'Q', 'I', 'D', 'X', '\0'};
+
+  namespace{
+    template <typename T> T decode(const uint8_t *p){
+      T t = 0;
+      for (size_t i = 0; i < sizeof t; ++i) {
+	t <<= 8;
+	t += p[sizeof t - 1 - i];
+      }
+      return t;
+    }
+  }
+
+  namespace{
+    // Events are normally written in increasing order, so the table is
+    // only built if the key is found to go backwards.
+    template <typename K>
+    void make_table(const std::vector<EventIndexEntry> &entries, EventIndex::KeyTable &t, K key){
+      t.keys.clear();
+      t.first.clear();
+      auto lt = [&](const EventIndexEntry &a, const EventIndexEntry &b){return key(a) < key(b);};
+      if(std::is_sorted(entries.begin(), entries.end(), lt))
+	return;
+      std::vector<uint32_t> v(entries.size());
+      for(uint32_t i = 0; i < v.size(); i++)
+	v[i] = i;
+      std::sort(v.begin(), v.end(), [&](uint32_t a, uint32_t b){
+	  return key(entries[a]) < key(entries[b]);});
+      t.keys.resize(v.size());
+      t.first.resize(v.size());
+      uint32_t first = uint32_t(v.size());
+      for(size_t i = v.size(); i-- > 0;){
+	first = std::min(first, v[i]);
+	t.keys[i] = key(entries[v[i]]);
+	t.first[i] = first;
+      }
+    }
+
+    template <typename K>
+    const EventIndexEntry *find(const std::vector<EventIndexEntry> &entries,
+				const EventIndex::KeyTable &t, uint64_t n, K key){
+      if(t.keys.empty()){
+	auto it = std::lower_bound(entries.begin(), entries.end(), n, [&](const EventIndexEntry &e, uint64_t v){
+	    return key(e) < v;});
+	return it == entries.end() ? nullptr : &*it;
+      }
+      auto it = std::lower_bound(t.keys.begin(), t.keys.end(), n);
+      if(it == t.keys.end())
+	return nullptr;
+      return &entries[t.first[it - t.keys.begin()]];
+    }
+  }
+
+  std::string EventIndex::IndexPath(const std::string &rawfile){
+    return rawfile + ".idx";
+  }
+
+  bool EventIndex::Load(const std::string &rawfile){
+    m_entries.clear();
+    m_by_event = m_by_trigger = m_by_ts = KeyTable();
+    std::ifstream file(IndexPath(rawfile), std::ios::binary | std::ios::ate);
+    if(!file)
+      return false;
+    size_t bytes = file.tellg();
+    std::vector<uint8_t> buf(bytes);
+    file.seekg(0);
+    if(bytes && !file.read(reinterpret_cast<char*>(&buf[0]), bytes))
+      EUDAQ_THROWX(FileReadException, "Error reading from file: " + IndexPath(rawfile));
+    size_t header = sizeof(m_magic) + 2 * sizeof(uint32_t);
+    if(bytes < header || std::memcmp(&buf[0], m_magic, sizeof(m_magic))
+       || decode<uint32_t>(&buf[8]) != m_version || decode<uint32_t>(&buf[12]) != m_record_size)
+      EUDAQ_THROWX(FileFormatException, "Not an event index file of a supported version: " + IndexPath(rawfile));
+    // a trailing partial record is left from a writer which did not finish
+    size_t n = (bytes - header) / m_record_size;
+    m_entries.resize(n);
+    const uint8_t *p = &buf[header];
+    for(auto &e: m_entries){
+      e.offset = decode<uint64_t>(p);
+      e.event_n = decode<uint32_t>(p + 8);
+      e.trigger_n = decode<uint32_t>(p + 12);
+      e.ts_begin = decode<uint64_t>(p + 16);
+      e.ts_end = decode<uint64_t>(p + 24);
+      e.stream_n = decode<uint32_t>(p + 32);
+      e.flags = decode<uint32_t>(p + 36);
+      p += m_record_size;
+    }
+
+    make_table(m_entries, m_by_event, [](const EventIndexEntry &e){return uint64_t(e.event_n);});
+    make_table(m_entries, m_by_trigger, [](const EventIndexEntry &e){return uint64_t(e.trigger_n);});
+    make_table(m_entries, m_by_ts, [](const EventIndexEntry &e){return e.ts_begin;});
+    return true;
+  }
+
+  const EventIndexEntry *EventIndex::FindEvent(uint32_t n) const{
+    return find(m_entries, m_by_event, n, [](const EventIndexEntry &e){return uint64_t(e.event_n);});
+  }
+
+  const EventIndexEntry *EventIndex::FindTrigger(uint32_t n) const{
+    return find(m_entries, m_by_trigger, n, [](const EventIndexEntry &e){return uint64_t(e.trigger_n);});
+  }
+
+  const EventIndexEntry *EventIndex::FindTimestamp(uint64_t ts) const{
+    return find(m_entries, m_by_ts, ts, [](const EventIndexEntry &e){return e.ts_begin;});
+  }
+
+  size_t EventIndex::Build(const std::string &rawfile){
+    MappedFileDeserializer des(rawfile);
+    EventIndexWriter idx(rawfile, true);
+    size_t n = 0;
+    while(des.HasData()){
+      uint64_t offset = des.Tell();
+      uint32_t id;
+      des.PreRead(id);
+      EventUP ev = Factory<Event>::Create<Deserializer&>(id, des);
+      if(!ev)
+	EUDAQ_THROWX(FileFormatException, "Unknown event type at offset " + std::to_string(offset) + " in " + rawfile);
+      idx.Write(*ev, offset);
+      n++;
+    }
+    return n;
+  }
+
+  EventIndexWriter::EventIndexWriter(const std::string &rawfile, bool overwrite)
+    :m_ser(new FileSerializer(EventIndex::IndexPath(rawfile), overwrite)){
+    m_ser->append(reinterpret_cast<const uint8_t*>(EventIndex::m_magic), sizeof(EventIndex::m_magic));
+    m_ser->write(EventIndex::m_version);
+    m_ser->write(EventIndex::m_record_size);
+  }
+
+  EventIndexWriter::~EventIndexWriter(){
+  }
+
+  void EventIndexWriter::Write(const Event &ev, uint64_t offset){
+    m_ser->write(offset);
+    m_ser->write(ev.GetEventN());
+    m_ser->write(ev.GetTriggerN());
+    m_ser->write(ev.GetTimestampBegin());
+    m_ser->write(ev.GetTimestampEnd());
+    m_ser->write(ev.GetStreamN());
+    m_ser->write(ev.GetFlag());
+  }
+
+  void EventIndexWriter::Flush(){
+    m_ser->Flush();
+  }
+}
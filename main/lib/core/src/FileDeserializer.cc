@@ -32,6 +32,18 @@ namespace eudaq {
     }
   }
   
+  void FileDeserializer::Seek(uint64_t pos) {
+#ifdef _WIN32
+    int err = _fseeki64(m_file, pos, SEEK_SET);
+#else
+    int err = fseeko(m_file, pos, SEEK_SET);
+#endif
+    if (err != 0) {
+      EUDAQ_THROWX(FileReadException, "seek failed: " + to_string(pos));
+    }
+    m_start = m_stop = &m_buf[0];
+  }
+
   bool FileDeserializer::HasData() {
     if (level() == 0)
       FillBuffer();
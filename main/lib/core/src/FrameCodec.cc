@@ -0,0 +1,183 @@
+#include "eudaq/FrameCodec.hh"
+#include "eudaq/Exception.hh"
+#include <cstring>
+
+#ifdef EUDAQ_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef EUDAQ_WITH_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef EUDAQ_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace eudaq {
+
+  bool FrameCodec::IsAvailable(Type t){
+    switch(t){
+    case NONE:
+      return true;
+#ifdef EUDAQ_WITH_ZLIB
+    case ZLIB:
+      return true;
+#endif
+#ifdef EUDAQ_WITH_LZ4
+    case LZ4:
+      return true;
+#endif
+#ifdef EUDAQ_WITH_ZSTD
+    case ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+    }
+  }
+
+  FrameCodec::Type FrameCodec::FromString(const std::string &name){
+    std::string n = lcase(name);
+    Type t;
+    if(n == "none")
+      t = NONE;
+    else if(n == "zlib")
+      t = ZLIB;
+    else if(n == "lz4")
+      t = LZ4;
+    else if(n == "zstd")
+      t = ZSTD;
+    else
+      EUDAQ_THROW("FrameCodec: unknown compression " + name);
+    if(!IsAvailable(t))
+      EUDAQ_THROW("FrameCodec: compression " + name + " is not available in this build");
+    return t;
+  }
+
+  std::string FrameCodec::ToString(Type t){
+    switch(t){
+    case NONE: return "none";
+    case ZLIB: return "zlib";
+    case LZ4: return "lz4";
+    case ZSTD: return "zstd";
+    default: return "unknown(" + std::to_string(uint32_t(t)) + ")";
+    }
+  }
+
+  FrameCodec::Type FrameCodec::Default(){
+    for(auto t: {ZSTD, LZ4, ZLIB})
+      if(IsAvailable(t))
+	return t;
+    return NONE;
+  }
+
+  void FrameCodec::Compress(Type t, int level, const uint8_t *src, size_t len,
+			    std::vector<uint8_t> &dst){
+    switch(t){
+    case NONE:{
+      dst.assign(src, src + len);
+      return;
+    }
+#ifdef EUDAQ_WITH_ZLIB
+    case ZLIB:{
+      uLongf n = compressBound(len);
+      dst.resize(n);
+      if(compress2(&dst[0], &n, src, len, level > 0 ? level : Z_DEFAULT_COMPRESSION) != Z_OK)
+	EUDAQ_THROW("FrameCodec: zlib compression failed");
+      dst.resize(n);
+      return;
+    }
+#endif
+#ifdef EUDAQ_WITH_LZ4
+    case LZ4:{
+      dst.resize(LZ4_compressBound(len));
+      int n = level > 1 ?
+	LZ4_compress_HC(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(&dst[0]), len, dst.size(), level) :
+	LZ4_compress_default(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(&dst[0]), len, dst.size());
+      if(n <= 0)
+	EUDAQ_THROW("FrameCodec: LZ4 compression failed");
+      dst.resize(n);
+      return;
+    }
+#endif
+#ifdef EUDAQ_WITH_ZSTD
+    case ZSTD:{
+      dst.resize(ZSTD_compressBound(len));
+      size_t n = ZSTD_compress(&dst[0], dst.size(), src, len, level > 0 ? level : 3);
+      if(ZSTD_isError(n))
+	EUDAQ_THROW(std::string("FrameCodec: zstd compression failed: ") + ZSTD_getErrorName(n));
+      dst.resize(n);
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROW("FrameCodec: compression " + ToString(t) + " is not available in this build");
+    }
+  }
+
+  void FrameCodec::Decompress(Type t, const uint8_t *src, size_t len,
+			      uint8_t *dst, size_t rawlen){
+    switch(t){
+    case NONE:{
+      if(len != rawlen)
+	EUDAQ_THROWX(FileFormatException, "FrameCodec: size mismatch of uncompressed frame");
+      std::memcpy(dst, src, len);
+      return;
+    }
+#ifdef EUDAQ_WITH_ZLIB
+    case ZLIB:{
+      uLongf n = rawlen;
+      if(uncompress(dst, &n, src, len) != Z_OK || n != rawlen)
+	EUDAQ_THROWX(FileFormatException, "FrameCodec: zlib decompression failed");
+      return;
+    }
+#endif
+#ifdef EUDAQ_WITH_LZ4
+    case LZ4:{
+      int n = LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst), len, rawlen);
+      if(n < 0 || size_t(n) != rawlen)
+	EUDAQ_THROWX(FileFormatException, "FrameCodec: LZ4 decompression failed");
+      return;
+    }
+#endif
+#ifdef EUDAQ_WITH_ZSTD
+    case ZSTD:{
+      size_t n = ZSTD_decompress(dst, rawlen, src, len);
+      if(ZSTD_isError(n) || n != rawlen)
+	EUDAQ_THROWX(FileFormatException, "FrameCodec: zstd decompression failed");
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROWX(FileFormatException, "FrameCodec: compression " + ToString(t) + " is not available in this build");
+    }
+  }
+
+  const char FrameHeader::m_file_magic[8] = {'E', 'U', 'D', 'A', 'Q', 'Z', '\0', '\0'};
+
+  void FrameHeader::Serialize(Serializer &ser) const{
+    ser.write(codec);
+    ser.write(n_event);
+    ser.write(event_first);
+    ser.write(event_last);
+    ser.write(trigger_first);
+    ser.write(trigger_last);
+    ser.write(ts_first);
+    ser.write(ts_last);
+    ser.write(raw_bytes);
+    ser.write(stored_bytes);
+  }
+
+  void FrameHeader::Deserialize(Deserializer &des){
+    des.read(codec);
+    des.read(n_event);
+    des.read(event_first);
+    des.read(event_last);
+    des.read(trigger_first);
+    des.read(trigger_last);
+    des.read(ts_first);
+    des.read(ts_last);
+    des.read(raw_bytes);
+    des.read(stored_bytes);
+  }
+}
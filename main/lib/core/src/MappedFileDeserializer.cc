@@ -0,0 +1,161 @@
+#include "eudaq/MappedFileDeserializer.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Utils.hh"
+#include <cstring>
+#include <cerrno>
+
+#if EUDAQ_PLATFORM_IS(WIN32)
+#include <fstream>
+#include <vector>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace eudaq {
+
+  class MappedFile{
+  public:
+    MappedFile(const std::string &fname);
+    ~MappedFile();
+    const uint8_t *Data() const {return m_data;};
+    uint64_t Size() const {return m_size;};
+  private:
+    const uint8_t *m_data;
+    uint64_t m_size;
+#if EUDAQ_PLATFORM_IS(WIN32)
+    std::vector<uint8_t> m_buf;
+#endif
+  };
+
+#if EUDAQ_PLATFORM_IS(WIN32)
+  MappedFile::MappedFile(const std::string &fname)
+    :m_data(nullptr), m_size(0){
+    std::ifstream file(fname, std::ios::binary | std::ios::ate);
+    if(!file)
+      EUDAQ_THROWX(FileNotFoundException, "Unable to open file: " + fname);
+    m_size = file.tellg();
+    m_buf.resize(m_size);
+    file.seekg(0);
+    if(m_size && !file.read(reinterpret_cast<char*>(&m_buf[0]), m_size))
+      EUDAQ_THROWX(FileReadException, "Error reading from file: " + fname);
+    m_data = m_buf.data();
+  }
+
+  MappedFile::~MappedFile(){
+  }
+
+  static uint64_t FileSize(const std::string &fname){
+    std::ifstream file(fname, std::ios::binary | std::ios::ate);
+    return file ? static_cast<uint64_t>(file.tellg()) : 0;
+  }
+#else
+  MappedFile::MappedFile(const std::string &fname)
+    :m_data(nullptr), m_size(0){
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0)
+      EUDAQ_THROWX(FileNotFoundException, "Unable to open file: " + fname);
+    struct stat st;
+    if(fstat(fd, &st) != 0){
+      close(fd);
+      EUDAQ_THROWX(FileReadException, "Unable to stat file: " + fname);
+    }
+    m_size = st.st_size;
+    if(m_size){
+      void *addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(addr == MAP_FAILED){
+	close(fd);
+	EUDAQ_THROWX(FileReadException, "Unable to map file: " + fname + ", " + strerror(errno));
+      }
+      madvise(addr, m_size, MADV_SEQUENTIAL);
+      m_data = static_cast<const uint8_t*>(addr);
+    }
+    close(fd);
+  }
+
+  MappedFile::~MappedFile(){
+    if(m_data)
+      munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+
+  static uint64_t FileSize(const std::string &fname){
+    struct stat st;
+    return stat(fname.c_str(), &st) == 0 ? st.st_size : 0;
+  }
+#endif
+
+  MappedFileDeserializer::MappedFileDeserializer(const std::string &fname)
+    :m_fname(fname), m_pos(0){
+    m_map = std::make_shared<MappedFile>(fname);
+    m_stat_size = m_map->Size();
+  }
+
+  MappedFileDeserializer::~MappedFileDeserializer(){
+  }
+
+  bool MappedFileDeserializer::HasData(){
+    if(m_pos < m_map->Size())
+      return true;
+    return Remap() && m_pos < m_map->Size();
+  }
+
+  std::shared_ptr<const void> MappedFileDeserializer::GetBacking() const{
+    return m_map;
+  }
+
+  uint64_t MappedFileDeserializer::FileBytes() const{
+    return m_map->Size();
+  }
+
+  void MappedFileDeserializer::Seek(uint64_t pos){
+    if(pos > m_map->Size() && !(Remap() && pos <= m_map->Size()))
+      EUDAQ_THROWX(FileReadException, "Seek beyond end of file: " + m_fname);
+    m_pos = pos;
+  }
+
+  bool MappedFileDeserializer::Remap(){
+    // The file may still be growing while it is being written by a
+    // DataCollector. Events handed out keep the old mapping alive.
+    // A stat is much cheaper than a new mapping, so only remap on growth.
+    uint64_t size = FileSize(m_fname);
+    if(size <= m_stat_size)
+      return false;
+    std::shared_ptr<MappedFile> map = std::make_shared<MappedFile>(m_fname);
+    m_stat_size = map->Size();
+    if(map->Size() <= m_map->Size())
+      return false;
+    m_map = map;
+    return true;
+  }
+
+  void MappedFileDeserializer::Require(size_t len){
+    if(m_pos + len > m_map->Size() && !(Remap() && m_pos + len <= m_map->Size()))
+      EUDAQ_THROWX(FileReadException, "Deserialize asked for " + to_string(len) +
+		   ", only have " + to_string(m_map->Size() - m_pos));
+  }
+
+  void MappedFileDeserializer::Deserialize(uint8_t *data, size_t len){
+    if(!len)
+      return;
+    Require(len);
+    std::memcpy(data, m_map->Data() + m_pos, len);
+    m_pos += len;
+  }
+
+  void MappedFileDeserializer::PreDeserialize(uint8_t *data, size_t len){
+    if(!len)
+      return;
+    Require(len);
+    std::memcpy(data, m_map->Data() + m_pos, len);
+  }
+
+  const uint8_t *MappedFileDeserializer::BorrowDeserialize(size_t len){
+    Require(len);
+    const uint8_t *data = m_map->Data() + m_pos;
+    m_pos += len;
+    return data;
+  }
+}
@@ -68,6 +68,7 @@ namespace eudaq {
     auto conf = GetConfiguration();
     try {
       SetStatus(Status::STATE_UNCONF, "Configuring");
+      ConfigureReceiveQueue(conf);
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const Exception &e) {
@@ -128,6 +129,9 @@ namespace eudaq {
     
   void Monitor::OnStatus(){
     SetStatusTag("EventN", std::to_string(m_evt_c));
+    SetStatusTag("RecvQueue", std::to_string(ReceiveQueueSize()));
+    SetStatusTag("RecvQueueMax", std::to_string(ReceiveQueueHighWater()));
+    SetStatusTag("RecvDroppedN", std::to_string(ReceiveDroppedCount()));
     DoStatus();
     CommandReceiver::OnStatus();
   }
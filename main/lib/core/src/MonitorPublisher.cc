@@ -0,0 +1,176 @@
+#include "eudaq/MonitorPublisher.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+
+namespace eudaq {
+
+  namespace {
+    // how long Clear() waits for a monitor to take its remaining events
+    // before the sending thread is left to finish on its own
+    static const auto DRAIN_TIMEOUT = std::chrono::seconds(1);
+  }
+
+  MonitorPublisher::MonitorPublisher(const std::string &type, const std::string &name)
+    :m_type(type), m_name(name), m_fraction(1), m_interval_ns(0), m_capacity(64),
+     m_seen_n(0), m_sampled_n(0), m_dropped_n(0), m_reserve(0), m_busy(false), m_exit(false){
+    m_thread = std::thread(&MonitorPublisher::Serializing, this);
+  }
+
+  MonitorPublisher::~MonitorPublisher(){
+    Clear();
+    std::unique_lock<std::mutex> lk(m_mx);
+    m_exit = true;
+    lk.unlock();
+    m_cv.notify_all();
+    if(m_thread.joinable())
+      m_thread.join();
+  }
+
+  void MonitorPublisher::SetRate(double hz){
+    m_interval_ns = hz > 0 ? int64_t(1e9 / hz) : 0;
+  }
+
+  void MonitorPublisher::Subscribe(const std::string &server){
+    SubscriberSP sub(new Subscriber);
+    sub->sender.reset(new DataSender(m_type, m_name));
+    sub->sender->Connect(server);
+    sub->dropped_n = 0;
+    sub->exit = false;
+    sub->done = false;
+    std::thread(&MonitorPublisher::Sending, sub).detach();
+    std::unique_lock<std::mutex> lk(m_mx);
+    m_subs.push_back(sub);
+  }
+
+  void MonitorPublisher::Clear(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    // let the events published so far, e.g. the EORE, reach the monitors
+    m_cv.wait_for(lk, DRAIN_TIMEOUT, [this](){return m_queue.empty() && !m_busy;});
+    std::vector<SubscriberSP> subs;
+    subs.swap(m_subs);
+    m_queue.clear();
+    m_seen_n = 0;
+    m_next = Clock::time_point();
+    lk.unlock();
+    for(auto &sub: subs){
+      std::unique_lock<std::mutex> lk_sub(sub->mx);
+      sub->exit = true;
+      sub->cv.notify_all();
+      if(!sub->cv.wait_for(lk_sub, DRAIN_TIMEOUT, [&sub](){return sub->done;}))
+	EUDAQ_WARN("MonitorPublisher: a monitor did not take its last events in time");
+    }
+  }
+
+  void MonitorPublisher::Publish(EventSPC ev){
+    std::unique_lock<std::mutex> lk(m_mx);
+    if(m_subs.empty())
+      return;
+    if(!ev->IsBORE() && !ev->IsEORE()){
+      uint32_t fraction = m_fraction;
+      if(!fraction || ++m_seen_n % fraction)
+	return;
+      int64_t interval = m_interval_ns;
+      if(interval){
+	auto now = Clock::now();
+	if(now < m_next)
+	  return;
+	m_next = now + std::chrono::nanoseconds(interval);
+      }
+    }
+    m_queue.push_back(std::move(ev));
+    if(m_queue.size() > m_capacity){
+      m_queue.pop_front();
+      m_dropped_n ++;
+    }
+    m_sampled_n ++;
+    lk.unlock();
+    m_cv.notify_one();
+  }
+
+  size_t MonitorPublisher::Subscribers(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    return m_subs.size();
+  }
+
+  uint64_t MonitorPublisher::DroppedCount(){
+    std::unique_lock<std::mutex> lk(m_mx);
+    uint64_t n = m_dropped_n;
+    auto subs = m_subs;
+    lk.unlock();
+    for(auto &sub: subs){
+      std::unique_lock<std::mutex> lk_sub(sub->mx);
+      n += sub->dropped_n;
+    }
+    return n;
+  }
+
+  void MonitorPublisher::Serializing(){
+    std::deque<EventSPC> batch;
+    std::unique_lock<std::mutex> lk(m_mx);
+    while(true){
+      m_cv.wait(lk, [this](){return !m_queue.empty() || m_exit;});
+      if(m_exit)
+	break;
+      batch.swap(m_queue);
+      m_busy = true;
+      auto subs = m_subs;
+      lk.unlock();
+      for(auto &ev: batch){
+	// one buffer per event, shared by all monitors
+	std::shared_ptr<BufferSerializer> buf(new BufferSerializer);
+	buf->reserve(m_reserve);
+	ev->Serialize(*buf);
+	m_reserve = std::max(m_reserve, buf->size());
+	Buffer cbuf(buf);
+	size_t capacity = m_capacity;
+	for(auto &sub: subs){
+	  std::unique_lock<std::mutex> lk_sub(sub->mx);
+	  if(sub->exit)
+	    continue;
+	  sub->queue.push_back(cbuf);
+	  if(sub->queue.size() > capacity){
+	    sub->queue.pop_front();
+	    sub->dropped_n ++;
+	  }
+	  lk_sub.unlock();
+	  sub->cv.notify_all();
+	}
+      }
+      batch.clear();
+      lk.lock();
+      m_busy = false;
+      m_cv.notify_all();
+    }
+  }
+
+  void MonitorPublisher::Sending(SubscriberSP sub){
+    // owns its subscriber, so it may outlive the publisher when a monitor
+    // is stuck at the end of a run
+    std::unique_lock<std::mutex> lk(sub->mx);
+    while(true){
+      sub->cv.wait(lk, [&sub](){return !sub->queue.empty() || sub->exit;});
+      if(sub->queue.empty())
+	break;
+      Buffer buf = sub->queue.front();
+      sub->queue.pop_front();
+      lk.unlock();
+      try{
+	sub->sender->SendBuffer(*buf);
+      }
+      catch(const std::exception &e){
+	EUDAQ_WARN(std::string("MonitorPublisher: stop sending to a monitor: ") + e.what());
+	lk.lock();
+	break;
+      }
+      lk.lock();
+    }
+    sub->queue.clear();
+    sub->exit = true;
+    sub->done = true;
+    sub->cv.notify_all();
+    lk.unlock();
+    sub->sender.reset();
+  }
+}
@@ -1,13 +1,23 @@
 #include "eudaq/FileDeserializer.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/EventIndex.hh"
+#include "eudaq/Logger.hh"
 
 class NativeFileReader : public eudaq::FileReader {
 public:
   NativeFileReader(const std::string& filename);
   eudaq::EventSPC GetNextEvent()override;
+  bool SeekEvent(uint32_t n) override;
+  bool SeekTrigger(uint32_t n) override;
+  bool SeekTimestamp(uint64_t ts) override;
+  bool SeekOrdered() const override {return m_seek_ordered;};
 private:
+  const eudaq::EventIndex &Index();
+  bool Seek(const eudaq::EventIndexEntry *e, bool ordered);
   std::unique_ptr<eudaq::FileDeserializer> m_des;
+  std::unique_ptr<eudaq::EventIndex> m_idx;
   std::string m_filename;
+  bool m_seek_ordered;
 };
 
 namespace{
@@ -18,7 +28,7 @@ namespace{
 }
 
 NativeFileReader::NativeFileReader(const std::string& filename)
-  :m_filename(filename){    
+  :m_filename(filename), m_seek_ordered(false){    
 }
 
 eudaq::EventSPC NativeFileReader::GetNextEvent(){
@@ -34,7 +44,41 @@ eudaq::EventSPC NativeFileReader::GetNextEvent(){
     m_des->PreRead(id);
     ev = eudaq::Factory<eudaq::Event>::
       Create<eudaq::Deserializer&>(id, *m_des);
-    return std::move(ev);
+    return ev;
   }  else  return nullptr;
   
 }
+
+const eudaq::EventIndex &NativeFileReader::Index(){
+  if(!m_idx){
+    m_idx.reset(new eudaq::EventIndex);
+    if(!m_idx->Load(m_filename))
+      EUDAQ_WARN("NativeFileReader: no index for " + m_filename + ", create it with euCliIndexer");
+  }
+  return *m_idx;
+}
+
+bool NativeFileReader::Seek(const eudaq::EventIndexEntry *e, bool ordered){
+  if(!e)
+    return false;
+  m_seek_ordered = ordered;
+  if(!m_des)
+    m_des.reset(new eudaq::FileDeserializer(m_filename));
+  m_des->Seek(e->offset);
+  return true;
+}
+
+bool NativeFileReader::SeekEvent(uint32_t n){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindEvent(n), idx.EventsOrdered());
+}
+
+bool NativeFileReader::SeekTrigger(uint32_t n){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindTrigger(n), idx.TriggersOrdered());
+}
+
+bool NativeFileReader::SeekTimestamp(uint64_t ts){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindTimestamp(ts), idx.TimestampsOrdered());
+}
@@ -1,16 +1,36 @@
 #include "eudaq/FileNamer.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileSerializer.hh"
+#include "eudaq/EventIndex.hh"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 class NativeFileWriter : public eudaq::FileWriter {
 public:
   NativeFileWriter(const std::string &patt);
+  ~NativeFileWriter() override;
   void WriteEvent(eudaq::EventSPC ev) override;
+  void Flush() override;
   uint64_t FileBytes() const override;
 private:
+  void Configure();
+  void FlushFiles();
+  void Flushing();
+  mutable std::mutex m_mx;
+  std::condition_variable m_cv_exit;
+  bool m_exit;
+  std::thread m_thd_flush;
   std::unique_ptr<eudaq::FileSerializer> m_ser;
+  std::unique_ptr<eudaq::EventIndexWriter> m_idx;
   std::string m_filepattern;
   uint32_t m_run_n;
+  bool m_configured;
+  uint32_t m_flush_events;
+  uint32_t m_flush_ms;
+  uint32_t m_unflushed;
+  bool m_dirty;
 };
 
 namespace{
@@ -20,11 +40,43 @@ namespace{
     Register<NativeFileWriter, std::string&&>(eudaq::cstr2hash("native"));
 }
 
-NativeFileWriter::NativeFileWriter(const std::string &patt){
+NativeFileWriter::NativeFileWriter(const std::string &patt)
+  :m_exit(false), m_run_n(0), m_configured(false), m_flush_events(0), m_flush_ms(1000), m_unflushed(0), m_dirty(false){
   m_filepattern = patt;
 }
-  
+
+NativeFileWriter::~NativeFileWriter(){
+  std::unique_lock<std::mutex> lk(m_mx);
+  m_exit = true;
+  lk.unlock();
+  m_cv_exit.notify_all();
+  if(m_thd_flush.joinable())
+    m_thd_flush.join();
+}
+
+// Durability policy: the file is flushed after EUDAQ_FW_FLUSH_EVENTS events
+// (default 0, disabled) and every EUDAQ_FW_FLUSH_MS ms by a timer thread
+// (default 1000, 0 to disable). A flush costs a write system call for the
+// data and one for the index, so flushing after every event limits the rate
+// far more than the serialization does.
+// The index is only needed for seeking and a reader copes with it lagging
+// behind, so it is flushed with the data on the timer and on Flush(),
+// not after every event.
+void NativeFileWriter::Configure(){
+  auto conf = GetConfiguration();
+  if(conf){
+    m_flush_events = conf->Get("EUDAQ_FW_FLUSH_EVENTS", m_flush_events);
+    m_flush_ms = conf->Get("EUDAQ_FW_FLUSH_MS", m_flush_ms);
+  }
+  if(m_flush_ms)
+    m_thd_flush = std::thread(&NativeFileWriter::Flushing, this);
+  m_configured = true;
+}
+
 void NativeFileWriter::WriteEvent(eudaq::EventSPC ev) {
+  std::unique_lock<std::mutex> lk(m_mx);
+  if(!m_configured)
+    Configure();
   uint32_t run_n = ev->GetRunN();
   if(!m_ser || m_run_n != run_n){
     std::time_t time_now = std::time(nullptr);
@@ -33,18 +85,49 @@ void NativeFileWriter::WriteEvent(eudaq::EventSPC ev) {
     std::strftime(time_buff, sizeof(time_buff),
 		  "%y%m%d%H%M%S", std::localtime(&time_now));
     std::string time_str(time_buff);
-    m_ser.reset(new eudaq::FileSerializer((eudaq::FileNamer(m_filepattern).
-					   Set('X', ".raw").
-					   Set('R', run_n).
-					   Set('D', time_str))));
+    std::string filename = eudaq::FileNamer(m_filepattern).
+      Set('X', ".raw").
+      Set('R', run_n).
+      Set('D', time_str);
+    m_ser.reset(new eudaq::FileSerializer(filename));
+    m_idx.reset(new eudaq::EventIndexWriter(filename));
     m_run_n = run_n;
   }
   if(!m_ser)
     EUDAQ_THROW("NativeFileWriter: Attempt to write unopened file");
+  m_idx->Write(*ev, m_ser->FileBytes());
   m_ser->write(*(ev.get())); //TODO: Serializer accepts EventSPC
+  m_dirty = true;
+  m_unflushed ++;
+  if(m_flush_events && m_unflushed >= m_flush_events){
+    m_ser->Flush();
+    m_unflushed = 0;
+  }
+}
+
+void NativeFileWriter::Flush(){
+  std::unique_lock<std::mutex> lk(m_mx);
+  FlushFiles();
+}
+
+void NativeFileWriter::FlushFiles(){
+  if(!m_ser)
+    return;
   m_ser->Flush();
+  m_idx->Flush();
+  m_unflushed = 0;
+  m_dirty = false;
+}
+
+void NativeFileWriter::Flushing(){
+  std::unique_lock<std::mutex> lk(m_mx);
+  while(!m_cv_exit.wait_for(lk, std::chrono::milliseconds(m_flush_ms), [this](){return m_exit;})){
+    if(m_dirty)
+      FlushFiles();
+  }
 }
   
 uint64_t NativeFileWriter::FileBytes() const {
+  std::unique_lock<std::mutex> lk(m_mx);
   return m_ser ?m_ser->FileBytes() :0;
 }
@@ -0,0 +1,82 @@
+#include "eudaq/MappedFileDeserializer.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/EventIndex.hh"
+#include "eudaq/Logger.hh"
+
+// Reads the native format through a memory mapping of the file.
+// The data blocks of the returned events are not copied, but refer
+// directly to the mapped file.
+class NativeMmapFileReader : public eudaq::FileReader {
+public:
+  NativeMmapFileReader(const std::string& filename);
+  eudaq::EventSPC GetNextEvent()override;
+  bool SeekEvent(uint32_t n) override;
+  bool SeekTrigger(uint32_t n) override;
+  bool SeekTimestamp(uint64_t ts) override;
+  bool SeekOrdered() const override {return m_seek_ordered;};
+private:
+  const eudaq::EventIndex &Index();
+  bool Seek(const eudaq::EventIndexEntry *e, bool ordered);
+  std::unique_ptr<eudaq::MappedFileDeserializer> m_des;
+  std::unique_ptr<eudaq::EventIndex> m_idx;
+  std::string m_filename;
+  bool m_seek_ordered;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeMmapFileReader, std::string&>(eudaq::cstr2hash("native-mmap"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeMmapFileReader, std::string&&>(eudaq::cstr2hash("native-mmap"));
+}
+
+NativeMmapFileReader::NativeMmapFileReader(const std::string& filename)
+  :m_filename(filename), m_seek_ordered(false){
+}
+
+eudaq::EventSPC NativeMmapFileReader::GetNextEvent(){
+  if(!m_des){
+    m_des.reset(new eudaq::MappedFileDeserializer(m_filename));
+  }
+  if(!m_des->HasData())
+    return nullptr;
+  uint32_t id;
+  m_des->PreRead(id);
+  eudaq::EventUP ev = eudaq::Factory<eudaq::Event>::
+    Create<eudaq::Deserializer&>(id, *m_des);
+  return ev;
+}
+
+const eudaq::EventIndex &NativeMmapFileReader::Index(){
+  if(!m_idx){
+    m_idx.reset(new eudaq::EventIndex);
+    if(!m_idx->Load(m_filename))
+      EUDAQ_WARN("NativeMmapFileReader: no index for " + m_filename + ", create it with euCliIndexer");
+  }
+  return *m_idx;
+}
+
+bool NativeMmapFileReader::Seek(const eudaq::EventIndexEntry *e, bool ordered){
+  if(!e)
+    return false;
+  m_seek_ordered = ordered;
+  if(!m_des)
+    m_des.reset(new eudaq::MappedFileDeserializer(m_filename));
+  m_des->Seek(e->offset);
+  return true;
+}
+
+bool NativeMmapFileReader::SeekEvent(uint32_t n){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindEvent(n), idx.EventsOrdered());
+}
+
+bool NativeMmapFileReader::SeekTrigger(uint32_t n){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindTrigger(n), idx.TriggersOrdered());
+}
+
+bool NativeMmapFileReader::SeekTimestamp(uint64_t ts){
+  const eudaq::EventIndex &idx = Index();
+  return Seek(idx.FindTimestamp(ts), idx.TimestampsOrdered());
+}
@@ -0,0 +1,183 @@
+#include "eudaq/FileDeserializer.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FrameCodec.hh"
+#include "eudaq/Logger.hh"
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+// Reads the frames written by NativeZFileWriter. The frame table is built
+// from the frame headers when the file is opened, which allows to seek by
+// event number, trigger number and timestamp at frame granularity.
+// Data blocks of the returned events refer to the decompressed frame.
+class NativeZFileReader : public eudaq::FileReader {
+public:
+  NativeZFileReader(const std::string& filename);
+  eudaq::EventSPC GetNextEvent()override;
+  bool SeekEvent(uint32_t n) override;
+  bool SeekTrigger(uint32_t n) override;
+  bool SeekTimestamp(uint64_t ts) override;
+private:
+  class FrameDeserializer : public eudaq::Deserializer{
+  public:
+    FrameDeserializer(std::shared_ptr<const std::vector<uint8_t>> buf)
+      :m_buf(buf), m_offset(0){};
+    bool HasData() override {return m_offset < m_buf->size();};
+    std::shared_ptr<const void> GetBacking() const override {return m_buf;};
+  private:
+    void Deserialize(uint8_t *data, size_t len) override;
+    void PreDeserialize(uint8_t *data, size_t len) override;
+    const uint8_t *BorrowDeserialize(size_t len) override;
+    std::shared_ptr<const std::vector<uint8_t>> m_buf;
+    size_t m_offset;
+  };
+
+  struct FrameEntry{
+    eudaq::FrameHeader header;
+    uint64_t offset;
+  };
+
+  void Open();
+  void LoadFrame(size_t i);
+  eudaq::EventSPC ReadEvent();
+  bool Seek(std::function<bool(const eudaq::FrameHeader&)> frame_ok,
+	    std::function<bool(const eudaq::Event&)> event_ok);
+  std::string m_filename;
+  std::unique_ptr<eudaq::FileDeserializer> m_des;
+  std::vector<FrameEntry> m_frames;
+  size_t m_frame_next;
+  std::unique_ptr<FrameDeserializer> m_frame;
+  eudaq::EventSPC m_pending;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeZFileReader, std::string&>(eudaq::cstr2hash("native-z"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeZFileReader, std::string&&>(eudaq::cstr2hash("native-z"));
+}
+
+void NativeZFileReader::FrameDeserializer::Deserialize(uint8_t *data, size_t len){
+  PreDeserialize(data, len);
+  m_offset += len;
+}
+
+void NativeZFileReader::FrameDeserializer::PreDeserialize(uint8_t *data, size_t len){
+  if(!len)
+    return;
+  if(len + m_offset > m_buf->size())
+    EUDAQ_THROWX(eudaq::FileFormatException, "Event exceeds the frame: asked for " + std::to_string(len) +
+		 ", only have " + std::to_string(m_buf->size() - m_offset));
+  std::memcpy(data, m_buf->data() + m_offset, len);
+}
+
+const uint8_t *NativeZFileReader::FrameDeserializer::BorrowDeserialize(size_t len){
+  if(len + m_offset > m_buf->size())
+    EUDAQ_THROWX(eudaq::FileFormatException, "Event exceeds the frame: asked for " + std::to_string(len) +
+		 ", only have " + std::to_string(m_buf->size() - m_offset));
+  const uint8_t *data = m_buf->data() + m_offset;
+  m_offset += len;
+  return data;
+}
+
+NativeZFileReader::NativeZFileReader(const std::string& filename)
+  :m_filename(filename), m_frame_next(0){
+}
+
+void NativeZFileReader::Open(){
+  m_des.reset(new eudaq::FileDeserializer(m_filename, true));
+  char magic[sizeof(eudaq::FrameHeader::m_file_magic)];
+  uint32_t version;
+  m_des->read(reinterpret_cast<uint8_t*>(magic), sizeof(magic));
+  m_des->read(version);
+  if(std::memcmp(magic, eudaq::FrameHeader::m_file_magic, sizeof(magic)) ||
+     version != eudaq::FrameHeader::m_file_version)
+    EUDAQ_THROWX(eudaq::FileFormatException, "Not a native-z file of a supported version: " + m_filename);
+  uint64_t offset = sizeof(magic) + sizeof(version);
+  std::ifstream file(m_filename, std::ios::binary | std::ios::ate);
+  uint64_t filesize = file.tellg();
+  while(offset + eudaq::FrameHeader::m_size <= filesize){
+    FrameEntry e;
+    e.offset = offset;
+    e.header.Deserialize(*m_des);
+    offset += eudaq::FrameHeader::m_size + e.header.stored_bytes;
+    if(offset > filesize){
+      EUDAQ_WARN("NativeZFileReader: ignoring truncated frame at the end of " + m_filename);
+      break;
+    }
+    m_frames.push_back(e);
+    m_des->Seek(offset);
+  }
+}
+
+void NativeZFileReader::LoadFrame(size_t i){
+  auto &e = m_frames.at(i);
+  m_des->Seek(e.offset + eudaq::FrameHeader::m_size);
+  std::vector<uint8_t> stored(e.header.stored_bytes);
+  if(!stored.empty())
+    m_des->read(stored.data(), stored.size());
+  auto raw = std::make_shared<std::vector<uint8_t>>(e.header.raw_bytes);
+  eudaq::FrameCodec::Decompress(eudaq::FrameCodec::Type(e.header.codec), stored.data(), stored.size(),
+				raw->data(), raw->size());
+  m_frame.reset(new FrameDeserializer(raw));
+  m_frame_next = i + 1;
+}
+
+eudaq::EventSPC NativeZFileReader::ReadEvent(){
+  if(!m_des)
+    Open();
+  while(!m_frame || !m_frame->HasData()){
+    if(m_frame_next >= m_frames.size())
+      return nullptr;
+    LoadFrame(m_frame_next);
+  }
+  uint32_t id;
+  m_frame->PreRead(id);
+  eudaq::EventUP ev = eudaq::Factory<eudaq::Event>::
+    Create<eudaq::Deserializer&>(id, *m_frame);
+  return ev;
+}
+
+eudaq::EventSPC NativeZFileReader::GetNextEvent(){
+  if(m_pending){
+    eudaq::EventSPC ev;
+    ev.swap(m_pending);
+    return ev;
+  }
+  return ReadEvent();
+}
+
+bool NativeZFileReader::Seek(std::function<bool(const eudaq::FrameHeader&)> frame_ok,
+			     std::function<bool(const eudaq::Event&)> event_ok){
+  if(!m_des)
+    Open();
+  for(size_t i = 0; i < m_frames.size(); i++){
+    if(!frame_ok(m_frames[i].header))
+      continue;
+    LoadFrame(i);
+    while(auto ev = ReadEvent()){
+      if(event_ok(*ev)){
+	m_pending = ev;
+	return true;
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
+bool NativeZFileReader::SeekEvent(uint32_t n){
+  return Seek([n](const eudaq::FrameHeader &h){return h.event_last >= n;},
+	      [n](const eudaq::Event &ev){return ev.GetEventN() >= n;});
+}
+
+bool NativeZFileReader::SeekTrigger(uint32_t n){
+  return Seek([n](const eudaq::FrameHeader &h){return h.trigger_last >= n;},
+	      [n](const eudaq::Event &ev){return ev.GetTriggerN() >= n;});
+}
+
+bool NativeZFileReader::SeekTimestamp(uint64_t ts){
+  return Seek([ts](const eudaq::FrameHeader &h){return h.ts_last >= ts;},
+	      [ts](const eudaq::Event &ev){return ev.GetTimestampBegin() >= ts;});
+}
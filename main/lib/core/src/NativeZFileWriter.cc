@@ -0,0 +1,237 @@
+#include "eudaq/FileNamer.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/FileSerializer.hh"
+#include "eudaq/FrameCodec.hh"
+#include "eudaq/Logger.hh"
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Writes the native event serialization in independently compressed frames.
+// Full frames are compressed by a pool of worker threads, so that the
+// thread calling WriteEvent (e.g. in a DataCollector) only serializes.
+// Configuration (section of the DataCollector):
+//   EUDAQ_FW_Z_CODEC        zstd, lz4, zlib or none (default: best available)
+//   EUDAQ_FW_Z_LEVEL        compression level, 0 for the codec default
+//   EUDAQ_FW_Z_FRAME_BYTES  uncompressed size of a frame (default: 4 MB)
+//   EUDAQ_FW_Z_THREADS      number of compression threads (default: 2)
+class NativeZFileWriter : public eudaq::FileWriter {
+public:
+  NativeZFileWriter(const std::string &patt);
+  ~NativeZFileWriter() override;
+  void WriteEvent(eudaq::EventSPC ev) override;
+  uint64_t FileBytes() const override;
+private:
+  struct Frame{
+    eudaq::FrameHeader header;
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> stored;
+    bool done; // guarded by m_mx, set after Compress
+  };
+
+  class FrameSerializer : public eudaq::Serializer{
+  public:
+    FrameSerializer(std::vector<uint8_t> &buf) :m_buf(buf){};
+  private:
+    void Serialize(const uint8_t *data, size_t len) override{
+      m_buf.insert(m_buf.end(), data, data + len);
+    };
+    std::vector<uint8_t> &m_buf;
+  };
+
+  void Configure();
+  void CloseFile();
+  void SubmitFrame();
+  void Compress(Frame &frame);
+  void WriteDoneFrames();
+  void Compressing();
+
+  std::string m_filepattern;
+  uint32_t m_run_n;
+  bool m_configured;
+  eudaq::FrameCodec::Type m_codec;
+  int m_level;
+  size_t m_frame_bytes;
+  size_t m_max_inflight;
+  std::unique_ptr<eudaq::FileSerializer> m_ser;
+  std::atomic<uint64_t> m_filebytes;
+  std::shared_ptr<Frame> m_frame;
+
+  std::mutex m_mx;
+  std::condition_variable m_cv;
+  std::deque<std::shared_ptr<Frame>> m_inflight;
+  std::deque<std::shared_ptr<Frame>> m_todo;
+  std::vector<std::thread> m_workers;
+  std::string m_error;
+  bool m_exit;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileWriter>::
+    Register<NativeZFileWriter, std::string&>(eudaq::cstr2hash("native-z"));
+  auto dummy1 = eudaq::Factory<eudaq::FileWriter>::
+    Register<NativeZFileWriter, std::string&&>(eudaq::cstr2hash("native-z"));
+}
+
+NativeZFileWriter::NativeZFileWriter(const std::string &patt)
+  :m_filepattern(patt), m_run_n(0), m_configured(false), m_codec(eudaq::FrameCodec::Default()),
+   m_level(0), m_frame_bytes(1<<22), m_max_inflight(4), m_filebytes(0), m_exit(false){
+}
+
+NativeZFileWriter::~NativeZFileWriter(){
+  try{
+    CloseFile();
+  }catch (const eudaq::Exception &e){
+    EUDAQ_ERROR(std::string("NativeZFileWriter: ") + e.what());
+  }
+  std::unique_lock<std::mutex> lk(m_mx);
+  m_exit = true;
+  lk.unlock();
+  m_cv.notify_all();
+  for(auto &t: m_workers)
+    t.join();
+}
+
+void NativeZFileWriter::Configure(){
+  size_t n_threads = 2;
+  auto conf = GetConfiguration();
+  if(conf){
+    std::string codec = conf->Get("EUDAQ_FW_Z_CODEC", "");
+    if(!codec.empty())
+      m_codec = eudaq::FrameCodec::FromString(codec);
+    m_level = conf->Get("EUDAQ_FW_Z_LEVEL", m_level);
+    m_frame_bytes = conf->Get("EUDAQ_FW_Z_FRAME_BYTES", m_frame_bytes);
+    n_threads = conf->Get("EUDAQ_FW_Z_THREADS", n_threads);
+  }
+  m_max_inflight = 2 * n_threads + 1;
+  for(size_t i = 0; i < n_threads; i++)
+    m_workers.emplace_back(&NativeZFileWriter::Compressing, this);
+  m_configured = true;
+}
+
+void NativeZFileWriter::WriteEvent(eudaq::EventSPC ev) {
+  if(!m_configured)
+    Configure();
+  uint32_t run_n = ev->GetRunN();
+  if(!m_ser || m_run_n != run_n){
+    CloseFile();
+    std::time_t time_now = std::time(nullptr);
+    char time_buff[13];
+    time_buff[12] = 0;
+    std::strftime(time_buff, sizeof(time_buff),
+		  "%y%m%d%H%M%S", std::localtime(&time_now));
+    std::string time_str(time_buff);
+    m_ser.reset(new eudaq::FileSerializer((eudaq::FileNamer(m_filepattern).
+					   Set('X', ".rawz").
+					   Set('R', run_n).
+					   Set('D', time_str))));
+    m_ser->append(reinterpret_cast<const uint8_t*>(eudaq::FrameHeader::m_file_magic),
+		  sizeof(eudaq::FrameHeader::m_file_magic));
+    m_ser->write(eudaq::FrameHeader::m_file_version);
+    m_filebytes = m_ser->FileBytes();
+    m_run_n = run_n;
+  }
+  if(!m_frame){
+    m_frame = std::make_shared<Frame>();
+    m_frame->raw.reserve(m_frame_bytes + (m_frame_bytes>>3));
+    m_frame->header = eudaq::FrameHeader();
+    m_frame->header.event_first = ev->GetEventN();
+    m_frame->header.trigger_first = ev->GetTriggerN();
+    m_frame->header.ts_first = ev->GetTimestampBegin();
+    m_frame->done = false;
+  }
+  FrameSerializer ser(m_frame->raw);
+  ser.write(*ev);
+  auto &h = m_frame->header;
+  h.n_event++;
+  h.event_last = ev->GetEventN();
+  h.trigger_last = ev->GetTriggerN();
+  h.ts_last = ev->GetTimestampBegin();
+  if(m_frame->raw.size() >= m_frame_bytes)
+    SubmitFrame();
+}
+
+void NativeZFileWriter::SubmitFrame(){
+  if(!m_frame)
+    return;
+  std::shared_ptr<Frame> frame;
+  frame.swap(m_frame);
+  if(m_workers.empty()){
+    Compress(*frame);
+    std::unique_lock<std::mutex> lk(m_mx);
+    frame->done = true;
+    m_inflight.push_back(frame);
+    WriteDoneFrames();
+    return;
+  }
+  std::unique_lock<std::mutex> lk(m_mx);
+  // back-pressure: do not let the compression fall behind without limit
+  m_cv.wait(lk, [this](){return m_inflight.size() < m_max_inflight || !m_error.empty();});
+  if(!m_error.empty())
+    EUDAQ_THROW("NativeZFileWriter: " + m_error);
+  m_inflight.push_back(frame);
+  m_todo.push_back(frame);
+  lk.unlock();
+  m_cv.notify_all();
+}
+
+void NativeZFileWriter::Compress(Frame &frame){
+  frame.header.codec = m_codec;
+  frame.header.raw_bytes = frame.raw.size();
+  eudaq::FrameCodec::Compress(m_codec, m_level, frame.raw.data(), frame.raw.size(), frame.stored);
+  frame.header.stored_bytes = frame.stored.size();
+  std::vector<uint8_t>().swap(frame.raw);
+}
+
+// m_mx must be locked; frames are written in the order they were submitted
+void NativeZFileWriter::WriteDoneFrames(){
+  while(!m_inflight.empty() && m_inflight.front()->done){
+    auto &frame = m_inflight.front();
+    frame->header.Serialize(*m_ser);
+    m_ser->append(frame->stored.data(), frame->stored.size());
+    m_filebytes = m_ser->FileBytes();
+    m_inflight.pop_front();
+  }
+}
+
+void NativeZFileWriter::Compressing(){
+  std::unique_lock<std::mutex> lk(m_mx);
+  while(true){
+    m_cv.wait(lk, [this](){return !m_todo.empty() || m_exit;});
+    if(m_todo.empty())
+      break;
+    auto frame = m_todo.front();
+    m_todo.pop_front();
+    lk.unlock();
+    try{
+      Compress(*frame);
+      lk.lock();
+      frame->done = true;
+      WriteDoneFrames();
+    }catch (const std::exception &e){
+      if(!lk.owns_lock())
+	lk.lock();
+      m_error = e.what();
+    }
+    m_cv.notify_all();
+  }
+}
+
+void NativeZFileWriter::CloseFile(){
+  if(!m_ser)
+    return;
+  SubmitFrame();
+  std::unique_lock<std::mutex> lk(m_mx);
+  m_cv.wait(lk, [this](){return m_inflight.empty() || !m_error.empty();});
+  if(!m_error.empty())
+    EUDAQ_THROW("NativeZFileWriter: " + m_error);
+  m_ser->Flush();
+  m_ser.reset();
+}
+
+uint64_t NativeZFileWriter::FileBytes() const {
+  return m_filebytes;
+}
@@ -0,0 +1,109 @@
+#include "eudaq/PixelHits.hh"
+#include "eudaq/Exception.hh"
+
+namespace eudaq {
+  PixelHits::PixelHits(int columns)
+    : m_columns(uint32_t(columns) & (COL_VALUE | COL_TIME | COL_PIVOT)) {}
+
+  PixelHits::PixelHits(Deserializer &ds) {
+    ds.read(m_columns);
+    ds.read(m_x);
+    ds.read(m_y);
+    if (m_columns & COL_VALUE)
+      ds.read(m_value);
+    if (m_columns & COL_TIME)
+      ds.read(m_time);
+    if (m_columns & COL_PIVOT)
+      ds.read(m_pivot);
+    size_t n = m_x.size();
+    if (m_y.size() != n || ((m_columns & COL_VALUE) && m_value.size() != n) ||
+        ((m_columns & COL_TIME) && m_time.size() != n) ||
+        ((m_columns & COL_PIVOT) && m_pivot.size() != n))
+      EUDAQ_THROW("PixelHits: columns of different lengths");
+  }
+
+  void PixelHits::Serialize(Serializer &ser) const {
+    ser.write(m_columns);
+    ser.write(m_x);
+    ser.write(m_y);
+    if (m_columns & COL_VALUE)
+      ser.write(m_value);
+    if (m_columns & COL_TIME)
+      ser.write(m_time);
+    if (m_columns & COL_PIVOT)
+      ser.write(m_pivot);
+  }
+
+  size_t PixelHits::Bytes() const {
+    return m_x.capacity() * sizeof(uint16_t) + m_y.capacity() * sizeof(uint16_t) +
+      m_value.capacity() * sizeof(int32_t) + m_time.capacity() * sizeof(uint64_t) +
+      m_pivot.capacity() * sizeof(uint8_t);
+  }
+
+  void PixelHits::Reserve(size_t n) {
+    m_x.reserve(n);
+    m_y.reserve(n);
+    if (m_columns & COL_VALUE)
+      m_value.reserve(n);
+    if (m_columns & COL_TIME)
+      m_time.reserve(n);
+    if (m_columns & COL_PIVOT)
+      m_pivot.reserve(n);
+  }
+
+  void PixelHits::Resize(size_t n) {
+    m_x.resize(n);
+    m_y.resize(n);
+    if (m_columns & COL_VALUE)
+      m_value.resize(n);
+    if (m_columns & COL_TIME)
+      m_time.resize(n);
+    if (m_columns & COL_PIVOT)
+      m_pivot.resize(n);
+  }
+
+  void PixelHits::Clear() {
+    Resize(0);
+  }
+
+  void PixelHits::Append(size_t n, const uint16_t *x, const uint16_t *y, const int32_t *value,
+                         const uint64_t *time_ps, const uint8_t *pivot) {
+    m_x.insert(m_x.end(), x, x + n);
+    m_y.insert(m_y.end(), y, y + n);
+    if (m_columns & COL_VALUE) {
+      if (value)
+        m_value.insert(m_value.end(), value, value + n);
+      else
+        m_value.resize(m_value.size() + n, 1);
+    }
+    if (m_columns & COL_TIME) {
+      if (time_ps)
+        m_time.insert(m_time.end(), time_ps, time_ps + n);
+      else
+        m_time.resize(m_time.size() + n, 0);
+    }
+    if (m_columns & COL_PIVOT) {
+      if (pivot)
+        m_pivot.insert(m_pivot.end(), pivot, pivot + n);
+      else
+        m_pivot.resize(m_pivot.size() + n, 0);
+    }
+  }
+
+  void PixelHits::Set(size_t i, uint16_t x, uint16_t y, int32_t value, uint64_t time_ps, bool pivot) {
+    m_x.at(i) = x;
+    m_y[i] = y;
+    if (m_columns & COL_VALUE)
+      m_value[i] = value;
+    if (m_columns & COL_TIME)
+      m_time[i] = time_ps;
+    if (m_columns & COL_PIVOT)
+      m_pivot[i] = pivot;
+  }
+
+  void PixelHits::SetPivot(size_t i, bool pivot) {
+    if (!(m_columns & COL_PIVOT))
+      EUDAQ_THROW("PixelHits: no pivot column");
+    m_pivot.at(i) = pivot;
+  }
+}
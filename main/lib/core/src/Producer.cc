@@ -1,5 +1,6 @@
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Producer.hh"
+#include "eudaq/EventBatch.hh"
 
 namespace eudaq {
 
@@ -62,6 +63,8 @@ namespace eudaq {
       std::map<std::string, std::shared_ptr<DataSender>> senders;
       std::string dc_str = GetConfiguration()->Get("EUDAQ_DC", "");
       std::vector<std::string> col_dc_name = split(dc_str, ";,", true);
+      bool nodelay = GetConfiguration()->Get("EUDAQ_DATA_NODELAY", 0);
+      bool cork = GetConfiguration()->Get("EUDAQ_DATA_CORK", 0);
       std::string cur_backup = GetConfiguration()->GetCurrentSectionName();
       GetConfiguration()->SetSection("");
       for(auto &dc_name: col_dc_name){
@@ -70,6 +73,10 @@ namespace eudaq {
 	  senders[dc_addr]
 	    = std::unique_ptr<DataSender>(new DataSender("Producer", GetName()));
 	  senders[dc_addr]->Connect(dc_addr);
+	  if(nodelay)
+	    senders[dc_addr]->SetNoDelay(true);
+	  if(cork)
+	    senders[dc_addr]->SetCork(true);
 	}
       }
       GetConfiguration()->SetSection(cur_backup);
@@ -159,7 +166,8 @@ namespace eudaq {
     }
     ev->SetRunN(GetRunNumber());
     ev->SetEventN(m_evt_c);
-    m_evt_c ++;
+    // a batch takes the event numbers of all its triggers
+    m_evt_c += ev->IsFlagBatch() ? EventBatch(ev).Size() : 1;
     ev->SetDeviceN(m_pdc_n);
     std::unique_lock<std::mutex> lk(m_mtx_sender);
     auto senders = m_senders; //hold on the ptrs
@@ -22,7 +22,7 @@ namespace eudaq{
     }
 
     uint32_t id = ev->GetExtendWord();
-    auto cvt = Factory<StdEventConverter>::MakeUnique(id);
+    auto cvt = GetThreadInstance(id, d1->GetRunN(), conf);
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
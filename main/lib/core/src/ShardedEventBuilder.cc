@@ -0,0 +1,319 @@
+#include "eudaq/ShardedEventBuilder.hh"
+#include "eudaq/EventBatch.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+#include <chrono>
+
+namespace eudaq {
+
+  ShardedEventBuilder::ShardedEventBuilder(uint32_t key, const std::string &dspt,
+					   EventBuilder::Output out)
+    :m_key(key), m_dspt(dspt), m_out(out), m_trigger_mask(0xffffffff),
+     m_merge_any(false), m_merge_last(0), m_late_n(0){
+    if(m_key & EventBuilder::TIMESTAMP)
+      EUDAQ_THROW("ShardedEventBuilder: timestamp windows can not be sharded");
+    m_evb = MakeBuilder(m_out);
+  }
+
+  ShardedEventBuilder::~ShardedEventBuilder(){
+    StopShards();
+  }
+
+  std::unique_ptr<EventBuilder> ShardedEventBuilder::MakeBuilder(EventBuilder::Output out){
+    std::unique_ptr<EventBuilder> evb(new EventBuilder(m_key, m_dspt, out));
+    if(m_conf)
+      evb->Configure(*m_conf);
+    return evb;
+  }
+
+  void ShardedEventBuilder::Configure(const Configuration &conf){
+    StopShards();
+    m_conf.reset(new Configuration(conf));
+    m_evb = MakeBuilder(m_out);
+    m_trigger_mask = m_evb->TriggerMask();
+    m_counters.clear();
+    m_tg_epoch = EventBuilder::TriggerCounter();
+    m_merge_any = false;
+    m_late_n = 0;
+    uint32_t n = conf.Get("EUDAQ_EVB_SHARDS", 0);
+    if(n){
+      m_evb.reset();
+      StartShards(n);
+    }
+  }
+
+  void ShardedEventBuilder::StartShards(uint32_t n){
+    for(uint32_t i = 0; i < n; i++){
+      std::unique_ptr<Shard> sd(new Shard);
+      Shard *p = sd.get();
+      p->evb = MakeBuilder([p](EventUP ev){
+	  p->built.emplace_back(p->evb->LastKey(), std::move(ev));
+	});
+      p->floor = uint64_t(-1);
+      p->queued_floor = uint64_t(-1);
+      p->pending_n = 0;
+      p->partial_n = 0;
+      p->late_n = 0;
+      p->orphan_n = 0;
+      p->exit = false;
+      p->thread = std::thread(&ShardedEventBuilder::Running, this, p);
+      m_shards.push_back(std::move(sd));
+    }
+  }
+
+  void ShardedEventBuilder::StopShards(){
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      sd->exit = true;
+      lk.unlock();
+      sd->cv.notify_all();
+    }
+    for(auto &sd: m_shards)
+      if(sd->thread.joinable())
+	sd->thread.join();
+    m_shards.clear();
+  }
+
+  bool ShardedEventBuilder::HasStream(uint32_t id) const{
+    if(m_evb)
+      return m_evb->HasStream(id);
+    return m_counters.find(id) != m_counters.end();
+  }
+
+  void ShardedEventBuilder::AddStream(uint32_t id){
+    if(m_evb){
+      m_evb->AddStream(id);
+      return;
+    }
+    m_counters[id] = EventBuilder::TriggerCounter();
+    for(auto &sd: m_shards)
+      Post(*sd, Job{ADD, id, nullptr, 0});
+  }
+
+  void ShardedEventBuilder::RemoveStream(uint32_t id){
+    if(m_evb){
+      m_evb->RemoveStream(id);
+      return;
+    }
+    m_counters.erase(id);
+    for(auto &sd: m_shards)
+      Post(*sd, Job{END, id, nullptr, 0});
+  }
+
+  void ShardedEventBuilder::Push(uint32_t id, EventSPC ev){
+    if(m_evb){
+      m_evb->Push(id, std::move(ev));
+      return;
+    }
+    if(ev->IsFlagBatch()){
+      EventBatch batch(std::move(ev));
+      for(size_t i = 0; i < batch.Size(); i++)
+	Push(id, batch.Unpack(i));
+      return;
+    }
+    if(EventBuilder::IsEndMarker(m_key, *ev)){
+      RemoveStream(id);
+      return;
+    }
+    uint64_t key = EventBuilder::MakeKey(m_key, m_trigger_mask, m_counters[id], m_tg_epoch, *ev);
+    bool eore = ev->IsEORE();
+    Shard &sd = *m_shards[key % m_shards.size()];
+    Post(sd, Job{PUSH, id, std::move(ev), key});
+    if(eore){
+      // the other shards would wait for this stream forever
+      m_counters.erase(id);
+      for(auto &other: m_shards)
+	if(other.get() != &sd)
+	  Post(*other, Job{END, id, nullptr, 0});
+    }
+  }
+
+  void ShardedEventBuilder::Poll(){
+    // the shard threads expire their fragments on their own
+    if(m_evb)
+      m_evb->Poll();
+  }
+
+  void ShardedEventBuilder::Reset(){
+    std::unique_lock<std::mutex> lk(m_mx_merge);
+    m_merge_any = false;
+    m_late_n = 0;
+    lk.unlock();
+    if(m_evb){
+      m_evb->Reset();
+      return;
+    }
+    for(auto &c: m_counters)
+      c.second = EventBuilder::TriggerCounter();
+    m_tg_epoch = EventBuilder::TriggerCounter();
+    for(auto &sd: m_shards)
+      Post(*sd, Job{RESET, 0, nullptr, 0});
+  }
+
+  void ShardedEventBuilder::Post(Shard &sd, Job &&job){
+    std::unique_lock<std::mutex> lk(sd.mx);
+    if(job.type == PUSH){
+      // not built yet, but the merge must not pass this key
+      sd.floor = std::min(sd.floor, job.key);
+      sd.queued_floor = std::min(sd.queued_floor, job.key);
+    }
+    sd.jobs.push_back(std::move(job));
+    lk.unlock();
+    sd.cv.notify_one();
+  }
+
+  void ShardedEventBuilder::Running(Shard *sd){
+    std::vector<Job> jobs;
+    std::unique_lock<std::mutex> lk(sd->mx);
+    while(true){
+      sd->cv.wait_for(lk, std::chrono::milliseconds(100),
+		      [sd](){return !sd->jobs.empty() || sd->exit;});
+      if(sd->exit)
+	break;
+      jobs.swap(sd->jobs);
+      sd->queued_floor = uint64_t(-1);
+      lk.unlock();
+      bool reset = false;
+      for(auto &j: jobs){
+	try{
+	  if(j.type == PUSH)
+	    sd->evb->Push(j.id, std::move(j.ev), j.key);
+	  else if(j.type == ADD)
+	    sd->evb->AddStream(j.id);
+	  else if(j.type == END)
+	    sd->evb->RemoveStream(j.id);
+	  else{
+	    sd->evb->Reset();
+	    sd->built.clear();
+	    reset = true;
+	  }
+	}
+	catch(const std::exception &e){
+	  EUDAQ_ERROR(std::string("ShardedEventBuilder: ") + e.what());
+	}
+      }
+      jobs.clear();
+      sd->evb->Poll();
+      lk.lock();
+      if(reset)
+	sd->out.clear();
+      for(auto &b: sd->built)
+	sd->out.push_back(std::move(b));
+      sd->built.clear();
+      sd->floor = std::min(sd->evb->Floor(), sd->queued_floor);
+      sd->pending_n = sd->evb->PendingSize();
+      if(sd->partial_n != sd->evb->PartialCount()){
+	sd->partial_n = sd->evb->PartialCount();
+	sd->missing = sd->evb->MissingCounts();
+      }
+      sd->late_n = sd->evb->LateCount();
+      sd->orphan_n = sd->evb->OrphanCount();
+      lk.unlock();
+      Merge();
+      lk.lock();
+    }
+  }
+
+  void ShardedEventBuilder::Merge(){
+    std::unique_lock<std::mutex> lk(m_mx_merge);
+    while(true){
+      // a built event goes out once no shard can still produce a lower key
+      Shard *next = nullptr;
+      uint64_t low = uint64_t(-1);
+      bool built = false;
+      for(auto &sd: m_shards){
+	std::unique_lock<std::mutex> lk_sd(sd->mx);
+	bool has_out = !sd->out.empty();
+	uint64_t bound = has_out ? sd->out.front().first : sd->floor;
+	if(bound < low || (bound == low && has_out && !built)){
+	  next = sd.get();
+	  low = bound;
+	  built = has_out;
+	}
+      }
+      if(!next || !built)
+	break;
+      std::unique_lock<std::mutex> lk_next(next->mx);
+      uint64_t key = next->out.front().first;
+      EventUP ev = std::move(next->out.front().second);
+      next->out.pop_front();
+      lk_next.unlock();
+      if(m_merge_any && key < m_merge_last){
+	// forced out by a timeout after a higher key had been written
+	uint64_t n = ++m_late_n;
+	if(!(n & (n - 1)))
+	  EUDAQ_WARN("ShardedEventBuilder: " + std::to_string(n)
+		     + " events dropped for being out of order so far");
+	continue;
+      }
+      m_merge_any = true;
+      m_merge_last = key;
+      try{
+	m_out(std::move(ev));
+      }
+      catch(const std::exception &e){
+	EUDAQ_ERROR(std::string("ShardedEventBuilder: ") + e.what());
+      }
+    }
+  }
+
+  size_t ShardedEventBuilder::PendingSize(){
+    if(m_evb)
+      return m_evb->PendingSize();
+    size_t n = 0;
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      n += sd->pending_n;
+    }
+    return n;
+  }
+
+  uint64_t ShardedEventBuilder::PartialCount(){
+    if(m_evb)
+      return m_evb->PartialCount();
+    uint64_t n = 0;
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      n += sd->partial_n;
+    }
+    return n;
+  }
+
+  uint64_t ShardedEventBuilder::LateCount(){
+    if(m_evb)
+      return m_evb->LateCount();
+    std::unique_lock<std::mutex> lk_merge(m_mx_merge);
+    uint64_t n = m_late_n;
+    lk_merge.unlock();
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      n += sd->late_n;
+    }
+    return n;
+  }
+
+  uint64_t ShardedEventBuilder::OrphanCount(){
+    if(m_evb)
+      return m_evb->OrphanCount();
+    uint64_t n = 0;
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      n += sd->orphan_n;
+    }
+    return n;
+  }
+
+  std::map<uint32_t, uint64_t> ShardedEventBuilder::MissingCounts(){
+    if(m_evb)
+      return m_evb->MissingCounts();
+    std::map<uint32_t, uint64_t> missing;
+    for(auto &sd: m_shards){
+      std::unique_lock<std::mutex> lk(sd->mx);
+      for(auto &e: sd->missing)
+	missing[e.first] += e.second;
+    }
+    return missing;
+  }
+}
@@ -1,5 +1,7 @@
 #include "eudaq/StandardPlane.hh"
 
+#include <cmath>
+
 namespace eudaq{
   StandardPlane::StandardPlane()
     : m_id(0), m_xsize(0), m_ysize(0), m_flags(0),
@@ -20,6 +22,11 @@ namespace eudaq{
     ds.read(m_ysize);
     ds.read(m_flags);
     ds.read(m_pivotpixel);
+    if (IsCompact()) {
+      ds.read(m_hits);
+      ds.read(m_mat);
+      return;
+    }
     ds.read(m_pix);
     ds.read(m_x);
     ds.read(m_y);
@@ -36,6 +43,11 @@ namespace eudaq{
     ser.write(m_ysize);
     ser.write(m_flags);
     ser.write(m_pivotpixel);
+    if (IsCompact()) {
+      ser.write(m_hits);
+      ser.write(m_mat);
+      return;
+    }
     ser.write(m_pix);
     ser.write(m_x);
     ser.write(m_y);
@@ -50,6 +62,7 @@ namespace eudaq{
   }
 
   void StandardPlane::Print(std::ostream &os, size_t offset) const  {
+    SyncView();
     os << std::string(offset, ' ') << m_id << ", " << m_type << ":" << m_sensor << ", "
        << m_xsize << "x" << m_ysize << "x" << m_pix.size()
        << " (" << (m_pix.size() ? m_pix[0].size() : 0) << "), pivot=" << m_pivotpixel
@@ -64,7 +77,8 @@ namespace eudaq{
 
   void StandardPlane::SetSizeZS(uint32_t w, uint32_t h, uint32_t npix,
 				uint32_t frames, int flags) {
-    m_flags = flags | FLAG_ZS;
+    m_flags = (flags | FLAG_ZS) & ~FLAG_COMPACT;
+    m_hits.clear();
     // std::cout << "DBG flags " << hexdec(m_flags) << std::endl;
     m_xsize = w;
     m_ysize = h;
@@ -88,8 +102,95 @@ namespace eudaq{
     }
   }
 
+  void StandardPlane::SetSizeCompact(uint32_t w, uint32_t h, int columns,
+				     uint32_t frames, int flags) {
+    if (w > 0x10000 || h > 0x10000)
+      EUDAQ_THROW("Plane size " + to_string(w) + "x" + to_string(h) + " too large for a compact plane");
+    if (flags & FLAG_WITHPIVOT)
+      columns |= PixelHits::COL_PIVOT;
+    m_flags = flags | FLAG_ZS | FLAG_DIFFCOORDS | FLAG_COMPACT;
+    if (columns & PixelHits::COL_PIVOT)
+      m_flags |= FLAG_WITHPIVOT;
+    m_xsize = w;
+    m_ysize = h;
+    m_hits.assign(frames, PixelHits(columns));
+    m_pix.clear();
+    m_charge.clear();
+    m_x.clear();
+    m_y.clear();
+    m_time.clear();
+    m_pivot.clear();
+    m_view_valid = false;
+    m_result_pix = 0;
+    m_result_x = m_result_y = 0;
+    m_result_time = 0;
+  }
+
+  PixelHits &StandardPlane::Hits(uint32_t frame) {
+    if (frame >= m_hits.size())
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " of compact plane");
+    m_view_valid = false;
+    return m_hits[frame];
+  }
+
+  const PixelHits &StandardPlane::Hits(uint32_t frame) const {
+    if (frame >= m_hits.size())
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " of compact plane");
+    return m_hits[frame];
+  }
+
+  const PixelHits &StandardPlane::HitsAt(uint32_t index, uint32_t frame) const {
+    const PixelHits &hits = m_hits.at(frame);
+    if (index >= hits.Size())
+      throw std::out_of_range("StandardPlane: hit " + to_string(index) + " out of range");
+    return hits;
+  }
+
+  bool StandardPlane::DirectHits() const {
+    return IsCompact() && m_hits.size() == 1 && !NeedsCDS();
+  }
+
+  void StandardPlane::SyncView() const {
+    if (!IsCompact() || m_view_valid)
+      return;
+    size_t frames = m_hits.size();
+    m_pix.resize(frames);
+    m_charge.resize(frames);
+    m_x.resize(frames);
+    m_y.resize(frames);
+    m_time.resize(frames);
+    m_pivot.resize(GetFlags(FLAG_WITHPIVOT) ? frames : 0);
+    for (size_t f = 0; f < frames; ++f) {
+      const PixelHits &hits = m_hits[f];
+      size_t n = hits.Size();
+      m_x[f].assign(hits.XColumn().begin(), hits.XColumn().end());
+      m_y[f].assign(hits.YColumn().begin(), hits.YColumn().end());
+      m_pix[f].resize(n);
+      m_time[f].resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        m_pix[f][i] = hits.Value(i);
+        m_time[f][i] = hits.Time(i);
+      }
+      if (m_pivot.size()) {
+        m_pivot[f].resize(n);
+        for (size_t i = 0; i < n; ++i)
+          m_pivot[f][i] = hits.Pivot(i);
+      }
+    }
+    m_view_valid = true;
+  }
+
   void StandardPlane::PushPixelHelper(uint32_t x, uint32_t y, double p, uint64_t time_ps,
 				      bool pivot, uint32_t frame) {
+    if (IsCompact()) {
+      if (frame >= m_hits.size())
+        EUDAQ_THROW("Bad frame number " + to_string(frame) + " in PushPixel");
+      if (x > 0xffff || y > 0xffff)
+        EUDAQ_THROW("Pixel " + to_string(x) + "," + to_string(y) + " out of range of a compact plane");
+      m_hits[frame].Push(uint16_t(x), uint16_t(y), int32_t(std::lround(p)), time_ps, pivot);
+      m_view_valid = false;
+      return;
+    }
     if (frame > m_x.size())
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in PushPixel");
     m_x[frame].push_back(x);
@@ -104,6 +205,15 @@ namespace eudaq{
 
   void StandardPlane::SetPixelHelper(uint32_t index, uint32_t x, uint32_t y,
 				     double pix, uint64_t time_ps, bool pivot, uint32_t frame) {
+    if (IsCompact()) {
+      if (frame >= m_hits.size())
+        EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetPixel");
+      if (x > 0xffff || y > 0xffff)
+        EUDAQ_THROW("Pixel " + to_string(x) + "," + to_string(y) + " out of range of a compact plane");
+      m_hits[frame].Set(index, uint16_t(x), uint16_t(y), int32_t(std::lround(pix)), time_ps, pivot);
+      m_view_valid = false;
+      return;
+    }
     if (frame >= m_pix.size())
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetPixel");
     if (frame < m_x.size()) {
@@ -126,54 +236,77 @@ namespace eudaq{
   void StandardPlane::SetFlags(StandardPlane::FLAGS flags) { m_flags |= flags; }
 
   double StandardPlane::GetPixel(uint32_t index, uint32_t frame) const {
+    if (IsCompact())
+      return HitsAt(index, frame).Value(index);
     return m_pix.at(frame).at(index);
   }
   double StandardPlane::GetPixel(uint32_t index) const {
+    if (DirectHits())
+      return HitsAt(index, 0).Value(index);
     SetupResult();
     return m_result_pix->at(index);
   }
   double StandardPlane::GetCharge(uint32_t index, uint32_t frame) const {
+    if (IsCompact())
+      return -1;
     return m_charge.at(frame).size() > index ? m_charge.at(frame).at(index) : -1;
   }
   uint64_t StandardPlane::GetTimestamp(uint32_t index, uint32_t frame) const {
+      if (IsCompact())
+        return HitsAt(index, frame).Time(index);
       if (!GetFlags(FLAG_DIFFCOORDS))
         frame = 0;
       return m_time.at(frame).at(index);
   }
   uint64_t StandardPlane::GetTimestamp(uint32_t index) const {
+    if (DirectHits())
+      return HitsAt(index, 0).Time(index);
     SetupResult();
     return m_result_time->at(index);
   }
   double StandardPlane::GetX(uint32_t index, uint32_t frame) const {
+    if (IsCompact())
+      return HitsAt(index, frame).X(index);
     if (!GetFlags(FLAG_DIFFCOORDS))
       frame = 0;
     return m_x.at(frame).at(index);
   }
   double StandardPlane::GetX(uint32_t index) const {
+    if (DirectHits())
+      return HitsAt(index, 0).X(index);
     SetupResult();
     return m_result_x->at(index);
   }
   double StandardPlane::GetY(uint32_t index, uint32_t frame) const {
+    if (IsCompact())
+      return HitsAt(index, frame).Y(index);
     if (!GetFlags(FLAG_DIFFCOORDS))
       frame = 0;
     return m_y.at(frame).at(index);
   }
   double StandardPlane::GetY(uint32_t index) const {
+    if (DirectHits())
+      return HitsAt(index, 0).Y(index);
     SetupResult();
     return m_result_y->at(index);
   }
   bool StandardPlane::GetPivot(uint32_t index, uint32_t frame) const {
+    if (IsCompact())
+      return HitsAt(index, frame).Pivot(index);
     if (!GetFlags(FLAG_DIFFCOORDS))
       frame = 0;
     return m_pivot.at(frame).at(index);
   }
 
   void StandardPlane::SetPivot(uint32_t index, uint32_t frame, bool PivotFlag) {
+    if (IsCompact())
+      return Hits(frame).SetPivot(index, PivotFlag);
     m_pivot.at(frame).at(index) = PivotFlag;
   }
 
   const std::vector<StandardPlane::coord_t> &
   StandardPlane::XVector(uint32_t frame) const {
+    SyncView();
     return GetFrame(m_x, frame);
   }
 
@@ -184,6 +317,7 @@ namespace eudaq{
 
   const std::vector<StandardPlane::coord_t> &
   StandardPlane::YVector(uint32_t frame) const {
+    SyncView();
     return GetFrame(m_y, frame);
   }
 
@@ -194,6 +328,7 @@ namespace eudaq{
 
   const std::vector<StandardPlane::pixel_t> &
   StandardPlane::PixVector(uint32_t frame) const {
+    SyncView();
     return GetFrame(m_pix, frame);
   }
 
@@ -218,15 +353,21 @@ namespace eudaq{
 
   uint32_t StandardPlane::YSize() const { return m_ysize; }
 
-  uint32_t StandardPlane::NumFrames() const { return m_pix.size(); }
+  uint32_t StandardPlane::NumFrames() const {
+    return IsCompact() ? m_hits.size() : m_pix.size();
+  }
 
   uint32_t StandardPlane::TotalPixels() const { return m_xsize * m_ysize; }
 
   uint32_t StandardPlane::HitPixels(uint32_t frame) const {
+    if (IsCompact())
+      return m_hits.at(frame).Size();
     return GetFrame(m_pix, frame).size();
   }
 
   uint32_t StandardPlane::HitPixels() const {
+    if (DirectHits())
+      return m_hits[0].Size();
     SetupResult();
     return m_result_pix->size();
   }
@@ -248,6 +389,7 @@ namespace eudaq{
   }
 
   void StandardPlane::SetupResult() const {
+    SyncView();
     if (m_result_pix)
       return;
     m_result_x = &m_x[0];
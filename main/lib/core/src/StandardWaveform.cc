@@ -1,14 +1,23 @@
 #include "eudaq/StandardWaveform.hh"
+#include "eudaq/WaveformKernels.hh"
 #include <algorithm>
 #include "TF1.h"
 #include "TGraph.h"
 #include "TGraphErrors.h"
-#include <TMath.h>
 
 using namespace std;
 
 namespace eudaq {
 
+namespace {
+  // the samples from index min, checking min and max like at()
+  const float *samplesFrom(const std::vector<float> &samples, size_t min, size_t max) {
+    if (max >= samples.size())
+      throw std::out_of_range("StandardWaveform: sample " + std::to_string(max) + " out of range");
+    return &samples.at(min);
+  }
+}
+
 eudaq::StandardWaveform::StandardWaveform(unsigned id, const std::string &type, const std::string &sensor) : m_channelnumber(-1) {
   m_id = id;
   m_type = type;
@@ -48,11 +57,11 @@ unsigned StandardWaveform::ID() const {
 }
 
 float StandardWaveform::getMinInRange(int min, int max) const {
-  return (*min_element(&m_samples.at(min), &m_samples.at(max)));
+  return m_samples[getIndexMin(min, max)];
 }
 
 float StandardWaveform::getMaxInRange(int min, int max) const {
-  return (*max_element(&m_samples.at(min), &m_samples.at(max)));
+  return m_samples[getIndexMax(min, max)];
 }
 
 float StandardWaveform::getAbsMaxInRange(int min, int max) const {
@@ -61,14 +70,9 @@ float StandardWaveform::getAbsMaxInRange(int min, int max) const {
 
 float StandardWaveform::getIntegral(uint16_t min, uint16_t max, bool _abs) const {
   if (max > this->GetNSamples() - 1) max = uint16_t(this->GetNSamples() - 1);
-  if (min < 0) min = 0;
-  float integral = 0;
-  for (uint16_t i = min; i <= max; i++) {
-    if (!_abs)
-      integral += m_samples.at(i);
-    else
-      integral += std::abs(m_samples.at(i));
-  }
+  const float *s = samplesFrom(m_samples, min, max);
+  size_t n = max >= min ? max - min + 1 : 0;
+  float integral = _abs ? waveform::AbsSum(s, n) : waveform::Sum(s, n);
   return integral / (float) (max - (int) min);
 }
 
@@ -252,57 +256,42 @@ float StandardWaveform::getTriggerTime(std::vector<float> *tcal) const {
 }
 
 std::pair<uint16_t, float> StandardWaveform::getMaxPeak() const {
-  auto max = std::max_element(m_samples.begin(), m_samples.end());
-  auto min = std::min_element(m_samples.begin(), m_samples.end());
-  auto peak = (abs(int(*max)) > abs(int(*min))) ? max : min;
-  return std::make_pair(uint16_t(std::distance(m_samples.begin(), peak)), *peak);
+  size_t min, max;
+  waveform::MinMax(m_samples.data(), m_samples.size(), min, max);
+  size_t peak = (abs(int(m_samples.at(max))) > abs(int(m_samples.at(min)))) ? max : min;
+  return std::make_pair(uint16_t(peak), m_samples[peak]);
 }
 
 std::vector<uint16_t> *StandardWaveform::getAllPeaksAbove(uint16_t min, uint16_t max, float threshold) const {
-
   auto * peak_positions = new std::vector<uint16_t>;
-  uint16_t low(0), high;
-
-  for (auto j(min + 1); j <= max - 1; j++) {
-    float val = std::abs(m_samples.at(j));
-    //find point when waveform gets above threshold
-    if (val > threshold and std::abs(m_samples.at(uint16_t(j - 1))) < threshold)
-      low = j;
-    //find point when waveform gets below threshold and find max in between
-    if (val > threshold and std::abs(m_samples.at(uint16_t(j + 1))) < threshold) {
-      high = j;
-      // the peak has to have a certain width -> avoid spikes
-      if (high > low + 5) {
-        auto min_el = std::min_element(m_samples.begin() + low, m_samples.begin() + high);
-        auto max_el = std::max_element(m_samples.begin() + low, m_samples.begin() + high);
-        auto peak = (std::abs((*max_el)) > std::abs(*min_el)) ? max_el : min_el;
-        uint16_t pos = uint16_t(std::distance(m_samples.begin(), peak));
-        if (peak_positions->empty())
-          peak_positions->push_back(pos);
-          // value has to be at least in the next bunch
-        else if (pos > peak_positions->back() + 35)
-          peak_positions->push_back(pos);
-      }
-    }
-  }
+  getAllPeaksAbove(min, max, threshold, *peak_positions);
   return peak_positions;
 }
 
+void StandardWaveform::getAllPeaksAbove(uint16_t min, uint16_t max, float threshold, std::vector<uint16_t> &peaks) const {
+  // the pulses have to be wider than 5 samples to avoid spikes, a peak has to be in the next bunch
+  const float *s = samplesFrom(m_samples, min, max);
+  peaks.clear();
+  waveform::PeaksAbove(s, max >= min ? max - min + 1 : 0, threshold, peaks, 5, 35);
+  for (auto &p : peaks)
+    p += min;
+}
+
 float StandardWaveform::getMedian(uint32_t min, uint32_t max) const {
-  float median;
   uint32_t n = max >= min ? max - min + 1 : min - max + 1;
-  median = (float) TMath::Median(n, &m_samples.at(min));
-  return median;
+  return waveform::Median(&m_samples.at(min), n);
 }
 
 uint16_t StandardWaveform::getIndexMin(int min, int max) const {
-  float* min_el = std::min_element(&m_samples.at(min), &m_samples.at(max));
-  return uint16_t(std::distance(&m_samples.at(0),min_el));//-m_samples.begin();
+  size_t imin, imax;
+  waveform::MinMax(samplesFrom(m_samples, min, max), max > min ? max - min : 0, imin, imax);
+  return uint16_t(min + imin);
 }
 
 uint16_t StandardWaveform::getIndexMax(int min, int max) const {
-  float* max_el = std::max_element(&m_samples.at(min), &m_samples.at(max));
-  return uint16_t(std::distance(&m_samples.at(0),max_el));//-m_samples.begin();
+  size_t imin, imax;
+  waveform::MinMax(samplesFrom(m_samples, min, max), max > min ? max - min : 0, imin, imax);
+  return uint16_t(min + imax);
 }
 
 int StandardWaveform::getIndexAbsMax(int min, int max) const {
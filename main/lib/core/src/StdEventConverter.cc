@@ -1,4 +1,9 @@
 #include "eudaq/StdEventConverter.hh"
+#include "eudaq/Logger.hh"
+
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace eudaq{
 
@@ -6,6 +11,124 @@ namespace eudaq{
   std::map<uint32_t, typename Factory<StdEventConverter>::UP(*)()>&
   Factory<StdEventConverter>::Instance<>();
   
+  namespace{
+    struct ConverterSlot{
+      uint32_t id = 0;
+      bool used = false;
+      bool in_run = false;
+      uint32_t run_n = 0;
+      StdEventConverterUP cvt;
+    };
+
+    // Open addressing hash table of the converter instances of one thread,
+    // keyed by the converter id. Ids without converter are kept as well.
+    class ConverterCache{
+    public:
+      ConverterCache() :m_slots(16), m_n(0){};
+      ~ConverterCache(){
+	Clear();
+      }
+
+      ConverterSlot &Get(uint32_t id){
+	ConverterSlot *s = &Find(id);
+	if(!s->used){
+	  if(2 * (m_n + 1) > m_slots.size()){
+	    Grow();
+	    s = &Find(id);
+	  }
+	  s->used = true;
+	  s->id = id;
+	  s->cvt = Factory<StdEventConverter>::MakeUnique(id);
+	  m_n++;
+	}
+	return *s;
+      }
+
+      void Clear(){
+	for(auto &s: m_slots){
+	  if(s.in_run && s.cvt){
+	    try{
+	      s.cvt->EndRun();
+	    }catch(const std::exception &e){
+	      EUDAQ_ERROR(std::string("StdEventConverter: EndRun failed: ") + e.what());
+	    }
+	  }
+	}
+	std::vector<ConverterSlot>(16).swap(m_slots);
+	m_n = 0;
+      }
+
+    private:
+      ConverterSlot &Find(uint32_t id){
+	size_t mask = m_slots.size() - 1;
+	size_t i = ((id ^ (id >> 16)) * 0x45d9f3bu) & mask;
+	while(m_slots[i].used && m_slots[i].id != id)
+	  i = (i + 1) & mask;
+	return m_slots[i];
+      }
+
+      void Grow(){
+	std::vector<ConverterSlot> old(m_slots.size() * 2);
+	old.swap(m_slots);
+	for(auto &s: old)
+	  if(s.used)
+	    Find(s.id) = std::move(s);
+      }
+
+      std::vector<ConverterSlot> m_slots;
+      size_t m_n;
+    };
+
+    ConverterCache &ThreadCache(){
+      thread_local ConverterCache cache;
+      return cache;
+    }
+  }
+
+  StdEventConverter *StdEventConverter::GetThreadInstance(uint32_t id, uint32_t run_n, ConfigurationSPC conf){
+    auto &s = ThreadCache().Get(id);
+    if(!s.cvt)
+      return nullptr;
+    // the hooks may convert events themselves, which may move the slot
+    StdEventConverter *cvt = s.cvt.get();
+    if(!s.in_run || s.run_n != run_n){
+      bool end = s.in_run;
+      s.in_run = true;
+      s.run_n = run_n;
+      if(end)
+	cvt->EndRun();
+      cvt->BeginRun(run_n, conf);
+    }
+    return cvt;
+  }
+
+  void StdEventConverter::ReleaseThreadInstances(){
+    ThreadCache().Clear();
+  }
+
+  bool StdEventConverter::FindStateStream(EventSPC ev, uint32_t &stream){
+    static std::mutex mx;
+    static std::map<uint32_t, bool> keeps_state;
+    if(!ev->IsFlagPacket()){
+      uint32_t id = ev->GetType();
+      std::unique_lock<std::mutex> lk(mx);
+      auto it = keeps_state.find(id);
+      if(it == keeps_state.end()){
+	auto cvt = Factory<StdEventConverter>::MakeUnique(id);
+	it = keeps_state.emplace(id, cvt && cvt->KeepsStreamState()).first;
+      }
+      if(it->second){
+	stream = ev->GetStreamN();
+	return true;
+      }
+    }
+    size_t nsub = ev->GetNumSubEvent();
+    for(size_t i = 0; i < nsub; i++)
+      if(FindStateStream(ev->GetSubEvent(i), stream))
+	return true;
+    return false;
+  }
+
   bool StdEventConverter::Convert(EventSPC d1, StdEventSP d2, ConfigurationSPC conf){
 
     if(d1->IsFlagFake()){
@@ -42,7 +165,7 @@ namespace eudaq{
       d2->SetDescription(d1->GetDescription());
     }
     uint32_t id = d1->GetType();
-    auto cvt = Factory<StdEventConverter>::MakeUnique(id);
+    auto cvt = GetThreadInstance(id, d1->GetRunN(), conf);
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
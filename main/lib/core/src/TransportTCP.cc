@@ -46,12 +46,22 @@ at some places we have constructions like:
 #include "eudaq/Logger.hh"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #if EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW)
 #include "TransportTCP_WIN32.hh"
 #pragma comment(lib, "Ws2_32.lib")
 #else
 #include "TransportTCP_POSIX.hh"
+#include <poll.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#if EUDAQ_PLATFORM_IS(LINUX)
+#include <sys/epoll.h>
 #endif
 
 // print debug messages that are optimized out if DEBUG_TRANSPORT is not set:
@@ -80,8 +90,17 @@ namespace eudaq {
   
   namespace {
     static const int MAXPENDING = 16;
-    static const int MAX_BUFFER_SIZE = 10000;
+    static const int MAX_BUFFER_SIZE = 65536;
+    static const int MAX_EPOLL_EVENTS = 64;
     static int to_int(char c) { return static_cast<unsigned char>(c); }
+    // poll()/epoll_wait() take milliseconds, round up so that short
+    // timeouts do not turn into a busy loop
+    static int to_msec(const Time &t) {
+      timeval tv = t;
+      if (tv.tv_sec < 0)
+        return 0;
+      return static_cast<int>(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000);
+    }
 #ifdef MSG_NOSIGNAL
     // On Linux (and cygwin?) send(...) can be told to
     // ignore signals by setting the flag below
@@ -99,6 +118,71 @@ namespace eudaq {
     }
 #endif
 
+#if !(EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW))
+    // sends the length header and the payload with one sendmsg() call,
+    // neither is copied and small packets do not need a second syscall
+    static void do_send_packet(SOCKET sock, const unsigned char *data,
+                               size_t length){
+      unsigned char header[4];
+      size_t len = length;
+      for (int i = 0; i < 4; ++i) {
+        header[i] = static_cast<unsigned char>(len & 0xff);
+        len >>= 8;
+      }
+      iovec iov[2];
+      iov[0].iov_base = header;
+      iov[0].iov_len = sizeof header;
+      iov[1].iov_base = const_cast<unsigned char *>(data);
+      iov[1].iov_len = length;
+      msghdr msg;
+      std::memset(&msg, 0, sizeof msg);
+      msg.msg_iov = iov;
+      msg.msg_iovlen = length ? 2 : 1;
+      size_t remain = length + sizeof header;
+      while (remain) {
+        ssize_t result = sendmsg(sock, &msg, FLAGS);
+        if (result > 0) {
+          remain -= result;
+          size_t done = result;
+          while (msg.msg_iovlen && done >= msg.msg_iov->iov_len) {
+            done -= msg.msg_iov->iov_len;
+            ++msg.msg_iov;
+            --msg.msg_iovlen;
+          }
+          if (done) {
+            msg.msg_iov->iov_base =
+                static_cast<char *>(msg.msg_iov->iov_base) + done;
+            msg.msg_iov->iov_len -= done;
+          }
+        }
+        else if (result < 0 &&
+                 LastSockError() == EUDAQ_ERROR_Resource_temp_unavailable) {
+          // socket buffer is full, sleep until the peer has drained it
+          pollfd pfd;
+          pfd.fd = sock;
+          pfd.events = POLLOUT;
+          pfd.revents = 0;
+          poll(&pfd, 1, 1000);
+        }
+        else if (result < 0 &&
+                 LastSockError() == EUDAQ_ERROR_Interrupted_function_call) {
+          // continue
+        }
+        else if (result == 0) {
+          EUDAQ_THROW_NOLOG("TransportTCP:: Connection reset by peer");
+        }
+        else {
+          EUDAQ_THROW_NOLOG(LastSockErrorString("TransportTCP:: Error sending data"));
+        }
+      }
+    }
+
+    static void set_tcp_option(SOCKET sock, int opt, bool enable) {
+      int val = enable;
+      if (setsockopt(sock, IPPROTO_TCP, opt, &val, sizeof val))
+        EUDAQ_THROW_NOLOG(LastSockErrorString("TransportTCP:: Failed to set socket option"));
+    }
+#else
     static void do_send_data(SOCKET sock, const unsigned char *data,
                              size_t len) {
       size_t sent = 0;
@@ -147,6 +231,31 @@ namespace eudaq {
       }
     }
 
+    static void set_tcp_option(SOCKET sock, int opt, bool enable) {
+      BOOL val = enable;
+      setsockopt(sock, IPPROTO_TCP, opt, reinterpret_cast<const char *>(&val),
+                 sizeof val);
+    }
+#endif
+
+    // waits until sock becomes readable, returns false on timeout
+    static bool wait_readable(SOCKET sock, const Time &timeout) {
+#if EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW)
+      fd_set tempset;
+      FD_ZERO(&tempset);
+      FD_SET(sock, &tempset);
+      timeval timeremain = timeout;
+      return select(static_cast<int>(sock + 1), &tempset, NULL, NULL,
+                    &timeremain) > 0;
+#else
+      pollfd pfd;
+      pfd.fd = sock;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      return poll(&pfd, 1, to_msec(timeout)) > 0;
+#endif
+    }
+
   } // anonymous namespace
 
   bool ConnectionInfoTCP::Matches(const ConnectionInfo &other) const {
@@ -165,19 +274,41 @@ namespace eudaq {
   }
 
   void ConnectionInfoTCP::append(size_t length, const char *data) {
-    m_buf += std::string(data, length);
+    std::memcpy(recvbuffer(length), data, length);
+    recvcommit(length);
+  }
+
+  char *ConnectionInfoTCP::recvbuffer(size_t length) {
+    if (m_buf.size() - m_tail < length) {
+      // only the tail of a partial packet is left, move it to the front
+      if (m_head) {
+        if (m_tail > m_head)
+          std::memmove(&m_buf[0], &m_buf[m_head], m_tail - m_head);
+        m_tail -= m_head;
+        m_head = 0;
+      }
+      if (m_buf.size() - m_tail < length)
+        m_buf.resize(std::max(m_tail + length, m_buf.size() * 2));
+    }
+    return &m_buf[m_tail];
+  }
+
+  void ConnectionInfoTCP::recvcommit(size_t length) {
+    m_tail += length;
     update_length();
   }
 
   bool ConnectionInfoTCP::havepacket() const {
-    return m_buf.length() >= m_len + 4;
+    return m_tail - m_head >= m_len + 4;
   }
 
   std::string ConnectionInfoTCP::getpacket() {
     if (!havepacket())
       EUDAQ_THROW_NOLOG("TransprotTCP:: No packet available");
-    std::string packet(m_buf, 4, m_len);
-    m_buf.erase(0, m_len + 4);
+    std::string packet(&m_buf[m_head + 4], m_len);
+    m_head += m_len + 4;
+    if (m_head == m_tail)
+      m_head = m_tail = 0;
     update_length(true);
     return packet;
   }
@@ -185,9 +316,9 @@ namespace eudaq {
   void ConnectionInfoTCP::update_length(bool force) {
     if (force || m_len == 0) {
       m_len = 0;
-      if (m_buf.length() >= 4) {
+      if (m_tail - m_head >= 4) {
         for (int i = 0; i < 4; ++i) {
-          m_len |= to_int(m_buf[i]) << (8 * i);
+          m_len |= to_int(m_buf[m_head + i]) << (8 * i);
         }
       }
     }
@@ -195,13 +326,10 @@ namespace eudaq {
 
   TCPServer::TCPServer(const std::string &param)
       : m_port(from_string(param, 0)),
-        m_srvsock(socket(PF_INET, SOCK_STREAM, IPPROTO_TCP)),
-        m_maxfd(m_srvsock) {
+        m_srvsock(socket(PF_INET, SOCK_STREAM, IPPROTO_TCP)) {
     if (m_srvsock == (SOCKET)-1)
       EUDAQ_THROW_NOLOG(LastSockErrorString("TCPServer:: Failed to create socket")); //$$ check if (SOCKET)-1 is correct
     setup_signal();
-    FD_ZERO(&m_fdset);
-    FD_SET(m_srvsock, &m_fdset);
 
     setup_socket(m_srvsock);
 
@@ -226,6 +354,25 @@ namespace eudaq {
       EUDAQ_THROW_NOLOG(
           LastSockErrorString("Failed to listen on socket: " + param));
     }
+#if EUDAQ_PLATFORM_IS(LINUX)
+    m_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epfd < 0) {
+      closesocket(m_srvsock);
+      EUDAQ_THROW_NOLOG(LastSockErrorString("TCPServer:: Failed to create epoll instance"));
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = m_srvsock;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_srvsock, &ev)) {
+      close(m_epfd);
+      closesocket(m_srvsock);
+      EUDAQ_THROW_NOLOG(LastSockErrorString("TCPServer:: Failed to watch socket"));
+    }
+#else
+    m_maxfd = m_srvsock;
+    FD_ZERO(&m_fdset);
+    FD_SET(m_srvsock, &m_fdset);
+#endif
   }
 
   TCPServer::~TCPServer() {
@@ -235,6 +382,9 @@ namespace eudaq {
       }
     }
     closesocket(m_srvsock);
+#if EUDAQ_PLATFORM_IS(LINUX)
+    close(m_epfd);
+#endif
   }
 
   std::shared_ptr<ConnectionInfoTCP> TCPServer::GetInfo(SOCKET fd) const {
@@ -261,7 +411,11 @@ namespace eudaq {
     for(auto &conn: m_conn){
       if(conn && id.Matches(*conn)){
           SOCKET fd = conn->GetFd();
+#if EUDAQ_PLATFORM_IS(LINUX)
+          epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, NULL);
+#else
           FD_CLR(fd, &m_fdset);
+#endif
           closesocket(fd);
 	  conn.reset();
       }	
@@ -279,6 +433,83 @@ namespace eudaq {
     }
   }
 
+  void TCPServer::AcceptConnection() {
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    SOCKET peersock = accept(static_cast<int>(m_srvsock), (sockaddr *)&addr, &len);
+    if (peersock == INVALID_SOCKET) {
+      if (LastSockError() == EUDAQ_ERROR_Resource_temp_unavailable ||
+          LastSockError() == EUDAQ_ERROR_Interrupted_function_call)
+        return;
+      EUDAQ_THROW_NOLOG(LastSockErrorString("Error in accept()"));
+    }
+#if EUDAQ_PLATFORM_IS(LINUX)
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = peersock;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, peersock, &ev)) {
+      closesocket(peersock);
+      EUDAQ_THROW_NOLOG(LastSockErrorString("Error in epoll_ctl()"));
+    }
+#else
+    FD_SET(peersock, &m_fdset);
+    m_maxfd = (m_maxfd < peersock) ? peersock : m_maxfd;
+#endif
+    setup_socket(peersock);
+    std::string host = inet_ntoa(addr.sin_addr);
+    host = "tcp://"+host+":" + to_string(ntohs(addr.sin_port));
+    auto conn_new = std::make_shared<ConnectionInfoTCP>(peersock, host);
+    bool inserted = false;
+    for(auto &conn: m_conn) {
+      if(!conn) {
+        conn = conn_new;
+        inserted = true;
+        break;
+      }
+    }
+    if (!inserted)
+      m_conn.push_back(conn_new);
+    m_events.push(TransportEvent(TransportEvent::CONNECT, conn_new));
+  }
+
+  bool TCPServer::ReceiveFrom(SOCKET j) {
+    auto m = GetInfo(j);
+    if (!m)
+      return false;
+    // receive straight into the connection buffer, no intermediate copy
+    char *buffer = m->recvbuffer(MAX_BUFFER_SIZE);
+    int result;
+    do {
+      result = recv(j, buffer, MAX_BUFFER_SIZE, 0);
+    } while (result == EUDAQ_ERROR_NO_DATA_RECEIVED &&
+             LastSockError() == EUDAQ_ERROR_Interrupted_function_call);
+
+    bool received = false;
+    if (result > 0) {
+      m->recvcommit(result);
+      while (m->havepacket()) {
+        received = true;
+        m_events.push(
+            TransportEvent(TransportEvent::RECEIVE, m, m->getpacket()));
+      }
+    }
+    else if (result == 0) {
+      debug_transport(
+          "Server #%d, return=%d, WSAError:%d (%s) Disconnected.\n", j,
+          result, errno, strerror(errno));
+      m_events.push(TransportEvent(TransportEvent::DISCONNECT, m));
+      Close(*m);
+    } else if (result == EUDAQ_ERROR_NO_DATA_RECEIVED) {
+      debug_transport(
+          "Server #%d, return=%d, WSAError:%d (%s) No Data Received.\n",
+          j, result, errno, strerror(errno));
+    } else {
+      debug_transport("Server #%d, return=%d, WSAError:%d (%s) \n", j,
+                      result, errno, strerror(errno));
+    }
+    return received;
+  }
+
   void TCPServer::ProcessEvents(int timeout) {
 #if DEBUG_NOTIMEOUT == 0
     Time t_start = Time::Current(); /*t_curr = t_start,*/
@@ -286,6 +517,27 @@ namespace eudaq {
     Time t_remain = Time(0, timeout);
     bool done = false;
     do {
+#if EUDAQ_PLATFORM_IS(LINUX)
+      epoll_event events[MAX_EPOLL_EVENTS];
+      int result = epoll_wait(m_epfd, events, MAX_EPOLL_EVENTS,
+                              to_msec(t_remain));
+      if (result < 0 &&
+          LastSockError() != EUDAQ_ERROR_Interrupted_function_call) {
+        EUDAQ_THROW_NOLOG(LastSockErrorString("Error in epoll_wait()"));
+      }
+      // accept after the reads: a descriptor closed in this round may be
+      // handed out again by accept() and must not match a stale event
+      bool pending_accept = false;
+      for (int i = 0; i < result; ++i) {
+        SOCKET j = events[i].data.fd;
+        if (j == m_srvsock)
+          pending_accept = true;
+        else if (ReceiveFrom(j))
+          done = true;
+      }
+      if (pending_accept)
+        AcceptConnection();
+#else
       fd_set tempset;
       memcpy(&tempset, &m_fdset, sizeof(tempset));
       timeval timeremain = t_remain;
@@ -297,72 +549,16 @@ namespace eudaq {
                  LastSockError() != EUDAQ_ERROR_Interrupted_function_call) {
         EUDAQ_THROW_NOLOG(LastSockErrorString("Error in select()"));
       } else if (result > 0) {
-
         if (FD_ISSET(m_srvsock, &tempset)) {
-          sockaddr_in addr;
-          socklen_t len = sizeof(addr);
-          SOCKET peersock = accept(static_cast<int>(m_srvsock), (sockaddr *)&addr, &len);
-          if (peersock == INVALID_SOCKET) {
-	    EUDAQ_THROW_NOLOG(LastSockErrorString("Error in accept()"));
-          }
-	  else {
-            FD_SET(peersock, &m_fdset);
-            m_maxfd = (m_maxfd < peersock) ? peersock : m_maxfd;
-            setup_socket(peersock);
-            std::string host = inet_ntoa(addr.sin_addr);
-            host = "tcp://"+host+":" + to_string(ntohs(addr.sin_port));
-            auto conn_new = std::make_shared<ConnectionInfoTCP>(peersock, host);
-            bool inserted = false;
-            for(auto &conn: m_conn) {
-              if(!conn) {
-                conn = conn_new;
-                inserted = true;
-		break;
-              }
-            }
-            if (!inserted)
-              m_conn.push_back(conn_new);
-            m_events.push(TransportEvent(TransportEvent::CONNECT, conn_new));
-            FD_CLR(m_srvsock, &tempset);
-          }
+          AcceptConnection();
+          FD_CLR(m_srvsock, &tempset);
         }
         for (SOCKET j = 0; j < m_maxfd + 1; j++) {
-          if (FD_ISSET(j, &tempset)) {
-            char buffer[MAX_BUFFER_SIZE + 1];
-
-            do {
-              result = recv(j, buffer, MAX_BUFFER_SIZE, 0);
-            } while (result == EUDAQ_ERROR_NO_DATA_RECEIVED &&
-                     LastSockError() == EUDAQ_ERROR_Interrupted_function_call);
-
-            if (result > 0) {
-              buffer[result] = 0;
-	      auto m = GetInfo(j);
-              m->append(result, buffer);
-              while (m->havepacket()) {
-                done = true;
-                m_events.push(
-                    TransportEvent(TransportEvent::RECEIVE, m, m->getpacket()));
-              }
-            }
-            else if (result == 0) {
-              debug_transport(
-                  "Server #%d, return=%d, WSAError:%d (%s) Disconnected.\n", j,
-                  result, errno, strerror(errno));
-	      auto m = GetInfo(j);
-              m_events.push(TransportEvent(TransportEvent::DISCONNECT, m));
-	      Close(*m);
-            } else if (result == EUDAQ_ERROR_NO_DATA_RECEIVED) {
-              debug_transport(
-                  "Server #%d, return=%d, WSAError:%d (%s) No Data Received.\n",
-                  j, result, errno, strerror(errno));
-            } else {
-              debug_transport("Server #%d, return=%d, WSAError:%d (%s) \n", j,
-                              result, errno, strerror(errno));
-            }
-          }
+          if (FD_ISSET(j, &tempset) && ReceiveFrom(j))
+            done = true;
         }
       }
+#endif
 
 // optionally disable timeout at compile time by setting DEBUG_NOTIMEOUT to 1
 #if DEBUG_NOTIMEOUT
@@ -388,7 +584,8 @@ namespace eudaq {
   TCPClient::TCPClient(const std::string &param)
       : m_server(param), m_port(44000),
         m_sock(socket(PF_INET, SOCK_STREAM, IPPROTO_TCP)),
-        m_buf(std::make_shared<ConnectionInfoTCP>(m_sock, param)) {
+        m_buf(std::make_shared<ConnectionInfoTCP>(m_sock, param)),
+        m_cork(false) {
     if (m_sock == (SOCKET)-1)
       EUDAQ_THROW_NOLOG(LastSockErrorString(
           "Failed to create socket")); //$$ check if (SOCKET)-1 is correct
@@ -435,6 +632,27 @@ namespace eudaq {
     }
   }
 
+  void TCPClient::SetNoDelay(bool enable) {
+    set_tcp_option(m_sock, TCP_NODELAY, enable);
+  }
+
+  void TCPClient::SetCork(bool enable) {
+#if defined(TCP_CORK)
+    set_tcp_option(m_sock, TCP_CORK, enable);
+#elif defined(TCP_NOPUSH)
+    set_tcp_option(m_sock, TCP_NOPUSH, enable);
+#endif
+    m_cork = enable;
+  }
+
+  void TCPClient::Flush() {
+    // uncorking pushes out the pending partial frame
+    if (m_cork) {
+      SetCork(false);
+      SetCork(true);
+    }
+  }
+
   void TCPClient::ProcessEvents(int timeout) {
 #if DEBUG_NOTIMEOUT == 0
     Time t_start = Time::Current(); /*t_curr = t_start,*/
@@ -442,16 +660,11 @@ namespace eudaq {
     Time t_remain = Time(0, timeout);
     bool done = false;
     do {
-      fd_set tempset;
-      FD_ZERO(&tempset);
-      FD_SET(m_sock, &tempset);
-      timeval timeremain = t_remain;
-      auto result = select(static_cast<int>(m_sock + 1), &tempset, NULL, NULL,
-			   &timeremain);
+      wait_readable(m_sock, t_remain);
       bool donereading = false;
       do {
-        char buffer[MAX_BUFFER_SIZE + 1];
-
+        char *buffer = m_buf->recvbuffer(MAX_BUFFER_SIZE);
+        int result;
         do {
           result = recv(m_sock, buffer, MAX_BUFFER_SIZE, 0);
         } while (result == EUDAQ_ERROR_NO_DATA_RECEIVED &&
@@ -472,7 +685,7 @@ namespace eudaq {
           EUDAQ_THROW_NOLOG(LastSockErrorString(
               "SocketClient Error (" + to_string(LastSockError()) + ")"));
         } else if (result > 0) {
-          m_buf->append(result, buffer);
+          m_buf->recvcommit(result);
           while (m_buf->havepacket()) {
             m_events.push(TransportEvent(TransportEvent::RECEIVE, m_buf,
                                          m_buf->getpacket()));
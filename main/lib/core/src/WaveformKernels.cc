@@ -0,0 +1,465 @@
+#include "eudaq/WaveformKernels.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define EUDAQ_WAVEFORM_X86
+#include <immintrin.h>
+#define EUDAQ_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace eudaq{
+  namespace waveform{
+    namespace{
+      std::atomic<int> max_isa(int(Isa::AVX2));
+
+      Isa CpuIsa(){
+#ifdef EUDAQ_WAVEFORM_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+          return Isa::AVX2;
+        if(__builtin_cpu_supports("sse2"))
+          return Isa::SSE2;
+#endif
+        return Isa::SCALAR;
+      }
+
+      unsigned Ctz(uint64_t w){
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_ctzll(w));
+#else
+        unsigned i = 0;
+        for(; !(w & 1); w >>= 1)
+          i++;
+        return i;
+#endif
+      }
+
+      unsigned Clz32(uint32_t w){
+#if defined(__GNUC__) || defined(__clang__)
+        return unsigned(__builtin_clz(w));
+#else
+        unsigned i = 0;
+        for(; !(w & 0x80000000u); w <<= 1)
+          i++;
+        return i;
+#endif
+      }
+
+      bool Crossed(float a, float b, float t, bool rising){
+        return rising ? (a < t && t <= b) : (a > t && t >= b);
+      }
+
+      // Scalar kernels, also for the samples left over by the vector ones
+
+      float SumScalar(const float *s, size_t n, bool absolute){
+        float sum = 0;
+        for(size_t i = 0; i < n; i++)
+          sum += absolute ? std::fabs(s[i]) : s[i];
+        return sum;
+      }
+
+      void MinMaxScalar(const float *s, size_t n, size_t &imin, size_t &imax){
+        imin = imax = 0;
+        for(size_t i = 1; i < n; i++){
+          if(s[i] < s[imin])
+            imin = i;
+          if(s[imax] < s[i])
+            imax = i;
+        }
+      }
+
+      size_t FindScalar(const float *s, size_t from, size_t n, float v){
+        for(size_t i = from; i < n; i++)
+          if(s[i] == v)
+            return i;
+        return n;
+      }
+
+      // first crossing in [max(from, 1), n), 0 if none
+      size_t CrossingScalar(const float *s, size_t from, size_t n, float t, bool rising){
+        for(size_t i = std::max<size_t>(from, 1); i < n; i++)
+          if(Crossed(s[i-1], s[i], t, rising))
+            return i;
+        return 0;
+      }
+
+      // last crossing in [1, to), 0 if none
+      size_t LastCrossingScalar(const float *s, size_t to, float t, bool rising){
+        for(size_t i = to; i-- > 1;)
+          if(Crossed(s[i-1], s[i], t, rising))
+            return i;
+        return 0;
+      }
+
+      // bit i of above/below: |s[i]| above/below t, the words are zeroed
+      void MasksScalar(const float *s, size_t from, size_t n, float t, uint64_t *above, uint64_t *below){
+        for(size_t i = from; i < n; i++){
+          float v = std::fabs(s[i]);
+          if(v > t)
+            above[i/64] |= uint64_t(1) << (i%64);
+          if(v < t)
+            below[i/64] |= uint64_t(1) << (i%64);
+        }
+      }
+
+#ifdef EUDAQ_WAVEFORM_X86
+      // AVX2, 8 samples per instruction
+
+      EUDAQ_TARGET("avx2") float SumAvx2(const float *s, size_t n, bool absolute){
+        const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for(; i + 16 <= n; i += 16){
+          __m256 v0 = _mm256_loadu_ps(s + i), v1 = _mm256_loadu_ps(s + i + 8);
+          if(absolute){
+            v0 = _mm256_and_ps(v0, mask);
+            v1 = _mm256_and_ps(v1, mask);
+          }
+          a0 = _mm256_add_ps(a0, v0);
+          a1 = _mm256_add_ps(a1, v1);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, _mm256_add_ps(a0, a1));
+        float sum = 0;
+        for(float l: lanes)
+          sum += l;
+        return sum + SumScalar(s + i, n - i, absolute);
+      }
+
+      EUDAQ_TARGET("avx2") size_t FindAvx2(const float *s, size_t n, float v){
+        const __m256 vv = _mm256_set1_ps(v);
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8){
+          int bits = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(s + i), vv, _CMP_EQ_OQ));
+          if(bits)
+            return i + Ctz(uint64_t(bits));
+        }
+        return FindScalar(s, i, n, v);
+      }
+
+      EUDAQ_TARGET("avx2") void MinMaxAvx2(const float *s, size_t n, size_t &imin, size_t &imax){
+        if(n < 16)
+          return MinMaxScalar(s, n, imin, imax);
+        __m256 mn = _mm256_loadu_ps(s), mx = mn;
+        size_t i = 8;
+        for(; i + 8 <= n; i += 8){
+          __m256 v = _mm256_loadu_ps(s + i);
+          mn = _mm256_min_ps(mn, v);
+          mx = _mm256_max_ps(mx, v);
+        }
+        float lmin[8], lmax[8];
+        _mm256_storeu_ps(lmin, mn);
+        _mm256_storeu_ps(lmax, mx);
+        float vmin = *std::min_element(lmin, lmin + 8), vmax = *std::max_element(lmax, lmax + 8);
+        for(; i < n; i++){
+          vmin = std::min(vmin, s[i]);
+          vmax = std::max(vmax, s[i]);
+        }
+        // the first samples with these values
+        imin = FindAvx2(s, n, vmin);
+        imax = FindAvx2(s, n, vmax);
+      }
+
+      EUDAQ_TARGET("avx2") __m256 CrossedAvx2(const float *s, size_t i, __m256 vt, bool rising){
+        __m256 a = _mm256_loadu_ps(s + i - 1), b = _mm256_loadu_ps(s + i);
+        return rising ?
+          _mm256_and_ps(_mm256_cmp_ps(a, vt, _CMP_LT_OQ), _mm256_cmp_ps(vt, b, _CMP_LE_OQ)) :
+          _mm256_and_ps(_mm256_cmp_ps(a, vt, _CMP_GT_OQ), _mm256_cmp_ps(vt, b, _CMP_GE_OQ));
+      }
+
+      EUDAQ_TARGET("avx2") size_t CrossingAvx2(const float *s, size_t n, float t, bool rising){
+        const __m256 vt = _mm256_set1_ps(t);
+        size_t i = 1;
+        for(; i + 8 <= n; i += 8){
+          int bits = _mm256_movemask_ps(CrossedAvx2(s, i, vt, rising));
+          if(bits)
+            return i + Ctz(uint64_t(bits));
+        }
+        return CrossingScalar(s, i, n, t, rising);
+      }
+
+      EUDAQ_TARGET("avx2") size_t LastCrossingAvx2(const float *s, size_t n, float t, bool rising){
+        const __m256 vt = _mm256_set1_ps(t);
+        size_t i = n;
+        for(; i >= 9; i -= 8){
+          int bits = _mm256_movemask_ps(CrossedAvx2(s, i - 8, vt, rising));
+          if(bits)
+            return i - 8 + 31 - Clz32(uint32_t(bits));
+        }
+        return LastCrossingScalar(s, i, t, rising);
+      }
+
+      EUDAQ_TARGET("avx2") void MasksAvx2(const float *s, size_t n, float t, uint64_t *above, uint64_t *below){
+        const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        const __m256 vt = _mm256_set1_ps(t);
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8){
+          __m256 v = _mm256_and_ps(_mm256_loadu_ps(s + i), mask);
+          above[i/64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(v, vt, _CMP_GT_OQ))) << (i%64);
+          below[i/64] |= uint64_t(_mm256_movemask_ps(_mm256_cmp_ps(v, vt, _CMP_LT_OQ))) << (i%64);
+        }
+        MasksScalar(s, i, n, t, above, below);
+      }
+
+      // SSE2, 4 samples per instruction
+
+      EUDAQ_TARGET("sse2") float SumSse2(const float *s, size_t n, bool absolute){
+        const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8){
+          __m128 v0 = _mm_loadu_ps(s + i), v1 = _mm_loadu_ps(s + i + 4);
+          if(absolute){
+            v0 = _mm_and_ps(v0, mask);
+            v1 = _mm_and_ps(v1, mask);
+          }
+          a0 = _mm_add_ps(a0, v0);
+          a1 = _mm_add_ps(a1, v1);
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_add_ps(a0, a1));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumScalar(s + i, n - i, absolute);
+      }
+
+      EUDAQ_TARGET("sse2") size_t FindSse2(const float *s, size_t n, float v){
+        const __m128 vv = _mm_set1_ps(v);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+          int bits = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(s + i), vv));
+          if(bits)
+            return i + Ctz(uint64_t(bits));
+        }
+        return FindScalar(s, i, n, v);
+      }
+
+      EUDAQ_TARGET("sse2") void MinMaxSse2(const float *s, size_t n, size_t &imin, size_t &imax){
+        if(n < 8)
+          return MinMaxScalar(s, n, imin, imax);
+        __m128 mn = _mm_loadu_ps(s), mx = mn;
+        size_t i = 4;
+        for(; i + 4 <= n; i += 4){
+          __m128 v = _mm_loadu_ps(s + i);
+          mn = _mm_min_ps(mn, v);
+          mx = _mm_max_ps(mx, v);
+        }
+        float lmin[4], lmax[4];
+        _mm_storeu_ps(lmin, mn);
+        _mm_storeu_ps(lmax, mx);
+        float vmin = *std::min_element(lmin, lmin + 4), vmax = *std::max_element(lmax, lmax + 4);
+        for(; i < n; i++){
+          vmin = std::min(vmin, s[i]);
+          vmax = std::max(vmax, s[i]);
+        }
+        imin = FindSse2(s, n, vmin);
+        imax = FindSse2(s, n, vmax);
+      }
+
+      EUDAQ_TARGET("sse2") __m128 CrossedSse2(const float *s, size_t i, __m128 vt, bool rising){
+        __m128 a = _mm_loadu_ps(s + i - 1), b = _mm_loadu_ps(s + i);
+        return rising ?
+          _mm_and_ps(_mm_cmplt_ps(a, vt), _mm_cmple_ps(vt, b)) :
+          _mm_and_ps(_mm_cmpgt_ps(a, vt), _mm_cmpge_ps(vt, b));
+      }
+
+      EUDAQ_TARGET("sse2") size_t CrossingSse2(const float *s, size_t n, float t, bool rising){
+        const __m128 vt = _mm_set1_ps(t);
+        size_t i = 1;
+        for(; i + 4 <= n; i += 4){
+          int bits = _mm_movemask_ps(CrossedSse2(s, i, vt, rising));
+          if(bits)
+            return i + Ctz(uint64_t(bits));
+        }
+        return CrossingScalar(s, i, n, t, rising);
+      }
+
+      EUDAQ_TARGET("sse2") size_t LastCrossingSse2(const float *s, size_t n, float t, bool rising){
+        const __m128 vt = _mm_set1_ps(t);
+        size_t i = n;
+        for(; i >= 5; i -= 4){
+          int bits = _mm_movemask_ps(CrossedSse2(s, i - 4, vt, rising));
+          if(bits)
+            return i - 4 + 31 - Clz32(uint32_t(bits));
+        }
+        return LastCrossingScalar(s, i, t, rising);
+      }
+
+      EUDAQ_TARGET("sse2") void MasksSse2(const float *s, size_t n, float t, uint64_t *above, uint64_t *below){
+        const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 vt = _mm_set1_ps(t);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4){
+          __m128 v = _mm_and_ps(_mm_loadu_ps(s + i), mask);
+          above[i/64] |= uint64_t(_mm_movemask_ps(_mm_cmpgt_ps(v, vt))) << (i%64);
+          below[i/64] |= uint64_t(_mm_movemask_ps(_mm_cmplt_ps(v, vt))) << (i%64);
+        }
+        MasksScalar(s, i, n, t, above, below);
+      }
+#endif
+
+      float SumIsa(const float *s, size_t n, bool absolute){
+        switch(GetIsa()){
+#ifdef EUDAQ_WAVEFORM_X86
+        case Isa::AVX2: return SumAvx2(s, n, absolute);
+        case Isa::SSE2: return SumSse2(s, n, absolute);
+#endif
+        default: return SumScalar(s, n, absolute);
+        }
+      }
+
+      void Masks(const float *s, size_t n, float t, uint64_t *above, uint64_t *below){
+        switch(GetIsa()){
+#ifdef EUDAQ_WAVEFORM_X86
+        case Isa::AVX2: return MasksAvx2(s, n, t, above, below);
+        case Isa::SSE2: return MasksSse2(s, n, t, above, below);
+#endif
+        default: return MasksScalar(s, 0, n, t, above, below);
+        }
+      }
+    }
+
+    Isa GetIsa(){
+      static const Isa cpu = CpuIsa();
+      return Isa(std::min(int(cpu), max_isa.load(std::memory_order_relaxed)));
+    }
+
+    void SetMaxIsa(Isa isa){
+      max_isa = int(isa);
+    }
+
+    const char *IsaName(Isa isa){
+      switch(isa){
+      case Isa::AVX2: return "AVX2";
+      case Isa::SSE2: return "SSE2";
+      default: return "scalar";
+      }
+    }
+
+    float Sum(const float *s, size_t n){
+      return SumIsa(s, n, false);
+    }
+
+    float AbsSum(const float *s, size_t n){
+      return SumIsa(s, n, true);
+    }
+
+    void MinMax(const float *s, size_t n, size_t &imin, size_t &imax){
+      if(!n){
+        imin = imax = n;
+        return;
+      }
+      switch(GetIsa()){
+#ifdef EUDAQ_WAVEFORM_X86
+      case Isa::AVX2: return MinMaxAvx2(s, n, imin, imax);
+      case Isa::SSE2: return MinMaxSse2(s, n, imin, imax);
+#endif
+      default: return MinMaxScalar(s, n, imin, imax);
+      }
+    }
+
+    size_t Crossing(const float *s, size_t n, float t, bool rising){
+      size_t i;
+      switch(GetIsa()){
+#ifdef EUDAQ_WAVEFORM_X86
+      case Isa::AVX2: i = CrossingAvx2(s, n, t, rising); break;
+      case Isa::SSE2: i = CrossingSse2(s, n, t, rising); break;
+#endif
+      default: i = CrossingScalar(s, 1, n, t, rising);
+      }
+      return i ? i : n;
+    }
+
+    size_t LastCrossing(const float *s, size_t n, float t, bool rising){
+      size_t i;
+      switch(GetIsa()){
+#ifdef EUDAQ_WAVEFORM_X86
+      case Isa::AVX2: i = LastCrossingAvx2(s, n, t, rising); break;
+      case Isa::SSE2: i = LastCrossingSse2(s, n, t, rising); break;
+#endif
+      default: i = LastCrossingScalar(s, n, t, rising);
+      }
+      return i ? i : n;
+    }
+
+    float Median(const float *s, size_t n){
+      if(!n)
+        return 0;
+      thread_local std::vector<float> buf;
+      buf.assign(s, s + n);
+      auto mid = buf.begin() + n/2;
+      std::nth_element(buf.begin(), mid, buf.end());
+      if(n % 2)
+        return *mid;
+      // the lower central sample is the largest of the lower half
+      return (*std::max_element(buf.begin(), mid) + *mid) / 2;
+    }
+
+    void PeaksAbove(const float *s, size_t n, float threshold, std::vector<uint16_t> &peaks,
+                    size_t min_width, size_t min_distance){
+      if(n < 3)
+        return;
+      size_t words = (n + 63) / 64;
+      thread_local std::vector<uint64_t> above, below;
+      above.assign(words, 0);
+      below.assign(words, 0);
+      Masks(s, n, threshold, above.data(), below.data());
+
+      // a pulse starts at i with |s[i-1]| below and ends at i with |s[i+1]| below
+      size_t low = 0;
+      for(size_t k = 0; k < words; k++){
+        uint64_t prev = k ? below[k-1] >> 63 : 0;
+        uint64_t next = k + 1 < words ? below[k+1] << 63 : 0;
+        uint64_t starts = above[k] & (below[k] << 1 | prev);
+        uint64_t ends = above[k] & (below[k] >> 1 | next);
+        for(uint64_t w = starts | ends; w; w &= w - 1){
+          unsigned b = Ctz(w);
+          size_t i = k*64 + b;
+          if(i < 1 || i + 2 > n)
+            continue;
+          if(starts >> b & 1)
+            low = i;
+          if(!(ends >> b & 1) || i <= low + min_width)
+            continue;
+          size_t imin, imax;
+          MinMax(s + low, i - low, imin, imax);
+          size_t pos = low + (std::fabs(s[low+imax]) > std::fabs(s[low+imin]) ? imax : imin);
+          if(peaks.empty() || pos > peaks.back() + min_distance)
+            peaks.push_back(uint16_t(pos));
+        }
+      }
+    }
+
+    void Analyse(const float *const *channels, size_t n_channels, const Params &p, Result *results){
+      float pol = p.polarity < 0 ? -1.f : 1.f;
+      bool rising = p.polarity >= 0;
+      size_t nb = p.baseline_end > p.baseline_begin ? p.baseline_end - p.baseline_begin : 0;
+      size_t n = p.end > p.begin ? p.end - p.begin : 0;
+      for(size_t c = 0; c < n_channels; c++){
+        Result &r = results[c];
+        r = Result();
+        const float *s = channels[c];
+        if(nb)
+          r.baseline = Sum(s + p.baseline_begin, nb) / nb;
+        if(!n)
+          continue;
+        const float *w = s + p.begin;
+        r.integral = pol * (Sum(w, n) - r.baseline * n);
+        size_t imin, imax;
+        MinMax(w, n, imin, imax);
+        size_t ip = rising ? imax : imin;
+        r.peak = p.begin + ip;
+        r.amplitude = pol * (w[ip] - r.baseline);
+        float t = r.baseline + pol * p.threshold;
+        size_t i = Crossing(w, n, t, rising);
+        if(i < n)
+          r.threshold_time = p.begin + CrossingTime(w, i, t);
+        t = r.baseline + pol * p.cfd_fraction * r.amplitude;
+        i = LastCrossing(w, ip + 1, t, rising);
+        if(i < ip + 1)
+          r.cfd_time = p.begin + CrossingTime(w, i, t);
+      }
+    }
+  }
+}
@@ -27,7 +27,12 @@ namespace eudaq {
   public:
     LCFileWriter(const std::string &patt);
     void WriteEvent(EventSPC ev) override;
+    PreparedEventSP PrepareEvent(EventSPC ev) override;
+    void WritePrepared(EventSPC ev, PreparedEventSP p) override;
   private:
+    struct LCPreparedEvent : public PreparedEvent {
+      LCEventSP lcevent;
+    };
     std::unique_ptr<lcio::LCWriter> m_lcwriter;
     std::string m_filepattern;
     uint32_t m_run_n;
@@ -38,6 +43,20 @@ namespace eudaq {
   }
 
   void LCFileWriter::WriteEvent(EventSPC ev) {
+    WritePrepared(ev, PrepareEvent(ev));
+  }
+
+  PreparedEventSP LCFileWriter::PrepareEvent(EventSPC ev) {
+    auto p = std::make_shared<LCPreparedEvent>();
+    p->lcevent.reset(new lcio::LCEventImpl);
+    LCEventConverter::Convert(ev, p->lcevent, GetConfiguration());
+    return p;
+  }
+
+  void LCFileWriter::WritePrepared(EventSPC ev, PreparedEventSP p) {
+    auto lcp = std::dynamic_pointer_cast<LCPreparedEvent>(p);
+    if(!lcp)
+      EUDAQ_THROW("LCFileWriter: the event was not prepared by this writer");
     uint32_t run_n = ev->GetRunN();
     if(!m_lcwriter || m_run_n != run_n){
       try {
@@ -56,8 +75,6 @@ namespace eudaq {
     }
     if(!m_lcwriter)
       EUDAQ_THROW("LCFileWriter: Attempt to write unopened file");
-    LCEventSP lcevent(new lcio::LCEventImpl);
-    LCEventConverter::Convert(ev, lcevent, GetConfiguration());
-    m_lcwriter->writeEvent(lcevent.get());
+    m_lcwriter->writeEvent(lcp->lcevent.get());
   }
 }
@@ -12,6 +12,8 @@ namespace eudaq{
     TTreeFileWriter(std::string  out, const std::string & in);
     ~TTreeFileWriter() override;
     void WriteEvent(EventSPC ev) override;
+    PreparedEventSP PrepareEvent(EventSPC ev) override;
+    void WritePrepared(EventSPC ev, PreparedEventSP p) override;
     void SetBranches();
     void InitVectors();
     void InitTrees();
@@ -20,6 +22,9 @@ namespace eudaq{
     static uint8_t FindNCMSPixels(const EventSPC & ev);
 
   private:
+    struct StdPreparedEvent : public PreparedEvent {
+      StandardEventSP stdev;
+    };
     std::string m_log_type;
     std::string m_filepattern;
     uint32_t m_run_n;
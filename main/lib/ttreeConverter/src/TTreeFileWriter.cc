@@ -46,9 +46,27 @@ namespace eudaq {
   }
   
   void TTreeFileWriter::WriteEvent(EventSPC cev) {
+    WritePrepared(cev, PrepareEvent(cev));
+  }
+
+  PreparedEventSP TTreeFileWriter::PrepareEvent(EventSPC cev) {
+    auto p = make_shared<StdPreparedEvent>();
+    auto ev = const_pointer_cast<Event>(cev);
+    p->stdev = dynamic_pointer_cast<StandardEvent>(ev);
+    if(!p->stdev){
+      p->stdev = StandardEvent::MakeShared();
+      StdEventConverter::Convert(ev, p->stdev, nullptr); //no conf
+    }
+    return p;
+  }
+
+  void TTreeFileWriter::WritePrepared(EventSPC cev, PreparedEventSP p) {
 
     if(!m_tfile)
       EUDAQ_THROW("TTreeFileWriter: Attempt to write unopened file");
+    auto stdp = dynamic_pointer_cast<StdPreparedEvent>(p);
+    if(!stdp)
+      EUDAQ_THROW("TTreeFileWriter: the event was not prepared by this writer");
     auto ev = const_pointer_cast<Event>(cev);
     b_event_nr = ev->GetEventN();
     for (const auto & sev: ev->GetSubEvents()) {
@@ -57,11 +75,7 @@ namespace eudaq {
         b_time_stamp_end = sev->GetTimestampEnd();
       }
     }
-    auto stdev = dynamic_pointer_cast<StandardEvent>(ev);
-    if(!stdev){
-      stdev = StandardEvent::MakeShared();
-      StdEventConverter::Convert(ev, stdev, nullptr); //no conf
-    }
+    auto stdev = stdp->stdev;
     if (not m_init_vectors) {
       if (stdev->NumPlanes() > 0){
         m_n_planes = stdev->NumPlanes();
@@ -72,6 +72,11 @@ class BaseCollection {
   /*!This resets all the histograms ready for a new run*/
   virtual void Reset() = 0;
 
+  //!Flush
+  /*!This adds any buffered fills to the histograms, it may be called from the
+   * GUI thread while another thread fills*/
+  virtual void Flush() {}
+
   //!Set Reduce
   /*!This sets a new value for the parameter _reduce*/
   void setReduce(const unsigned int red);
@@ -17,6 +17,8 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <chrono>
+#include <mutex>
 
 #include "CorrelationHistos.hh"
 #include "BaseCollection.hh"
@@ -47,15 +49,15 @@ class CorrelationCollection : public BaseCollection {
 protected:
   map<pair<SimpleStandardPlane, SimpleStandardPlane>, CorrelationHistos *> _map;
   vector<SimpleStandardPlane> _planes;
-  bool isPlaneRegistered(SimpleStandardPlane p);
+  bool isPlaneRegistered(const SimpleStandardPlane &p);
   bool checkCorrelations(const SimpleStandardCluster &cluster1,
                          const SimpleStandardCluster &cluster2,
                          const bool all_mimosa);
   void fillHistograms(vector<vector<pair<int, SimpleStandardCluster>>> tracks,
                       const SimpleStandardEvent &simpEv);
-  void fillHistograms(const SimpleStandardPlane &p1,
-                      const SimpleStandardPlane &p2,
-		      const SimpleStandardEvent &simpEv);
+  bool isPairSelected(const int planeA, const int planeB) const;
+  void registerPlanes(const SimpleStandardEvent &simpev);
+  void flushIfDue();
 
 public:
   CorrelationCollection();
@@ -74,6 +76,11 @@ class CorrelationCollection : public BaseCollection {
   vector<int> getSelected_planes_to_skip() const;
   void setCorrelateAllPlanes(bool correlateAllPlanes);
   void setSelected_planes_to_skip(vector<int> selected_planes_to_skip);
+  // how often the buffered correlations are added to the histograms
+  void setFlushInterval(unsigned ms) {
+    _flushInterval = std::chrono::milliseconds(ms);
+  }
+  virtual void Flush();
   virtual void Calculate(const unsigned int /*currentEventNumber*/) {}
   void setPlanesNumberForCorrelation(unsigned param) {
     planesNumberForCorrelation = param;
@@ -93,6 +100,24 @@ class CorrelationCollection : public BaseCollection {
   vector<int> selected_planes_to_skip;
   unsigned planesNumberForCorrelation;
   unsigned windowWidthForCorrelation;
+
+  // a pair of planes to correlate, by index in the event
+  struct PlanePair {
+    int a;
+    int b;
+    CorrelationHistos *histos;
+  };
+  vector<PlanePair> _pairs;
+  // cluster positions of the current event, per plane
+  struct ClusterPosition {
+    int x;
+    int y;
+  };
+  vector<vector<ClusterPosition>> _positions;
+  std::chrono::milliseconds _flushInterval;
+  std::chrono::steady_clock::time_point _lastFlush;
+  // guards _map, the GUI flushes, writes and resets while the worker fills
+  std::mutex _mapMutex;
 };
 
 #ifdef __CINT__
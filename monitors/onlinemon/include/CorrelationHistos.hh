@@ -9,6 +9,8 @@
 #define CORRELATIONHISTOS_HH_
 
 #include <mutex>
+#include <vector>
+#include <utility>
 
 #include <TH2I.h>
 #include <TFile.h>
@@ -17,6 +19,21 @@
 
 using namespace std;
 
+//! Compact buffer of (x, y) fills waiting to be added to a histogram
+class PendingFills {
+public:
+  // flushed early beyond this many fills, to bound the memory
+  static const size_t MAX_FILLS = 1 << 16;
+  void add(float x, float y) { _fills.push_back(std::make_pair(x, y)); }
+  bool full() const { return _fills.size() >= MAX_FILLS; }
+  // adds the fills to h and clears them
+  void addTo(TH2I *h);
+  void clear() { _fills.clear(); }
+
+private:
+  std::vector<std::pair<float, float>> _fills;
+};
+
 class CorrelationHistos {
 protected:
   std::string _sensor1;
@@ -39,16 +56,38 @@ class CorrelationHistos {
   double m_pitchY2;
   
   std::mutex m_mu;
+
+  // guards the pending fills, taken after m_mu
+  std::mutex m_mu_pend;
+  PendingFills m_pendX;
+  PendingFills m_pendY;
+  PendingFills m_pendTimeX;
+  PendingFills m_pendTimeY;
   
 public:
   CorrelationHistos(SimpleStandardPlane p1, SimpleStandardPlane p2);
 
+  void Fill(const int x1, const int y1, const int x2, const int y2,
+            const int event) {
+    bool full;
+    {
+      std::lock_guard<std::mutex> lck(m_mu_pend);
+      m_pendX.add(x1, x2);
+      m_pendY.add(y1, y2);
+      m_pendTimeX.add(event, x1 - x2 * m_pitchX2 / m_pitchX1);
+      m_pendTimeY.add(event, y1 - y2 * m_pitchY2 / m_pitchY1);
+      full = m_pendX.full();
+    }
+    if (full)
+      Flush();
+  }
   void Fill(const SimpleStandardCluster &cluster1,
             const SimpleStandardCluster &cluster2);
   void FillCorrVsTime(const SimpleStandardCluster &cluster1,
 		      const SimpleStandardCluster &cluster2,
 		      const SimpleStandardEvent &simpev);
-
+  // adds the pending fills to the histograms, safe to call from any thread
+  void Flush();
   
   void Reset();
 
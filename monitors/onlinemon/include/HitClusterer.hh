@@ -0,0 +1,47 @@
+/*
+ * HitClusterer.hh
+ *
+ * Groups the hits of a plane into clusters of touching pixels
+ * (8-neighbourhood) in linear time.
+ */
+
+#ifndef HITCLUSTERER_HH_
+#define HITCLUSTERER_HH_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "include/SimpleStandardHit.hh"
+#include "include/SimpleStandardCluster.hh"
+
+//! Union-find clustering of pixel hits
+/*!
+  Zero-suppressed data sorted by row or by column is merged in a single
+  sweep comparing every hit only with its neighbours in the previous
+  line. Unsorted hits are merged via a hash of the pixel positions.
+  The buffers are kept between calls, one clusterer per thread is enough.
+ */
+class HitClusterer {
+public:
+  // labels every hit with the index of its cluster, returns the number of
+  // clusters; clusters are numbered in the order of their first hit
+  unsigned int label(const std::vector<SimpleStandardHit> &hits);
+  const std::vector<unsigned int> &getLabels() const { return _labels; }
+  // appends the clusters of hits to clusters
+  unsigned int cluster(const std::vector<SimpleStandardHit> &hits,
+                       std::vector<SimpleStandardCluster> &clusters);
+
+private:
+  unsigned int find(unsigned int i);
+  void join(unsigned int a, unsigned int b);
+  void sweep(const std::vector<SimpleStandardHit> &hits, bool byRow);
+  void hash(const std::vector<SimpleStandardHit> &hits);
+
+  std::vector<unsigned int> _parent;
+  std::vector<unsigned int> _labels;
+  std::vector<uint64_t> _keys;
+  std::vector<unsigned int> _slots;
+};
+
+#endif // HITCLUSTERER_HH_
@@ -32,6 +32,13 @@
 // STL includes
 #include <string>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 using namespace std;
 
@@ -61,6 +68,7 @@ class RootMonitor : public eudaq::Monitor{
   void setUseTrack_corr(const bool t_c);
   void setTracksPerEvent(const unsigned int tracks);
   void SetSnapShotDir(string s);
+  void setThreads(const unsigned int n);
 
   bool getUseTrack_corr() const;
   unsigned int getTracksPerEvent() const;
@@ -68,6 +76,34 @@ class RootMonitor : public eudaq::Monitor{
   OnlineMonWindow *getOnlineMon() const;
   OnlineMonConfiguration mon_configdata; // FIXME
 private:
+  // an event on its way through the pipeline
+  struct Converted {
+    std::shared_ptr<SimpleStandardEvent> simpEv;
+    uint32_t planes;
+    double analysis_time;
+    double clustering_time;
+  };
+  // a collection with the thread filling it
+  struct FillWorker {
+    BaseCollection *coll;
+    std::deque<std::shared_ptr<const SimpleStandardEvent>> queue;
+    std::mutex mx;
+    std::condition_variable cv;
+    bool busy;
+    bool exit;
+    std::atomic<double> time;
+    std::thread thread;
+  };
+  Converted convertEvent(eudaq::EventSPC evsp);
+  void releaseEvent(Converted &cv);
+  void fillCollection(BaseCollection *coll, const SimpleStandardEvent &simpEv);
+  void converting(size_t i);
+  void filling(FillWorker *w);
+  void startPipeline();
+  void stopPipeline();
+  void drainPipeline();
+  bool pipelineIdle();
+
   std::vector<BaseCollection *> _colls;
   OnlineMonWindow *onlinemon;
   std::string rootfilename;
@@ -81,14 +117,31 @@ class RootMonitor : public eudaq::Monitor{
   string snapshotdir;
   bool useTrackCorrelator;
   TStopwatch my_event_processing_time;
-  TStopwatch my_event_inner_operations_time;
   double previous_event_analysis_time;
   double previous_event_fill_time;
   double previous_event_clustering_time;
-  double previous_event_correlation_time;
+  std::atomic<double> previous_event_correlation_time;
   unsigned int tracksPerEvent;
   uint32_t m_plane_c;
   uint32_t m_ev_rec_n = 0;
+
+  // conversion stage, results are released in the order of arrival
+  unsigned int m_threads;
+  std::vector<std::thread> m_conv_threads;
+  std::mutex m_conv_mx;
+  std::condition_variable m_conv_cv;
+  std::condition_variable m_conv_cv_space;
+  // one queue per conversion thread
+  std::vector<std::deque<std::pair<uint64_t, eudaq::EventSPC>>> m_conv_queues;
+  std::map<uint64_t, Converted> m_reorder;
+  uint64_t m_seq_in;
+  uint64_t m_seq_out;
+  size_t m_conv_next;
+  unsigned int m_conv_busy;
+  bool m_releasing;
+  bool m_conv_exit;
+  // fill stage, one worker per collection
+  std::vector<std::unique_ptr<FillWorker>> m_fill_workers;
 };
 
 #ifdef __CINT__
@@ -47,6 +47,10 @@ class OnlineMonConfiguration {
   void setCorrel_minclustersize(int correl_minclustersize);
   std::vector<int> getPlanes_to_be_skipped() const;
   void setPlanes_to_be_skipped(std::vector<int> planes_to_be_skipped);
+  std::string getCorrel_pairs() const;
+  void setCorrel_pairs(std::string correl_pairs);
+  std::vector<int> getReference_planes() const;
+  void setReference_planes(std::vector<int> reference_planes);
 
 private:
   // general settings
@@ -60,6 +64,8 @@ class OnlineMonConfiguration {
   std::map<int, bool> correlation_xy_flip;
   std::vector<int> planes_to_be_skipped;
   int correl_minclustersize;
+  std::string correl_pairs; // all, neighbours or reference
+  std::vector<int> reference_planes;
   // Clusterizer settings
 
   // hotcluster finder settings
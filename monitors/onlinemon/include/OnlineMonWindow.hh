@@ -28,6 +28,7 @@
 #include <TGraph.h>
 #include <vector>
 #include <map>
+#include <mutex>
 #include "BaseCollection.hh"
 #include "OnlineMon.hh"
 
@@ -75,6 +76,8 @@ class OnlineMonWindow : public TGMainFrame {
   std::map<std::string, std::string> _hitmapOptions;
   std::map<std::string, unsigned int> _logScaleMap;
   std::map<std::string, std::mutex*> _mutexMap;
+  // the collections register their histograms from their fill threads
+  std::recursive_mutex _mapMutex;
   TGListTreeItem *Itm_Eudet;
   TGListTreeItem *Itm_DUT;
   TGListTreeItem *Itm_EudetHM;
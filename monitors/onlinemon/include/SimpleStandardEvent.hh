@@ -50,7 +50,9 @@ class SimpleStandardEvent {
   SimpleStandardEvent();
 
   void addPlane(SimpleStandardPlane &plane);
-  SimpleStandardPlane getPlane(const int i) const { return _planes.at(i); }
+  const SimpleStandardPlane &getPlane(const int i) const {
+    return _planes.at(i);
+  }
   int getNPlanes() const { return _planes.size(); }
   void doClustering();
   double getMonitor_eventanalysistime() const;
@@ -53,7 +53,9 @@ class SimpleStandardPlane {
   void doClustering();
   std::vector<SimpleStandardHit> getHits() const { return _hits; }
   std::vector<SimpleStandardHit> getRawHits() const { return _rawhits; }
-  std::vector<SimpleStandardCluster> getClusters() const { return _clusters; }
+  const std::vector<SimpleStandardCluster> &getClusters() const {
+    return _clusters;
+  }
   int getNHits() const { return _hits.size(); }
   int getNBadHits() const { return _badhits.size(); }
   int getNSectionHits(unsigned int section) const {
@@ -11,7 +11,8 @@
 CorrelationCollection::CorrelationCollection()
     : BaseCollection(), _map(), _planes(), skip_this_plane(),
       correlateAllPlanes(false), selected_planes_to_skip(),
-      planesNumberForCorrelation(0), windowWidthForCorrelation(0) {
+      planesNumberForCorrelation(0), windowWidthForCorrelation(0),
+      _flushInterval(1000) {
   CollectionType = CORRELATION_COLLECTION_TYPE;
 }
 
@@ -24,7 +25,7 @@ bool checkIfClusterIsBigEnough(SimpleStandardCluster oneCluster) {
   return false;
 }
 
-bool CorrelationCollection::isPlaneRegistered(const SimpleStandardPlane p) {
+bool CorrelationCollection::isPlaneRegistered(const SimpleStandardPlane &p) {
   vector<SimpleStandardPlane>::iterator it =
       find(_planes.begin(), _planes.end(), p);
 
@@ -69,10 +70,12 @@ CorrelationHistos *
 CorrelationCollection::getCorrelationHistos(const SimpleStandardPlane &p1,
                                             const SimpleStandardPlane &p2) {
   std::pair<SimpleStandardPlane, SimpleStandardPlane> plane(p1, p2);
+  std::lock_guard<std::mutex> lck(_mapMutex);
   return _map[plane];
 }
 
 void CorrelationCollection::Reset() {
+  std::lock_guard<std::mutex> lck(_mapMutex);
   std::map<std::pair<SimpleStandardPlane, SimpleStandardPlane>,
            CorrelationHistos *>::iterator it;
   for (it = _map.begin(); it != _map.end(); ++it) {
@@ -92,15 +95,10 @@ void CorrelationCollection::Fill(const SimpleStandardEvent &simpev) {
   int nPlanes = simpev.getNPlanes();
   int nPlanes_disabled = 0;
 
-  unsigned int plane_vector_size = 0;
   if (skip_this_plane.size() == 0) // do this only at the very first event
   {
     selected_planes_to_skip = _mon->mon_configdata.getPlanes_to_be_skipped();
-    skip_this_plane.reserve(nPlanes);
-    // init vector
-    for (int elements = 0; elements < nPlanes; elements++) {
-      skip_this_plane[elements] = false;
-    }
+    skip_this_plane.assign(nPlanes, false);
     // now get vector of planes to be disabled and set the corresponding entries
     // to true
     for (unsigned int skipplanes = 0;
@@ -122,45 +120,122 @@ void CorrelationCollection::Fill(const SimpleStandardEvent &simpev) {
       std::cout << "CorrelationCollection : Too Many Planes Disabled ..."
                 << endl;
   } else {
-    for (int planeA = 0; planeA < nPlanes; planeA++) {
-      const SimpleStandardPlane &simpPlane = simpev.getPlane(planeA);
-      if (!isPlaneRegistered(simpPlane)) {
-        plane_vector_size =
-            _planes.size(); // how many planes we did look at beforehand
-        if (correlateAllPlanes) {
-          for (unsigned int oldPlanes = 0; oldPlanes < plane_vector_size;
-               oldPlanes++) {
-            registerPlaneCorrelations(
-                _planes.at(oldPlanes),
-                simpPlane); // Correlating this plane with all the other ones
-          }
-        } else // we have deselected a few planes
-        {
-          if (!skip_this_plane[planeA]) {
-            for (unsigned int oldPlanes = 0; oldPlanes < plane_vector_size;
-                 oldPlanes++) {
-              if (!skip_this_plane[oldPlanes]) {
-                registerPlaneCorrelations(_planes.at(oldPlanes),
-                                          simpPlane); // Correlating this plane
-                                                      // with all the other ones
-              }
-            }
-          }
+    registerPlanes(simpev);
+
+    // the cluster positions are computed once per plane, not once per pair
+    const int minclustersize = _mon->mon_configdata.getCorrel_minclustersize();
+    _positions.resize(nPlanes);
+    for (int plane = 0; plane < nPlanes; plane++) {
+      vector<ClusterPosition> &positions = _positions[plane];
+      positions.clear();
+      const vector<SimpleStandardCluster> &clusters =
+          simpev.getPlane(plane).getClusters();
+      for (unsigned int i = 0; i < clusters.size(); i++) {
+        // we are only interested in clusters with several pixels
+        if (clusters[i].getNPixel() >= minclustersize) {
+          ClusterPosition pos = {clusters[i].getX(), clusters[i].getY()};
+          positions.push_back(pos);
         }
-        _planes.push_back(simpPlane); // we have to deal with all planes
       }
-      for (int planeB = planeA + 1; planeB < nPlanes; planeB++) {
-        if ((skip_this_plane[planeA] == false) &&
-            (skip_this_plane[planeB]) == false) {
-          const SimpleStandardPlane &p1 = simpev.getPlane(planeA);
-          const SimpleStandardPlane &p2 = simpev.getPlane(planeB);
-          fillHistograms(p1, p2,simpev);
-        }
+    }
+
+    const int event = simpev.getEvent_number();
+    for (unsigned int i = 0; i < _pairs.size(); i++) {
+      const PlanePair &pair = _pairs[i];
+      if (pair.b >= nPlanes)
+        continue;
+      const vector<ClusterPosition> &aPositions = _positions[pair.a];
+      const vector<ClusterPosition> &bPositions = _positions[pair.b];
+      for (unsigned int acluster = 0; acluster < aPositions.size(); acluster++)
+        for (unsigned int bcluster = 0; bcluster < bPositions.size();
+             bcluster++)
+          pair.histos->Fill(aPositions[acluster].x, aPositions[acluster].y,
+                            bPositions[bcluster].x, bPositions[bcluster].y,
+                            event);
+    }
+  }
+  flushIfDue();
+}
+
+void CorrelationCollection::registerPlanes(const SimpleStandardEvent &simpev) {
+  const int nPlanes = simpev.getNPlanes();
+  bool newPlanes = false;
+  for (int planeA = 0; planeA < nPlanes; planeA++) {
+    const SimpleStandardPlane &simpPlane = simpev.getPlane(planeA);
+    if (isPlaneRegistered(simpPlane))
+      continue;
+    // how many planes we did look at beforehand
+    const unsigned int plane_vector_size = _planes.size();
+    for (unsigned int oldPlanes = 0; oldPlanes < plane_vector_size;
+         oldPlanes++) {
+      // correlateAllPlanes ignores the planes deselected
+      if (!correlateAllPlanes &&
+          (skip_this_plane[planeA] || skip_this_plane[oldPlanes]))
+        continue;
+      if (isPairSelected(oldPlanes, planeA))
+        registerPlaneCorrelations(_planes.at(oldPlanes), simpPlane);
+    }
+    _planes.push_back(simpPlane); // we have to deal with all planes
+    newPlanes = true;
+  }
+  if (!newPlanes)
+    return;
+
+  // the pairs to fill, looked up once instead of for every event
+  _pairs.clear();
+  std::lock_guard<std::mutex> lck(_mapMutex);
+  for (int planeA = 0; planeA < nPlanes; planeA++) {
+    for (int planeB = planeA + 1; planeB < nPlanes; planeB++) {
+      if (skip_this_plane[planeA] || skip_this_plane[planeB])
+        continue;
+      auto it = _map.find(
+          make_pair(simpev.getPlane(planeA), simpev.getPlane(planeB)));
+      if (it != _map.end() && it->second) {
+        PlanePair pair = {planeA, planeB, it->second};
+        _pairs.push_back(pair);
       }
     }
   }
 }
 
+bool CorrelationCollection::isPairSelected(const int planeA,
+                                           const int planeB) const {
+  const string pairs = _mon->mon_configdata.getCorrel_pairs();
+  if (pairs == "neighbours") {
+    // only the next plane which is not deselected
+    for (int plane = planeA + 1; plane < planeB; plane++)
+      if (plane >= (int)skip_this_plane.size() || !skip_this_plane[plane])
+        return false;
+    return true;
+  } else if (pairs == "reference") {
+    // every plane with the reference planes
+    const vector<int> reference = _mon->mon_configdata.getReference_planes();
+    return find(reference.begin(), reference.end(), planeA) !=
+               reference.end() ||
+           find(reference.begin(), reference.end(), planeB) != reference.end();
+  }
+  return true;
+}
+
+void CorrelationCollection::flushIfDue() {
+  const std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+  if (now - _lastFlush < _flushInterval)
+    return;
+  _lastFlush = now;
+  Flush();
+}
+
+void CorrelationCollection::Flush() {
+  std::lock_guard<std::mutex> lck(_mapMutex);
+  std::map<std::pair<SimpleStandardPlane, SimpleStandardPlane>,
+           CorrelationHistos *>::iterator it;
+  for (it = _map.begin(); it != _map.end(); ++it) {
+    if (it->second)
+      it->second->Flush();
+  }
+}
+
 unsigned int
 CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
   int nPlanes = simpev.getNPlanes();
@@ -178,11 +253,7 @@ CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
   if (skip_this_plane.size() == 0) // do this only at the very first event
   {
     selected_planes_to_skip = _mon->mon_configdata.getPlanes_to_be_skipped();
-    skip_this_plane.reserve(nPlanes);
-    // init vector
-    for (int elements = 0; elements < nPlanes; elements++) {
-      skip_this_plane[elements] = false;
-    }
+    skip_this_plane.assign(nPlanes, false);
     // now get vector of planes to be disabled and set the corresponding entries
     // to true
     for (unsigned int skipplanes = 0;
@@ -211,7 +282,7 @@ CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
       if (skip_this_plane[planeA] ==
           false) // adding plane for analysis if selected
       {
-        vector<SimpleStandardCluster> clustersBeforeDeletion =
+        const vector<SimpleStandardCluster> &clustersBeforeDeletion =
             simpPlane.getClusters();
         vector<SimpleStandardCluster> clustersAfterDeletion;
         clustersAfterDeletion.reserve(20);
@@ -319,12 +390,14 @@ CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
     }
   }
   fillHistograms(reconstructedTracks, simpev);
+  flushIfDue();
   return reconstructedTracks.size();
 }
 
 void CorrelationCollection::fillHistograms(
     std::vector<vector<pair<int, SimpleStandardCluster>>> tracks,
     const SimpleStandardEvent &simpEv) {
+  std::lock_guard<std::mutex> lck(_mapMutex);
 
   for (unsigned int trackNr = 0; trackNr < tracks.size(); ++trackNr) {
     vector<pair<int, SimpleStandardCluster>> &currentTrack = tracks.at(trackNr);
@@ -343,6 +416,8 @@ void CorrelationCollection::fillHistograms(
         pair<SimpleStandardPlane, SimpleStandardPlane> planePair(firstPlane,
                                                                  secondPlane);
         CorrelationHistos *corrmap = _map[planePair];
+        if (!corrmap)
+          continue;
 
         corrmap->Fill(firstCluster, secondCluster);
 	corrmap->FillCorrVsTime(firstCluster, secondCluster, simpEv);
@@ -351,49 +426,15 @@ void CorrelationCollection::fillHistograms(
   }
 }
 
-void CorrelationCollection::fillHistograms(const SimpleStandardPlane &p1,
-                                           const SimpleStandardPlane &p2,
-					   const SimpleStandardEvent &simpEv) {
-
-  std::pair<SimpleStandardPlane, SimpleStandardPlane> plane(p1, p2);
-  CorrelationHistos *corrmap = _map[plane];
-  if (corrmap) {
-    const std::vector<SimpleStandardCluster> aClusters = p1.getClusters();
-    const std::vector<SimpleStandardCluster> bClusters = p2.getClusters();
-
-    for (unsigned int acluster = 0; acluster < aClusters.size(); acluster++) {
-      const SimpleStandardCluster &oneAcluster = aClusters.at(acluster);
-      if (oneAcluster.getNPixel() <
-          _mon->mon_configdata.getCorrel_minclustersize()) // we are only
-                                                           // interested in
-                                                           // clusters with
-                                                           // several pixels
-      {
-        continue;
-      }
-      for (unsigned int bcluster = 0; bcluster < bClusters.size(); bcluster++) {
-        const SimpleStandardCluster &oneBcluster = bClusters.at(bcluster);
-        //
-        if (oneBcluster.getNPixel() <
-            _mon->mon_configdata.getCorrel_minclustersize()) {
-          continue;
-        } else {
-          corrmap->Fill(oneAcluster, oneBcluster);
-	  corrmap->FillCorrVsTime(oneAcluster, oneBcluster, simpEv);
-        }
-      }
-    }
-  }
-}
-
-
-
 void CorrelationCollection::registerPlaneCorrelations(
     const SimpleStandardPlane &p1, const SimpleStandardPlane &p2) {
 
   CorrelationHistos *tmphisto = new CorrelationHistos(p1, p2);
   pair<SimpleStandardPlane, SimpleStandardPlane> pdouble(p1, p2);
-  _map[pdouble] = tmphisto;
+  {
+    std::lock_guard<std::mutex> lck(_mapMutex);
+    _map[pdouble] = tmphisto;
+  }
 
   if (_mon != NULL) {
     std::string dirName;
@@ -490,6 +531,7 @@ void CorrelationCollection::Write(TFile *file) {
     cout << "Can't Write Correllation Collections " << endl;
     return;
   }
+  Flush();
   if (_mon->getUseTrack_corr() == true) {
     gDirectory->mkdir("Track Correlations");
     gDirectory->cd("Track Correlations");
@@ -500,6 +542,7 @@ void CorrelationCollection::Write(TFile *file) {
   std::map<std::pair<SimpleStandardPlane, SimpleStandardPlane>,
            CorrelationHistos *>::iterator it;
 
+  std::lock_guard<std::mutex> lck(_mapMutex);
   for (it = _map.begin(); it != _map.end(); ++it) {
     if(it->second)
       it->second->Write();
@@ -12,7 +12,7 @@ CorrelationHistos::CorrelationHistos(SimpleStandardPlane p1,
     : _sensor1(p1.getName()), _sensor2(p2.getName()), _id1(p1.getID()),
       _id2(p2.getID()), _maxX1(p1.getMaxX()), _maxX2(p2.getMaxX()),
       _maxY1(p1.getMaxY()), _maxY2(p2.getMaxY()), _fills(0), _2dcorrX(NULL),
-      _2dcorrY(NULL) {
+      _2dcorrY(NULL), _2dcorrTimeX(NULL), _2dcorrTimeY(NULL) {
   char out[1024], out2[1024], out_x[1024], out_y[1024];  
   if (_maxX1 != -1 && _maxX2 != -1) {
     sprintf(out, "X Correlation of %s %i and %s %i", _sensor1.c_str(), _id1,
@@ -112,35 +112,62 @@ CorrelationHistos::CorrelationHistos(SimpleStandardPlane p1,
 
 }
 
+void PendingFills::addTo(TH2I *h) {
+  if (h != NULL) {
+    for (size_t i = 0; i < _fills.size(); i++)
+      h->Fill(_fills[i].first, _fills[i].second);
+  }
+  clear();
+}
+
 void CorrelationHistos::Fill(const SimpleStandardCluster &cluster1,
                              const SimpleStandardCluster &cluster2) {
-  std::lock_guard<std::mutex> lckx(m_mu);
-  if (_2dcorrX != NULL){
-    _2dcorrX->Fill(cluster1.getX(), cluster2.getX());
-  }
-  if (_2dcorrY != NULL){
-    _2dcorrY->Fill(cluster1.getY(), cluster2.getY());
+  bool full;
+  {
+    std::lock_guard<std::mutex> lck(m_mu_pend);
+    m_pendX.add(cluster1.getX(), cluster2.getX());
+    m_pendY.add(cluster1.getY(), cluster2.getY());
+    full = m_pendX.full();
   }
-
+  if (full)
+    Flush();
 }
 
 
 void CorrelationHistos::FillCorrVsTime(const SimpleStandardCluster &cluster1,
 				       const SimpleStandardCluster &cluster2,
 				       const SimpleStandardEvent &simpev) {
-  std::lock_guard<std::mutex> lckx(m_mu);
-  
-  if (_2dcorrTimeX != NULL){
-    _2dcorrTimeX->Fill(simpev.getEvent_number(),  cluster1.getX()-cluster2.getX()*m_pitchX2/m_pitchX1);
-  }
-  if (_2dcorrTimeY != NULL){
-    _2dcorrTimeY->Fill(simpev.getEvent_number(), cluster1.getY()-cluster2.getY()*m_pitchY2/m_pitchY1);
+  bool full;
+  {
+    std::lock_guard<std::mutex> lck(m_mu_pend);
+    m_pendTimeX.add(simpev.getEvent_number(),
+                    cluster1.getX() - cluster2.getX() * m_pitchX2 / m_pitchX1);
+    m_pendTimeY.add(simpev.getEvent_number(),
+                    cluster1.getY() - cluster2.getY() * m_pitchY2 / m_pitchY1);
+    full = m_pendTimeX.full();
   }
+  if (full)
+    Flush();
+}
 
+void CorrelationHistos::Flush() {
+  std::lock_guard<std::mutex> lckx(m_mu);
+  std::lock_guard<std::mutex> lckp(m_mu_pend);
+  m_pendX.addTo(_2dcorrX);
+  m_pendY.addTo(_2dcorrY);
+  m_pendTimeX.addTo(_2dcorrTimeX);
+  m_pendTimeY.addTo(_2dcorrTimeY);
 }
 
 
 void CorrelationHistos::Reset() {
+  std::lock_guard<std::mutex> lckx(m_mu);
+  std::lock_guard<std::mutex> lckp(m_mu_pend);
+  // the counts not yet flushed belong to the old histograms
+  m_pendX.clear();
+  m_pendY.clear();
+  m_pendTimeX.clear();
+  m_pendTimeY.clear();
   _2dcorrX->Reset();
   _2dcorrY->Reset();
   _2dcorrTimeX->Reset();
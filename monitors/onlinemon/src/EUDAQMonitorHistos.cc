@@ -88,6 +88,8 @@ void EUDAQMonitorHistos::Fill(const SimpleStandardEvent &ev) {
 
 void EUDAQMonitorHistos::Fill(const unsigned int evt_number,
                               const unsigned int tracks) {
+  // called by the correlation collection, which may fill on another thread
+  std::lock_guard<std::mutex> lck(m_mu);
   TracksPerEvent->Fill(evt_number, tracks);
 }
 
@@ -0,0 +1,156 @@
+/*
+ * HitClusterer.cc
+ *
+ * Linear-time connected-component clustering of pixel hits.
+ */
+
+#include "include/HitClusterer.hh"
+
+namespace {
+  // position of a pixel as hash key
+  inline uint64_t pixelKey(int x, int y) {
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+  }
+  inline uint64_t mixKey(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return k;
+  }
+  const unsigned int EMPTY = ~0u;
+}
+
+unsigned int HitClusterer::find(unsigned int i) {
+  while (_parent[i] != i) {
+    _parent[i] = _parent[_parent[i]]; // path halving
+    i = _parent[i];
+  }
+  return i;
+}
+
+void HitClusterer::join(unsigned int a, unsigned int b) {
+  a = find(a);
+  b = find(b);
+  // the lower index stays root, so roots are the first hit of a cluster
+  if (a < b)
+    _parent[b] = a;
+  else if (b < a)
+    _parent[a] = b;
+}
+
+void HitClusterer::sweep(const std::vector<SimpleStandardHit> &hits,
+                         bool byRow) {
+  // a line is a row (byRow) or a column, hits are ordered along the lines
+  const size_t n = hits.size();
+  size_t prev_begin = 0, prev_end = 0, cur_begin = 0, p = 0;
+  for (size_t i = 0; i < n; i++) {
+    const int line = byRow ? hits[i].getY() : hits[i].getX();
+    const int pos = byRow ? hits[i].getX() : hits[i].getY();
+    if (i == 0 || line != (byRow ? hits[i - 1].getY() : hits[i - 1].getX())) {
+      // a new line, the last one is only of interest if it is adjacent
+      if (i && line == (byRow ? hits[i - 1].getY() : hits[i - 1].getX()) + 1) {
+        prev_begin = cur_begin;
+        prev_end = i;
+      } else {
+        prev_begin = prev_end = i;
+      }
+      cur_begin = i;
+      p = prev_begin;
+    } else if (pos - (byRow ? hits[i - 1].getX() : hits[i - 1].getY()) <= 1) {
+      join(i, i - 1);
+    }
+    while (p < prev_end &&
+           (byRow ? hits[p].getX() : hits[p].getY()) < pos - 1)
+      p++;
+    for (size_t q = p;
+         q < prev_end && (byRow ? hits[q].getX() : hits[q].getY()) <= pos + 1;
+         q++)
+      join(i, q);
+  }
+}
+
+void HitClusterer::hash(const std::vector<SimpleStandardHit> &hits) {
+  const size_t n = hits.size();
+  size_t size = 16;
+  while (size < 2 * n)
+    size <<= 1;
+  const size_t mask = size - 1;
+  _keys.resize(size);
+  _slots.assign(size, EMPTY);
+
+  // fills the table, a repeated pixel joins the cluster of its first copy
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t key = pixelKey(hits[i].getX(), hits[i].getY());
+    size_t s = mixKey(key) & mask;
+    while (_slots[s] != EMPTY && _keys[s] != key)
+      s = (s + 1) & mask;
+    if (_slots[s] == EMPTY) {
+      _keys[s] = key;
+      _slots[s] = i;
+    } else {
+      join(i, _slots[s]);
+    }
+  }
+
+  // each pair of neighbours is seen once, from its lower left pixel
+  static const int dx[4] = {1, 1, 1, 0};
+  static const int dy[4] = {-1, 0, 1, 1};
+  for (size_t i = 0; i < n; i++) {
+    for (int d = 0; d < 4; d++) {
+      const uint64_t key =
+          pixelKey(hits[i].getX() + dx[d], hits[i].getY() + dy[d]);
+      size_t s = mixKey(key) & mask;
+      while (_slots[s] != EMPTY) {
+        if (_keys[s] == key) {
+          join(i, _slots[s]);
+          break;
+        }
+        s = (s + 1) & mask;
+      }
+    }
+  }
+}
+
+unsigned int HitClusterer::label(const std::vector<SimpleStandardHit> &hits) {
+  const size_t n = hits.size();
+  _parent.resize(n);
+  for (size_t i = 0; i < n; i++)
+    _parent[i] = i;
+
+  // zero-suppressed readout usually delivers the hits ordered by row or
+  // by column, then a sweep over the lines does
+  bool byRow = true, byColumn = true;
+  for (size_t i = 1; i < n && (byRow || byColumn); i++) {
+    const SimpleStandardHit &a = hits[i - 1], &b = hits[i];
+    if (a.getY() > b.getY() || (a.getY() == b.getY() && a.getX() > b.getX()))
+      byRow = false;
+    if (a.getX() > b.getX() || (a.getX() == b.getX() && a.getY() > b.getY()))
+      byColumn = false;
+  }
+  if (byRow)
+    sweep(hits, true);
+  else if (byColumn)
+    sweep(hits, false);
+  else
+    hash(hits);
+
+  // roots are the first hit of their cluster, so one pass numbers them
+  _labels.resize(n);
+  unsigned int nClusters = 0;
+  for (size_t i = 0; i < n; i++) {
+    const unsigned int root = find(i);
+    _labels[i] = (root == i) ? nClusters++ : _labels[root];
+  }
+  return nClusters;
+}
+
+unsigned int
+HitClusterer::cluster(const std::vector<SimpleStandardHit> &hits,
+                      std::vector<SimpleStandardCluster> &clusters) {
+  const unsigned int nClusters = label(hits);
+  const size_t first = clusters.size();
+  clusters.resize(first + nClusters);
+  for (size_t i = 0; i < hits.size(); i++)
+    clusters[first + _labels[i]].addPixel(hits[i]);
+  return nClusters;
+}
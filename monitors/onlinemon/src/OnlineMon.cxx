@@ -40,6 +40,7 @@
 #include <chrono>
 #include <thread>
 #include <memory>
+#include <algorithm>
 
 //ONLINE MONITOR Includes
 #include "OnlineMon.hh"
@@ -51,7 +52,8 @@ using namespace std;
 RootMonitor::RootMonitor(const std::string & runcontrol,
 			 int /*x*/, int /*y*/, int /*w*/, int /*h*/,
 			 const std::string & conffile, const std::string & monname)
-  :eudaq::Monitor(monname, runcontrol), _planesInitialized(false), onlinemon(NULL){
+  :eudaq::Monitor(monname, runcontrol), _planesInitialized(false), onlinemon(NULL),
+   m_threads(0), m_seq_in(0), m_seq_out(0), m_conv_next(0), m_conv_busy(0), m_releasing(false), m_conv_exit(false){
   onlinemon = new OnlineMonWindow(gClient->GetRoot(),800,600);
 
   if (onlinemon==NULL){
@@ -111,6 +113,7 @@ RootMonitor::RootMonitor(const std::string & runcontrol,
 }
 
 RootMonitor::~RootMonitor(){
+  stopPipeline();
   gApplication->Terminate();
 }
 
@@ -166,40 +169,50 @@ void RootMonitor::DoReceive(eudaq::EventSP evsp) {
   if(evsp->GetEventN() > 10 && evsp->GetEventN() % onlinemon->getReduce() != 0){
     return;
   }
-  
-  auto stdev = std::dynamic_pointer_cast<eudaq::StandardEvent>(evsp);
-  if(!stdev){
-    stdev = eudaq::StandardEvent::MakeShared();
-    eudaq::StdEventConverter::Convert(evsp, stdev, nullptr); //no conf
-  }
-  
-  uint32_t ev_plane_c = stdev->NumPlanes();
-  if(m_ev_rec_n < 10){
-    m_ev_rec_n ++;
-    if(ev_plane_c > m_plane_c){
-      m_plane_c = ev_plane_c;
-    }
+
+  if(m_conv_threads.empty()){
+    Converted cv = convertEvent(evsp);
+    releaseEvent(cv);
     return;
   }
 
-  if(ev_plane_c != m_plane_c){
-    std::cout<< "Event #"<< evsp->GetEventN()<< " has "<<ev_plane_c<<" plane(s), while we expect "<< m_plane_c <<" plane(s).  (Event is skipped)" <<std::endl;
-    return;
+  // events of converters keeping a state per stream always go to the same
+  // thread, the others are spread over all of them
+  uint32_t stream;
+  size_t n = m_conv_threads.size();
+  size_t i = eudaq::StdEventConverter::FindStateStream(evsp, stream) ?
+    stream % n : m_conv_next++ % n;
+  // hand the event to its conversion thread, wait if it is behind
+  std::unique_lock<std::mutex> lk(m_conv_mx);
+  m_conv_cv_space.wait(lk, [this, i](){return m_conv_queues[i].size() < 4;});
+  m_conv_queues[i].emplace_back(m_seq_in++, evsp);
+  lk.unlock();
+  m_conv_cv.notify_all();
+}
+
+RootMonitor::Converted RootMonitor::convertEvent(eudaq::EventSPC evsp) {
+  // runs on the conversion threads, must not touch the collections
+  Converted cv;
+  cv.planes = 0;
+  cv.analysis_time = 0;
+  cv.clustering_time = 0;
+  TStopwatch processing_time;
+  processing_time.Start(true);
+
+  auto stdev = std::dynamic_pointer_cast<const eudaq::StandardEvent>(evsp);
+  if(!stdev){
+    auto stdev_cvt = eudaq::StandardEvent::MakeShared();
+    eudaq::StdEventConverter::Convert(evsp, stdev_cvt, nullptr); //no conf
+    stdev = stdev_cvt;
   }
-    
-  my_event_processing_time.Start(true);
 
   uint32_t num = stdev->NumPlanes();
+  cv.planes = num;
 
-  SimpleStandardEvent simpEv;
-  // store the processing time of the previous EVENT, as we can't track this during the  processing
-  simpEv.setMonitor_eventanalysistime(previous_event_analysis_time);
-  simpEv.setMonitor_eventfilltime(previous_event_fill_time);
-  simpEv.setMonitor_eventclusteringtime(previous_event_clustering_time);
-  simpEv.setMonitor_eventcorrelationtime(previous_event_correlation_time);
+  std::shared_ptr<SimpleStandardEvent> simpEv(new SimpleStandardEvent);
   // add some info into the simple event header
-  simpEv.setEvent_number(stdev->GetEventNumber());
-  simpEv.setEvent_timestamp(stdev->GetTimestampBegin());
+  simpEv->setEvent_number(stdev->GetEventNumber());
+  simpEv->setEvent_timestamp(stdev->GetTimestampBegin());
     
   for (unsigned int i = 0; i < num;i++){
     const eudaq::StandardPlane & plane = stdev->GetPlane(i);
@@ -251,54 +264,231 @@ void RootMonitor::DoReceive(eudaq::EventSP evsp) {
         }          
       }
     }
-    simpEv.addPlane(simpPlane);
+    simpEv->addPlane(simpPlane);
+  }
+  TStopwatch clustering_time;
+  clustering_time.Start(true);
+  simpEv->doClustering();
+  clustering_time.Stop();
+  cv.clustering_time = clustering_time.RealTime();
+
+  processing_time.Stop();
+  cv.analysis_time = processing_time.RealTime();
+  cv.simpEv = simpEv;
+  return cv;
+}
+
+void RootMonitor::releaseEvent(Converted &cv) {
+  // called for one event at a time in the order of arrival
+  uint32_t ev_plane_c = cv.planes;
+  if(m_ev_rec_n < 10){
+    m_ev_rec_n ++;
+    if(ev_plane_c > m_plane_c){
+      m_plane_c = ev_plane_c;
+    }
+    return;
+  }
+
+  if(ev_plane_c != m_plane_c){
+    std::cout<< "Event #"<< cv.simpEv->getEvent_number()<< " has "<<ev_plane_c<<" plane(s), while we expect "<< m_plane_c <<" plane(s).  (Event is skipped)" <<std::endl;
+    return;
   }
-  my_event_inner_operations_time.Start(true);
-  simpEv.doClustering();
-  my_event_inner_operations_time.Stop();
-  previous_event_clustering_time = my_event_inner_operations_time.RealTime();
+
+  SimpleStandardEvent &simpEv = *cv.simpEv;
+  // store the processing time of the previous EVENT, as we can't track this during the  processing
+  simpEv.setMonitor_eventanalysistime(previous_event_analysis_time);
+  simpEv.setMonitor_eventfilltime(previous_event_fill_time);
+  simpEv.setMonitor_eventclusteringtime(previous_event_clustering_time);
+  simpEv.setMonitor_eventcorrelationtime(previous_event_correlation_time);
+  previous_event_analysis_time = cv.analysis_time;
+  previous_event_clustering_time = cv.clustering_time;
 
   if(!_planesInitialized){
       std::this_thread::sleep_for(std::chrono::seconds(1));
       _planesInitialized = true;
   }
 
-  //stop the Stop watch
-  my_event_processing_time.Stop();
-  previous_event_analysis_time=my_event_processing_time.RealTime();
-  //Filling
-  my_event_processing_time.Start(true); //start the stopwatch again
-  for (unsigned int i = 0 ; i < _colls.size(); ++i)
+  if(m_fill_workers.empty()){
+    //Filling
+    my_event_processing_time.Start(true);
+    for (unsigned int i = 0 ; i < _colls.size(); ++i)
+      fillCollection(_colls.at(i), simpEv);
+    my_event_processing_time.Stop();
+    previous_event_fill_time=my_event_processing_time.RealTime();
+  }
+  else{
+    // every collection gets the same read-only event, the slowest one
+    // determines the fill time
+    std::shared_ptr<const SimpleStandardEvent> ev = cv.simpEv;
+    double fill_time = 0;
+    for(auto &w: m_fill_workers){
+      std::unique_lock<std::mutex> lk(w->mx);
+      w->cv.wait(lk, [&w](){return w->queue.size() < 64;});
+      w->queue.push_back(ev);
+      lk.unlock();
+      w->cv.notify_all();
+      fill_time = std::max(fill_time, w->time.load());
+    }
+    previous_event_fill_time = fill_time;
+  }
+
+  onlinemon->setEventNumber(simpEv.getEvent_number());
+  onlinemon->increaseAnalysedEventsCounter();
+}
+
+void RootMonitor::fillCollection(BaseCollection *coll, const SimpleStandardEvent &simpEv) {
+  if (coll == corrCollection)
     {
-      if (_colls.at(i) == corrCollection)
+      TStopwatch correlation_time;
+      correlation_time.Start(true);
+      if (getUseTrack_corr() == true)
         {
-          my_event_inner_operations_time.Start(true);
-          if (getUseTrack_corr() == true)
-            {
-              tracksPerEvent = corrCollection->FillWithTracks(simpEv);
-              if (eudaqCollection->getEUDAQMonitorHistos() != NULL) //workaround because Correlation Collection is before EUDAQ Mon collection
-                eudaqCollection->getEUDAQMonitorHistos()->Fill(simpEv.getEvent_number(), tracksPerEvent);
-            }
-          else
-            _colls.at(i)->Fill(simpEv);
-          my_event_inner_operations_time.Stop();
-          previous_event_correlation_time = my_event_inner_operations_time.RealTime();
+          tracksPerEvent = corrCollection->FillWithTracks(simpEv);
+          if (eudaqCollection->getEUDAQMonitorHistos() != NULL) //workaround because Correlation Collection is before EUDAQ Mon collection
+            eudaqCollection->getEUDAQMonitorHistos()->Fill(simpEv.getEvent_number(), tracksPerEvent);
         }
       else
-        _colls.at(i)->Fill(simpEv);
+        coll->Fill(simpEv);
+      correlation_time.Stop();
+      previous_event_correlation_time = correlation_time.RealTime();
+    }
+  else
+    coll->Fill(simpEv);
 
-      // CollType is used to check which kind of Collection we are having
-      if (_colls.at(i)->getCollectionType()==HITMAP_COLLECTION_TYPE) // Calculate is only implemented for HitMapCollections
-        {
-          _colls.at(i)->Calculate(stdev->GetEventNumber());
-        }
+  // CollType is used to check which kind of Collection we are having
+  if (coll->getCollectionType()==HITMAP_COLLECTION_TYPE) // Calculate is only implemented for HitMapCollections
+    {
+      coll->Calculate(simpEv.getEvent_number());
     }
+}
 
-  onlinemon->setEventNumber(stdev->GetEventNumber());
-  onlinemon->increaseAnalysedEventsCounter();
-    
-  my_event_processing_time.Stop();
-  previous_event_fill_time=my_event_processing_time.RealTime();
+void RootMonitor::converting(size_t i) {
+  auto &queue = m_conv_queues[i];
+  std::unique_lock<std::mutex> lk(m_conv_mx);
+  while(true){
+    m_conv_cv.wait(lk, [this, &queue](){return !queue.empty() || m_conv_exit;});
+    if(m_conv_exit)
+      break;
+    auto job = queue.front();
+    queue.pop_front();
+    m_conv_busy ++;
+    lk.unlock();
+    m_conv_cv_space.notify_all();
+    Converted cv;
+    try{
+      cv = convertEvent(job.second);
+    }
+    catch(const std::exception &e){
+      std::cerr << "OnlineMon: conversion of event " << job.second->GetEventN()
+                << " failed: " << e.what() << std::endl;
+    }
+    lk.lock();
+    m_conv_busy --;
+    m_reorder[job.first] = cv;
+    if(m_releasing)
+      continue;
+    // this thread hands the converted events on until none is ready
+    m_releasing = true;
+    while(!m_reorder.empty() && m_reorder.begin()->first == m_seq_out){
+      Converted next = m_reorder.begin()->second;
+      m_reorder.erase(m_reorder.begin());
+      m_seq_out ++;
+      lk.unlock();
+      if(next.simpEv)
+        releaseEvent(next);
+      lk.lock();
+    }
+    m_releasing = false;
+  }
+}
+
+void RootMonitor::filling(FillWorker *w) {
+  std::unique_lock<std::mutex> lk(w->mx);
+  while(true){
+    w->cv.wait(lk, [w](){return !w->queue.empty() || w->exit;});
+    if(w->exit)
+      break;
+    auto ev = w->queue.front();
+    w->queue.pop_front();
+    w->busy = true;
+    lk.unlock();
+    w->cv.notify_all();
+    TStopwatch fill_time;
+    fill_time.Start(true);
+    fillCollection(w->coll, *ev);
+    fill_time.Stop();
+    w->time = fill_time.RealTime();
+    lk.lock();
+    w->busy = false;
+    w->cv.notify_all();
+  }
+}
+
+void RootMonitor::setThreads(const unsigned int n) {
+  stopPipeline();
+  m_threads = n;
+  startPipeline();
+}
+
+void RootMonitor::startPipeline() {
+  if(!m_threads)
+    return;
+  m_conv_exit = false;
+  m_releasing = false;
+  m_conv_busy = 0;
+  m_conv_queues.assign(m_threads, std::deque<std::pair<uint64_t, eudaq::EventSPC>>());
+  for(unsigned int i = 0; i < m_threads; i++)
+    m_conv_threads.emplace_back(&RootMonitor::converting, this, i);
+  for(auto coll: _colls){
+    std::unique_ptr<FillWorker> w(new FillWorker);
+    w->coll = coll;
+    w->busy = false;
+    w->exit = false;
+    w->time = 0;
+    w->thread = std::thread(&RootMonitor::filling, this, w.get());
+    m_fill_workers.push_back(std::move(w));
+  }
+}
+
+void RootMonitor::stopPipeline() {
+  drainPipeline();
+  std::unique_lock<std::mutex> lk(m_conv_mx);
+  m_conv_exit = true;
+  lk.unlock();
+  m_conv_cv.notify_all();
+  for(auto &t: m_conv_threads)
+    t.join();
+  m_conv_threads.clear();
+  for(auto &w: m_fill_workers){
+    std::unique_lock<std::mutex> lk_w(w->mx);
+    w->exit = true;
+    lk_w.unlock();
+    w->cv.notify_all();
+    w->thread.join();
+  }
+  m_fill_workers.clear();
+}
+
+bool RootMonitor::pipelineIdle() {
+  std::unique_lock<std::mutex> lk(m_conv_mx);
+  for(auto &queue: m_conv_queues)
+    if(!queue.empty())
+      return false;
+  if(m_conv_busy || !m_reorder.empty() || m_releasing)
+    return false;
+  lk.unlock();
+  for(auto &w: m_fill_workers){
+    std::unique_lock<std::mutex> lk_w(w->mx);
+    if(!w->queue.empty() || w->busy)
+      return false;
+  }
+  return true;
+}
+
+void RootMonitor::drainPipeline() {
+  // all events received so far are in the histograms afterwards
+  while(!pipelineIdle())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
 }
 
 void RootMonitor::autoReset(const bool reset) {
@@ -307,6 +497,8 @@ void RootMonitor::autoReset(const bool reset) {
 
 void RootMonitor::DoStopRun()
 {
+  drainPipeline();
+  corrCollection->Flush();
   m_plane_c = 0;
   m_ev_rec_n = 0;
 
@@ -323,6 +515,7 @@ void RootMonitor::DoStopRun()
 }
 
 void RootMonitor::DoStartRun() {
+  drainPipeline();
   m_plane_c = 0;
   m_ev_rec_n = 0;
   uint32_t runnumber = GetRunNumber();
@@ -350,6 +543,8 @@ void RootMonitor::DoStartRun() {
 
 void RootMonitor::setUpdate(const unsigned int up) {
   onlinemon->setUpdate(up);
+  // the correlations need not be merged more often than they are drawn
+  corrCollection->setFlushInterval(up);
 }
 
 //sets the location for the snapshots
@@ -399,6 +594,7 @@ int main(int argc, const char ** argv) {
   eudaq::Option<unsigned>        corr_planes(op, "cp", "corr_planes",  5, "Minimum amount of planes for track reconstruction in the correlation");
   eudaq::Option<bool>            track_corr(op, "tc", "track_correlation", false, "Using (EXPERIMENTAL) track correlation(true) or cluster correlation(false)");
   eudaq::Option<int>             update(op, "u", "update",  1000, "update every ms");
+  eudaq::Option<unsigned>        threads(op, "th", "threads", 2, "number of threads converting events, 0 analyses everything in the receiving thread");
   eudaq::Option<uint32_t>        event_id_low(op, "e", "event_id_low",  0, "running is offlinemode - analyse begin event id <num>");
   eudaq::Option<uint32_t>        event_id_high(op, "E", "event_id_high", 0xffffffff, "running is offlinemode - analyse until event id <num>");
   eudaq::Option<uint32_t>        event_amount_max(op, "ea", "event_amount_max", 0xffffffff, "running is offlinemode - analyse until reach events amount");
@@ -424,6 +620,14 @@ int main(int argc, const char ** argv) {
   if(!rctrl.IsSet())
     rctrl.SetValue("tcp://localhost:44000");
     
+  if(threads.Value()){
+    // the collections book their histograms from their own threads
+#ifdef EUDAQ_LIB_ROOT6
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+  }
   TApplication theApp("App", &argc, const_cast<char**>(argv),0,0);
   RootMonitor mon(rctrl.Value(), 100, 0, 1400, 700, configfile.Value(), monitorname.Value());
   mon.setWriteRoot(do_rootatend.IsSet());
@@ -433,6 +637,7 @@ int main(int argc, const char ** argv) {
   mon.setCorr_width(corr_width.Value());
   mon.setCorr_planes(corr_planes.Value());
   mon.setUseTrack_corr(track_corr.Value());
+  mon.setThreads(threads.Value());
   eudaq::Monitor *m = dynamic_cast<eudaq::Monitor*>(&mon);
   std::future<uint64_t> fut_async_rd;
 
@@ -141,6 +141,21 @@ int OnlineMonConfiguration::ReadConfigurationFile() {
             planes_to_be_skipped.push_back(StringToNumber<int>(v[element]));
           }
 
+        } else if (key.compare("Pairs") == 0) {
+          correl_pairs = remove_this_character(value, '"');
+          if (correl_pairs != "all" && correl_pairs != "neighbours" &&
+              correl_pairs != "reference") {
+            cerr << " Warning Illegal Pairs used, correlating all planes "
+                 << endl;
+            correl_pairs = "all";
+          }
+        } else if (key.compare("ReferencePlanes") == 0) {
+          vector<string> v;
+          stringsplit(value, ',', v);
+          reference_planes.clear();
+          for (unsigned int element = 0; element < v.size(); element++) {
+            reference_planes.push_back(StringToNumber<int>(v[element]));
+          }
         } else {
           cerr << "Unknown Key " << key << endl;
         }
@@ -200,6 +215,8 @@ void OnlineMonConfiguration::SetDefaults() {
 
   // correl cluster settings
   correl_minclustersize = 1;
+  correl_pairs = "all";
+  reference_planes.assign(1, 0);
 }
 
 void OnlineMonConfiguration::setSnapShotDir(string SnapShotDir) {
@@ -254,6 +271,12 @@ void OnlineMonConfiguration::PrintConfiguration() {
     cout << planes_to_be_skipped[i] << " ";
   }
   cout << endl;
+  cout << "Pairs               : " << correl_pairs << endl;
+  cout << "Reference planes    : ";
+  for (unsigned int i = 0; i < reference_planes.size(); i++) {
+    cout << reference_planes[i] << " ";
+  }
+  cout << endl;
   cout << "Clusterizer Settings" << endl;
   cout << "HotPixelFinder Settings" << endl;
   cout << "HotPixelCut         : " << hotpixelcut << endl;
@@ -287,6 +310,20 @@ void OnlineMonConfiguration::setPlanes_to_be_skipped(
   this->planes_to_be_skipped = planes_to_be_skipped;
 }
 
+string OnlineMonConfiguration::getCorrel_pairs() const { return correl_pairs; }
+
+void OnlineMonConfiguration::setCorrel_pairs(string correl_pairs) {
+  this->correl_pairs = correl_pairs;
+}
+
+vector<int> OnlineMonConfiguration::getReference_planes() const {
+  return reference_planes;
+}
+
+void OnlineMonConfiguration::setReference_planes(vector<int> reference_planes) {
+  this->reference_planes = reference_planes;
+}
+
 // splits a string separated by a charact into a vector of substrings
 unsigned int OnlineMonConfiguration::stringsplit(string str, char c,
                                                  vector<string> &v) {
@@ -267,6 +267,7 @@ void OnlineMonWindow::About() {
 }
 
 void OnlineMonWindow::registerTreeItem(std::string item) {
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
   if (item.find("/") == std::string::npos) { // Yes
     _treeMap[item] = LTr_left->AddItem(NULL, item.c_str());
     _treeBackMap[_treeMap[item]] = item;
@@ -286,6 +287,7 @@ void OnlineMonWindow::registerTreeItem(std::string item) {
 }
 
 void OnlineMonWindow::makeTreeItemSummary(std::string item) {
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
   std::map<std::string, TNamed *>::iterator it;
   std::vector<std::string> v;
   for (it = _hitmapMap.begin(); it != _hitmapMap.end(); ++it) {
@@ -299,6 +301,7 @@ void OnlineMonWindow::makeTreeItemSummary(std::string item) {
 
 void OnlineMonWindow::addTreeItemSummary(std::string item,
                                          std::string histoitem) {
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
 
   std::vector<std::string> v;
   std::map<std::string, std::string>::iterator it;
@@ -311,6 +314,7 @@ void OnlineMonWindow::addTreeItemSummary(std::string item,
 
 void OnlineMonWindow::registerHisto(std::string tree, TNamed *h, std::string op,
                                     const unsigned int l) {
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
   if (h == NULL) // check if valid histogram
   {
     cout << "OnlineMonWindow::registerHisto Null pointer for entry " << op
@@ -333,6 +337,7 @@ void OnlineMonWindow::registerHisto(std::string tree, TNamed *h, std::string op,
 }
 
 void OnlineMonWindow::registerMutex(std::string tree, std::mutex *m){
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
   _mutexMap[tree] = m;
 }
 
@@ -340,6 +345,9 @@ void OnlineMonWindow::autoUpdate() {
   _reduceUpdate++;
   unsigned int activeHistoSize = _activeHistos.size();
   if (activeHistoSize && _reduceUpdate > activeHistoSize){
+    // buffered fills are otherwise only merged while events keep coming
+    for (unsigned int i = 0; i < _colls.size(); ++i)
+      _colls.at(i)->Flush();
     TCanvas *fCanvas = ECvs_right->GetCanvas();
     for (unsigned int i = 0; i < activeHistoSize; ++i) {
       if(activeHistoSize ==1){
@@ -351,23 +359,26 @@ void OnlineMonWindow::autoUpdate() {
 	fCanvas->cd(i + 1);
       }
       std::string tree = _activeHistos.at(i);
+      std::unique_lock<std::recursive_mutex> lk_map(_mapMutex);
       TNamed *hg = _hitmapMap[tree];
+      std::string option = _hitmapOptions[tree];
+      std::mutex mu_dummy;
+      std::mutex *mu = &mu_dummy;
+      auto it = _mutexMap.find(tree);
+      if(it != _mutexMap.end())
+	mu=it->second;
+      lk_map.unlock();
       if(hg) {
 	TH1 *h = dynamic_cast<TH1 *> (hg);
-	std::mutex mu_dummy;
-	std::mutex *mu = &mu_dummy;
-	auto it = _mutexMap.find(tree);
-	if(it != _mutexMap.end())
-	  mu=it->second;
 	if(h){
 	  std::lock_guard<std::mutex> lck(*mu);
-	  h->Draw(_hitmapOptions[tree].c_str());
+	  h->Draw(option.c_str());
 	  gPad->Update();
 	}
 	TGraph *g = dynamic_cast<TGraph *> (hg);
 	if(g){
 	  std::lock_guard<std::mutex> lck(*mu);
-	  g->Draw(_hitmapOptions[tree].c_str());
+	  g->Draw(option.c_str());
 	  gPad->Update();
 	}
       }
@@ -404,6 +415,7 @@ void OnlineMonWindow::actor(TGListTreeItem *item, Int_t /*btn*/) {
   TCanvas *fCanvas = ECvs_right->GetCanvas();
   fCanvas->Clear();
 
+  std::lock_guard<std::recursive_mutex> lck(_mapMutex);
   std::string tree = _treeBackMap[item];
 
   _activeHistos.clear();
@@ -1,13 +1,16 @@
 #include "eudaq/Monitor.hh"
 #include "eudaq/ROOTMonitorWindow.hh"
+#include "eudaq/TimeSeries.hh"
 
 #ifndef __CINT__
 # include "TApplication.h"
 # include "RQ_OBJECT.h"
 #endif
 
+#include <chrono>
+
 class TH1D;
-class TGraph;
+class TGraphAsymmErrors;
 
 namespace eudaq {
   class ROOTMonitor : public Monitor {
@@ -35,6 +38,7 @@ namespace eudaq {
 
   private:
     void LoadRAWFile(const std::string& path);
+    void UpdateTimeSeries();
 
     bool m_interrupt = false;
     std::unique_ptr<TApplication> m_app;
@@ -44,8 +48,12 @@ namespace eudaq {
 
     // global monitoring plots
     TH1D* m_glob_evt_reco_time, *m_glob_evt_num_subevt;
-    TGraph* m_glob_evt_vs_ts, *m_glob_rate_vs_ts;
+    TGraphAsymmErrors* m_glob_evt_vs_ts = nullptr, *m_glob_rate_vs_ts = nullptr;
     unsigned long long m_glob_last_evt_ts = 0ull;
+    // the time series behind the graphs, of bounded size for any run length
+    TimeSeries m_glob_evt_series, m_glob_rate_series;
+    int m_glob_ts_points = 0;
+    std::chrono::steady_clock::time_point m_glob_next_ts_update;
 
   protected:
     std::unique_ptr<ROOTMonitorWindow> m_monitor;
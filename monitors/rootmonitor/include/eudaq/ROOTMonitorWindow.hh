@@ -152,7 +152,7 @@ namespace eudaq{
     std::map<std::string, const TGPicture*> m_obj_icon = {
       {"TH1", m_icon_th1}, {"TH1F", m_icon_th1}, {"TH1D", m_icon_th1}, {"TH1I", m_icon_th1},
       {"TH2", m_icon_th2}, {"TH2F", m_icon_th2}, {"TH2D", m_icon_th2}, {"TH2I", m_icon_th2},
-      {"TGraph", m_icon_tgraph}, {"TMultiGraph", m_icon_track}
+      {"TGraph", m_icon_tgraph}, {"TGraphAsymmErrors", m_icon_tgraph}, {"TMultiGraph", m_icon_track}
     };
     /// List of all objects to be drawn on main canvas
     std::vector<MonitoredObject*> m_drawable;
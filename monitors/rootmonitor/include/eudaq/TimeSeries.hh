@@ -0,0 +1,55 @@
+#ifndef EUDAQ_INCLUDED_TimeSeries
+#define EUDAQ_INCLUDED_TimeSeries
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace eudaq {
+  /// A time series of bounded memory, for monitoring plots over long runs.
+  /// Points are summarised per time bucket (mean, minimum, maximum) in
+  /// fixed-size rings at several resolutions, each level's buckets being
+  /// `ratio` times wider than the previous one's. The finer levels keep the
+  /// most recent buckets only, the bucket width doubles whenever the coarsest
+  /// level can no longer hold the whole series.
+  class TimeSeries {
+  public:
+    struct Bucket {
+      double time = 0.; ///< start of the bucket
+      double min = 0., max = 0., sum = 0.;
+      uint64_t n = 0;
+      double Mean() const { return n ? sum/n : 0.; }
+    };
+    explicit TimeSeries(size_t size = 1000, size_t levels = 3, unsigned ratio = 8);
+
+    /// Add a point, points before the first one are ignored
+    void Fill(double time, double value);
+    void Clear();
+
+    size_t Levels() const { return m_levels.size(); }
+    /// Width of the buckets in a level
+    double Width(size_t level) const;
+    /// The non-empty buckets of a level, oldest first
+    std::vector<Bucket> Buckets(size_t level) const;
+    /// The finest level still holding the whole series
+    size_t CoveringLevel() const;
+    uint64_t Entries() const { return m_entries; }
+
+  private:
+    struct Level {
+      std::vector<Bucket> ring;
+      int64_t head = -1; ///< index of the newest bucket since the origin
+      double width = 1.;
+    };
+    void Add(Level& lvl, int64_t index, double value) const;
+    void Widen();
+
+    std::vector<Level> m_levels;
+    size_t m_size;
+    unsigned m_ratio;
+    double m_origin = 0.;
+    uint64_t m_entries = 0;
+  };
+}
+
+#endif
@@ -4,13 +4,33 @@
 #include "eudaq/DataConverter.hh"
 
 #include "TH1.h"
-#include "TGraph.h"
+#include "TGraphAsymmErrors.h"
 
 #include <ratio>
 #include <chrono>
 #include <thread>
 
 namespace eudaq {
+  namespace {
+    /// how often the time series graphs are redrawn from their series
+    const auto kTimeSeriesInterval = std::chrono::seconds(1);
+
+    /// Show the finest resolution still spanning the whole series, with the
+    /// spread of the values in each time bucket as error bars
+    void FillGraph(TGraphAsymmErrors* gr, const TimeSeries& ts){
+      const size_t level = ts.CoveringLevel();
+      const double half_width = 0.5*ts.Width(level);
+      const auto buckets = ts.Buckets(level);
+      gr->Set(buckets.size());
+      for (size_t i = 0; i < buckets.size(); ++i) {
+        const auto& bucket = buckets.at(i);
+        const double mean = bucket.Mean();
+        gr->SetPoint(i, bucket.time+half_width, mean);
+        gr->SetPointError(i, 0., 0., mean-bucket.min, bucket.max-mean);
+      }
+    }
+  }
+
   ROOTMonitor::ROOTMonitor(const std::string & name, const std::string & title, const std::string & runcontrol)
     :Monitor(name, runcontrol),
      m_app(new TApplication(name.c_str(), nullptr, nullptr)),
@@ -37,9 +57,9 @@ namespace eudaq {
     m_glob_evt_num_subevt = m_monitor->Book<TH1D>("Global/num_subevts", "Number of sub-events",
                                                   "num_subevts", ";Number of sub-events", 10, 0., 10.);
     m_monitor->SetDrawOptions(m_glob_evt_num_subevt, "hist text0");
-    m_glob_evt_vs_ts = m_monitor->Book<TGraph>("Global/evt_vs_ts", "Event timestamp");
+    m_glob_evt_vs_ts = m_monitor->Book<TGraphAsymmErrors>("Global/evt_vs_ts", "Event timestamp");
     m_glob_evt_vs_ts->SetTitle(";Time (s);Event ID");
-    m_glob_rate_vs_ts = m_monitor->Book<TGraph>("Global/rate_vs_ts", "Rate evolution");
+    m_glob_rate_vs_ts = m_monitor->Book<TGraphAsymmErrors>("Global/rate_vs_ts", "Rate evolution");
     m_glob_rate_vs_ts->SetTitle(";Time (s);Event rate (Hz)");
   }
 
@@ -53,6 +73,10 @@ namespace eudaq {
     m_monitor->ResetCounters();
     m_monitor->SetStatus(eudaq::Status::STATE_RUNNING);
     m_monitor->SetRunNumber(GetRunNumber());
+    // the event timestamps restart with the run
+    m_glob_evt_series.Clear();
+    m_glob_rate_series.Clear();
+    m_glob_last_evt_ts = 0ull;
     AtRunStart();
   }
 
@@ -67,15 +91,32 @@ namespace eudaq {
     m_glob_evt_reco_time->Fill(elapsed_sec.count()*1.e3);
     m_glob_evt_num_subevt->Fill(ev->GetNumSubEvent());
     if (ev->GetTimestampBegin() != 0) {
-      m_glob_evt_vs_ts->SetPoint(m_glob_evt_vs_ts->GetN(), ev->GetTimestampBegin(), ev->GetEventID());
+      m_glob_evt_series.Fill(ev->GetTimestampBegin(), ev->GetEventID());
       const double rate = (ev->GetTimestampBegin() != m_glob_last_evt_ts)
         ? 1./(ev->GetTimestampBegin()-m_glob_last_evt_ts) : 0.;
-      m_glob_rate_vs_ts->SetPoint(m_glob_rate_vs_ts->GetN(), ev->GetTimestampBegin(), rate);
+      m_glob_rate_series.Fill(ev->GetTimestampBegin(), rate);
       m_glob_last_evt_ts = ev->GetTimestampBegin();
+      if (std::chrono::steady_clock::now() >= m_glob_next_ts_update)
+        UpdateTimeSeries();
+    }
+  }
+
+  void ROOTMonitor::UpdateTimeSeries(){
+    if (!m_glob_evt_vs_ts || !m_glob_rate_vs_ts)
+      return;
+    // the window empties the graphs when it clears its monitors
+    if (m_glob_evt_vs_ts->GetN() < m_glob_ts_points) {
+      m_glob_evt_series.Clear();
+      m_glob_rate_series.Clear();
     }
+    FillGraph(m_glob_evt_vs_ts, m_glob_evt_series);
+    FillGraph(m_glob_rate_vs_ts, m_glob_rate_series);
+    m_glob_ts_points = m_glob_evt_vs_ts->GetN();
+    m_glob_next_ts_update = std::chrono::steady_clock::now()+kTimeSeriesInterval;
   }
 
   void ROOTMonitor::DoStopRun(){
+    UpdateTimeSeries();
     m_monitor->SetStatus(eudaq::Status::STATE_STOPPED);
     AtRunStop();
   }
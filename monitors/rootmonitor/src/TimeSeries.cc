@@ -0,0 +1,110 @@
+#include "eudaq/TimeSeries.hh"
+
+#include <cmath>
+#include <algorithm>
+
+namespace eudaq {
+  TimeSeries::TimeSeries(size_t size, size_t levels, unsigned ratio)
+    :m_levels(std::max<size_t>(levels, 1)), m_size(std::max<size_t>(size, 2)),
+     m_ratio(std::max(ratio, 2u)){
+    Clear();
+  }
+
+  void TimeSeries::Clear(){
+    double width = 1.;
+    for (auto& lvl : m_levels) {
+      lvl.ring.assign(m_size, Bucket());
+      lvl.head = -1;
+      lvl.width = width;
+      width *= m_ratio;
+    }
+    m_origin = 0.;
+    m_entries = 0;
+  }
+
+  double TimeSeries::Width(size_t level) const {
+    return m_levels.at(level).width;
+  }
+
+  void TimeSeries::Fill(double time, double value){
+    if (!m_entries)
+      m_origin = time;
+    if (time < m_origin)
+      return;
+    // the coarsest level spans the whole series
+    while ((time-m_origin)/m_levels.back().width >= m_size)
+      Widen();
+    for (auto& lvl : m_levels)
+      Add(lvl, (int64_t)std::floor((time-m_origin)/lvl.width), value);
+    ++m_entries;
+  }
+
+  void TimeSeries::Add(Level& lvl, int64_t index, double value) const {
+    if (index > lvl.head) { // empty the buckets taken over by the ring
+      for (int64_t i = std::max(lvl.head+1, index-(int64_t)m_size+1); i <= index; ++i)
+        lvl.ring[i%m_size] = Bucket();
+      lvl.head = index;
+    }
+    else if (index <= lvl.head-(int64_t)m_size) // older than the ring
+      return;
+    auto& b = lvl.ring[index%m_size];
+    if (!b.n) {
+      b.time = m_origin+index*lvl.width;
+      b.min = b.max = value;
+    }
+    else {
+      b.min = std::min(b.min, value);
+      b.max = std::max(b.max, value);
+    }
+    b.sum += value;
+    ++b.n;
+  }
+
+  void TimeSeries::Widen(){
+    // every level merges its buckets pairwise
+    std::vector<Bucket> ring(m_size);
+    for (auto& lvl : m_levels) {
+      std::fill(ring.begin(), ring.end(), Bucket());
+      lvl.width *= 2.;
+      if (lvl.head >= 0) {
+        for (int64_t i = std::max<int64_t>(0, lvl.head-(int64_t)m_size+1); i <= lvl.head; ++i) {
+          const auto& b = lvl.ring[i%m_size];
+          if (!b.n)
+            continue;
+          auto& m = ring[(i/2)%m_size];
+          if (!m.n) {
+            m = b;
+            m.time = m_origin+(i/2)*lvl.width;
+          }
+          else {
+            m.min = std::min(m.min, b.min);
+            m.max = std::max(m.max, b.max);
+            m.sum += b.sum;
+            m.n += b.n;
+          }
+        }
+        lvl.head /= 2;
+      }
+      lvl.ring.swap(ring);
+    }
+  }
+
+  std::vector<TimeSeries::Bucket> TimeSeries::Buckets(size_t level) const {
+    const auto& lvl = m_levels.at(level);
+    std::vector<Bucket> out;
+    if (lvl.head < 0)
+      return out;
+    out.reserve(m_size);
+    for (int64_t i = std::max<int64_t>(0, lvl.head-(int64_t)m_size+1); i <= lvl.head; ++i)
+      if (lvl.ring[i%m_size].n)
+        out.push_back(lvl.ring[i%m_size]);
+    return out;
+  }
+
+  size_t TimeSeries::CoveringLevel() const {
+    for (size_t i = 0; i < m_levels.size(); ++i)
+      if (m_levels[i].head < (int64_t)m_size)
+        return i;
+    return m_levels.size()-1;
+  }
+}
@@ -2,6 +2,8 @@
 #define AHCALPRODUCER_HH
 
 #include "eudaq/Producer.hh"
+#include "eudaq/Configuration.hh"
+#include "LdaBuffer.hh"
 
 #include <vector>
 #include <deque>
@@ -16,7 +18,7 @@ namespace eudaq {
 
    class AHCALReader {
       public:
-         virtual void Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) = 0;
+         virtual void Read(LdaBuffer & buf, std::deque<eudaq::EventUP> & deqEvent) = 0;
          virtual void buildEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) {
          }
          virtual void OnStart(int runNo) {
@@ -68,6 +70,9 @@ namespace eudaq {
          void SendCommand(const char *command, int size = 0);
 
          void OpenRawFile(unsigned param, bool _writerawfilename_timestamp);
+         // feeds a raw LDA dump (as written with WriteRawOutput) through the reader without
+         // connection and data collector, and prints the throughput
+         void Replay(const std::string &filename, const eudaq::Configuration &param, size_t chunk);
          void sendallevents(std::deque<eudaq::EventUP> &deqEvent, int minimumsize);
 
          AHCALProducer::EventBuildingMode getEventMode() const;
@@ -83,6 +88,8 @@ namespace eudaq {
          int getIgnoreLdaTimestamps() const;
 
       private:
+         void ReadConfiguration(const eudaq::Configuration &param);
+
          AHCALProducer::EventBuildingMode _eventBuildingMode;
          AHCALProducer::EventNumbering _eventNumberingPreference;
          int _LdaTrigidOffset; //LdaTrigidOffset to compensate trigger number differences between TLU (or other trigger number source) and LDA. Eudaq Event counting starts from this number and will be always subtracted from the eudaq event triggerid.
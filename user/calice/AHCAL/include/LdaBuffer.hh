@@ -0,0 +1,51 @@
+#ifndef LDABUFFER_HH
+#define LDABUFFER_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace eudaq {
+
+   // Receive buffer for the LDA byte stream. Data are read in bulk into the
+   // free space after the end and consumed from the front. The unconsumed
+   // bytes are moved back to the start only when the free space runs out,
+   // so a packet is always contiguous in memory.
+   class LdaBuffer {
+      public:
+         explicit LdaBuffer(size_t capacity = 1 << 20);
+
+         size_t size() const {
+            return _end - _begin;
+         }
+         bool empty() const {
+            return _end == _begin;
+         }
+         const unsigned char * data() const {
+            return _buf.data() + _begin;
+         }
+         unsigned char operator[](size_t i) const {
+            return _buf[_begin + i];
+         }
+
+         // drops n bytes from the front
+         void consume(size_t n);
+         void clear();
+
+         // returns room for at least n bytes after the end, to be filled and then committed
+         unsigned char * prepare(size_t n);
+         void commit(size_t n);
+         void append(const void *data, size_t n);
+
+         // index of the first byte at or after from, which is one of the nset bytes
+         // in set, size() if there is none
+         size_t findAny(const unsigned char *set, size_t nset, size_t from = 0) const;
+
+      private:
+         std::vector<unsigned char> _buf;
+         size_t _begin;
+         size_t _end;
+   };
+
+}
+
+#endif // LDABUFFER_HH
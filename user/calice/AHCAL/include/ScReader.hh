@@ -10,14 +10,16 @@ namespace eudaq {
 
    class ScReader: public AHCALReader {
       public:
-         virtual void Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) override;
+         virtual void Read(LdaBuffer & buf, std::deque<eudaq::EventUP> & deqEvent) override;
          virtual void OnStart(int runNo) override;
          virtual void OnStop(int waitQueueTimeS) override;
          virtual void OnConfigLED(std::string _fname) override; //chose configuration file for LED runs
          virtual void buildEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) override;
 
          virtual std::deque<eudaq::RawEvent *> NewEvent_createRawDataEvent(std::deque<eudaq::RawEvent *> deqEvent, bool tempcome, int LdaRawcycle, bool newForced);
-         virtual void readTemperature(std::deque<char>& buf);
+         virtual void readTemperature(LdaBuffer& buf);
+         // resets the state of the reader for a new run, without connecting
+         void Reset(int runNo);
 
          void appendOtherInfo(eudaq::RawEvent * ev);
 
@@ -42,6 +44,24 @@ namespace eudaq {
 
          };
 
+         // ASIC packets of one readout cycle, one memory cell of one ASIC each, one after the other
+         // in the format of their data block: CycleNr, BunchXID, EvtNr, ChipID, NChannels, TDC[NChannels], ADC[NChannels]
+         struct AsicPackets {
+               static const int C_CHANNELS = 36;
+               static const size_t C_WORDS = 5 + 2 * C_CHANNELS;
+               std::vector<int> words;
+               size_t size() const {
+                  return words.size() / C_WORDS;
+               }
+               const int * packet(size_t i) const {
+                  return words.data() + i * C_WORDS;
+               }
+               int * append() {
+                  words.resize(words.size() + C_WORDS);
+                  return &words[words.size() - C_WORDS];
+               }
+         };
+
          struct RunTimeStatistics {
                void clear();
                void append(const RunTimeStatistics& otherStats);
@@ -90,6 +110,8 @@ namespace eudaq {
          void buildValidatedBXIDEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll);
          void insertDummyEvent(std::deque<eudaq::EventUP> &EventQueue, int eventNumber, int triggerid, bool triggeridFlag);
          void prepareEudaqRawPacket(eudaq::RawEvent * ev);
+         void addAsicBlock(eudaq::RawEvent * ev, const int *packet);
+         void eraseFirstROC(); //erases the oldest readout cycle from _LDAAsicData, keeping its memory for the next ones
 
          static const unsigned char C_TSTYPE_START_ACQ = 0x01;
          static const unsigned char C_TSTYPE_STOP_ACQ = 0x02;
@@ -101,8 +123,8 @@ namespace eudaq {
          static const unsigned int C_TS_IGNORE_ROC_JUMPS_UP_TO = 20;
          static const uint64_t C_MILLISECOND_TICS = 40000; //how many clock cycles make a millisecond
 
-         void readAHCALData(std::deque<char> &buf, std::map<int, std::vector<std::vector<int> > > &AHCALData);
-         void readLDATimestamp(std::deque<char> &buf, std::map<int, LDATimeData> &LDATimestamps);
+         void readAHCALData(LdaBuffer &buf, std::map<int, AsicPackets> &AHCALData);
+         void readLDATimestamp(LdaBuffer &buf, std::map<int, LDATimeData> &LDATimestamps);
 
          UnfinishedPacketStates _unfinishedPacketState;
 
@@ -124,7 +146,8 @@ namespace eudaq {
 
          std::map<int, LDATimeData> _LDATimestampData;          //maps READOUTCYCLE to LDA timestamps for that cycle (comes asynchronously with the data and tends to arrive before the ASIC packets)
 
-         std::map<int, std::vector<std::vector<int> > > _LDAAsicData;              //maps readoutcycle to vector of "infodata"
+         std::map<int, AsicPackets> _LDAAsicData;              //maps readoutcycle to its ASIC packets
+         std::vector<std::vector<int> > _spareAsicWords; //memory of erased readout cycles, reused for the next ones
 
          RunTimeStatistics _RunTimesStatistics;
    }
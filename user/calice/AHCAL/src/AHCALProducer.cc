@@ -13,6 +13,7 @@
 #include <iterator>
 #include <thread>
 #include <mutex>
+#include <chrono>
 
 #ifdef _WIN32
 #pragma comment(lib, "Ws2_32.lib")
@@ -71,6 +72,23 @@ namespace eudaq {
    void AHCALProducer::DoConfigure() {
       const eudaq::Configuration &param = *GetConfiguration();
       std::cout << " START AHCAL CONFIGURATION " << std::endl;
+      ReadConfiguration(param);
+
+      if (!_reader) {
+         SetReader(new ScReader(this));
+      }
+      //      if (_reader != nullptr)
+      //         SetReader(std::unique_ptr<ScReader>(new ScReader(this))); // in sc dif ID is not specified
+
+      _reader->OnConfigLED(_fileLEDsettings); //newLED
+
+      //_configured = true;
+
+      std::cout << " END AHCAL congfiguration " << std::endl;
+
+   }
+
+   void AHCALProducer::ReadConfiguration(const eudaq::Configuration &param) {
       // run rype: LED run or normal run ""
       _fileLEDsettings = param.Get("FileLEDsettings", "");
 
@@ -89,13 +107,6 @@ namespace eudaq {
       _ipAddress = param.Get("IPAddress", "127.0.0.1");
 
       string reader = param.Get("Reader", "");
-      if (!_reader) {
-         SetReader(new ScReader(this));
-      }
-      //      if (_reader != nullptr)
-      //         SetReader(std::unique_ptr<ScReader>(new ScReader(this))); // in sc dif ID is not specified
-
-      _reader->OnConfigLED(_fileLEDsettings); //newLED
 
       _redirectedInputFileName = param.Get("RedirectInputFromFile", "");
       _ColoredTerminalMessages = param.Get("ColoredTerminalMessages", 1);
@@ -121,11 +132,6 @@ namespace eudaq {
       if (!eventNumberingMode.compare("TRIGGERID")) _eventNumberingPreference = AHCALProducer::EventNumbering::TRIGGERID;
       if (!eventNumberingMode.compare("TIMESTAMP")) _eventNumberingPreference = AHCALProducer::EventNumbering::TIMESTAMP;
       std::cout << "Preferring event numbering type: \"" << eventNumberingMode << "\"" << std::endl;
-
-      //_configured = true;
-
-      std::cout << " END AHCAL congfiguration " << std::endl;
-
    }
 
    void AHCALProducer::DoStartRun() {
@@ -335,14 +341,12 @@ namespace eudaq {
    void AHCALProducer::Exec() {
       std::cout << " Main loop " << std::endl;
       StartCommandReceiver();
-      deque<char> bufRead;
+      LdaBuffer bufRead;
       // deque for events: add one event when new acqId is arrived: to be determined in reader
 //      deque<eudaq::RawDataEvent *> deqEvent2;
       std::deque<eudaq::EventUP> deqEvent;
 
-      const int bufsize = 4 * 1024;
-      // copy to C array, then to vector
-      char buf[bufsize]; //buffer to read from TCP socket
+      const int bufsize = 64 * 1024; //maximum bytes per read from the TCP socket
 
       while (!_terminated) {
          // wait until configured and connected
@@ -355,15 +359,15 @@ namespace eudaq {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             continue;
          }
+         // read directly behind the data still in the buffer
+         unsigned char *buf = bufRead.prepare(bufsize);
          size = ::read(_fd, buf, bufsize);
          //std::cout << "DEBUG: producer Exec(): read" << size << " bytes" << std::endl;
          if (size > 0) {
             //_last_readout_time = std::time(NULL);
             if (_writeRaw && _rawFile.is_open())
-               _rawFile.write(buf, size);
-            // C array to vector
-            copy(buf, buf + size, back_inserter(bufRead));
-            //bufRead.insert(bufRead.end(), buf, buf + size);
+               _rawFile.write(reinterpret_cast<const char *>(buf), size);
+            bufRead.commit(size);
             if (_reader)
                _reader->Read(bufRead, deqEvent);
             // send events : remain the last event
@@ -394,6 +398,43 @@ namespace eudaq {
       }
    }
 
+   void AHCALProducer::Replay(const std::string &filename, const eudaq::Configuration &param, size_t chunk) {
+      ReadConfiguration(param);
+      std::ifstream in(filename, std::ios::binary);
+      if (!in.is_open()) EUDAQ_THROW("AHCALProducer: cannot open " + filename);
+      ScReader reader(this);
+      reader.Reset(0);
+      LdaBuffer bufRead;
+      std::deque<eudaq::EventUP> deqEvent;
+      uint64_t bytes = 0;
+      uint64_t events = 0;
+      uint64_t blocks = 0;
+      auto count = [&]() {
+         for (auto &ev : deqEvent) {
+            events++;
+            blocks += ev->NumBlocks() - 7; //the ASIC packets after the 7 fixed blocks
+         }
+         deqEvent.clear();
+      };
+      auto start = std::chrono::steady_clock::now();
+      while (in) {
+         unsigned char *buf = bufRead.prepare(chunk);
+         in.read(reinterpret_cast<char *>(buf), chunk);
+         size_t size = in.gcount();
+         if (!size) break;
+         bufRead.commit(size);
+         bytes += size;
+         reader.Read(bufRead, deqEvent);
+         count();
+      }
+      reader.buildEvents(deqEvent, true);
+      count();
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      reader.getRunTimesStatistics().print(std::cout, _ColoredTerminalMessages);
+      std::cout << "Replayed " << bytes << " bytes in " << seconds << " s: " << (bytes / seconds / 1E6) << " MB/s, "
+            << events << " events, " << blocks << " ASIC packets" << std::endl;
+   }
+
    AHCALProducer::EventBuildingMode AHCALProducer::getEventMode() const {
       return _eventBuildingMode;
    }
@@ -3,6 +3,7 @@
 #include "eudaq/OptionParser.hh"
 #include "eudaq/Utils.hh"
 #include <iostream>
+#include <fstream>
 
 #include "AHCALProducer.hh"
 
@@ -17,6 +18,12 @@ int main(int /*argc*/, const char ** argv) {
          "The minimum level for displaying log messages locally");
    eudaq::Option<std::string> name(op, "n", "", "Calice1", "string",
          "The name of this Producer");
+   eudaq::Option<std::string> replay(op, "f", "replay", "", "file",
+         "Replay a raw LDA dump through the reader instead of running, and print the throughput");
+   eudaq::Option<std::string> config(op, "c", "config", "", "file",
+         "The configuration file for the replay");
+   eudaq::Option<uint32_t> chunk(op, "b", "chunk", 65536, "bytes",
+         "The number of bytes read at once in the replay");
    try {
       // This will look through the command-line arguments and set the options
       op.Parse(argv);
@@ -25,6 +32,17 @@ int main(int /*argc*/, const char ** argv) {
       // Create a producer
       std::cout << name.Value() << " " << rctrl.Value() << std::endl;
       eudaq::AHCALProducer producer(name.Value(), rctrl.Value());
+      if (!replay.Value().empty()) {
+         eudaq::Configuration conf;
+         if (!config.Value().empty()) {
+            std::ifstream conffile(config.Value());
+            if (!conffile.is_open())
+               EUDAQ_THROW("Cannot open the configuration file " + config.Value());
+            conf = eudaq::Configuration(conffile, "Producer." + name.Value());
+         }
+         producer.Replay(replay.Value(), conf, chunk.Value());
+         return 0;
+      }
       //producer.SetReader(new eudaq::SiReader(0));
       // And set it running...
       // producer.MainLoop();
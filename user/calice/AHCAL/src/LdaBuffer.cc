@@ -0,0 +1,79 @@
+// LdaBuffer.cc
+#include "LdaBuffer.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace eudaq {
+
+   LdaBuffer::LdaBuffer(size_t capacity) :
+         _buf(capacity),
+               _begin(0),
+               _end(0) {
+   }
+
+   void LdaBuffer::consume(size_t n) {
+      _begin += std::min(n, size());
+      if (_begin == _end) _begin = _end = 0;
+   }
+
+   void LdaBuffer::clear() {
+      _begin = _end = 0;
+   }
+
+   unsigned char * LdaBuffer::prepare(size_t n) {
+      if (_buf.size() - _end < n) {
+         if (_begin) {
+            std::memmove(_buf.data(), _buf.data() + _begin, size());
+            _end -= _begin;
+            _begin = 0;
+         }
+         if (_buf.size() - _end < n) _buf.resize(std::max(2 * _buf.size(), _end + n));
+      }
+      return _buf.data() + _end;
+   }
+
+   void LdaBuffer::commit(size_t n) {
+      _end = std::min(_end + n, _buf.size());
+   }
+
+   void LdaBuffer::append(const void *data, size_t n) {
+      std::memcpy(prepare(n), data, n);
+      commit(n);
+   }
+
+   size_t LdaBuffer::findAny(const unsigned char *set, size_t nset, size_t from) const {
+      const unsigned char *p = data();
+      size_t n = size();
+      if (nset == 1) {
+         if (from >= n) return n;
+         const void *hit = std::memchr(p + from, set[0], n - from);
+         return hit ? static_cast<const unsigned char *>(hit) - p : n;
+      }
+      size_t i = from;
+#ifdef __SSE2__
+      if (nset <= 4) {
+         __m128i v[4];
+         for (size_t k = 0; k < nset; ++k)
+            v[k] = _mm_set1_epi8(static_cast<char>(set[k]));
+         for (; i + 16 <= n; i += 16) {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            __m128i eq = _mm_cmpeq_epi8(b, v[0]);
+            for (size_t k = 1; k < nset; ++k)
+               eq = _mm_or_si128(eq, _mm_cmpeq_epi8(b, v[k]));
+            int mask = _mm_movemask_epi8(eq);
+            if (mask) return i + __builtin_ctz(mask);
+         }
+      }
+#endif
+      for (; i < n; ++i)
+         for (size_t k = 0; k < nset; ++k)
+            if (p[i] == set[k]) return i;
+      return n;
+   }
+
+}
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <cstring>
 
 using namespace eudaq;
 using namespace std;
@@ -31,6 +32,26 @@ namespace eudaq {
    }
 
    void ScReader::OnStart(int runNo) {
+      Reset(runNo);
+      // set the connection and send "start runNo"
+      std::cout << "opening connection" << std::endl;
+      _producer->OpenConnection();
+      std::cout << "connection opened" << std::endl;
+      // using characters to send the run number
+      ostringstream os;
+      os << "RUN_START"; //newLED
+      // os << "START"; //newLED
+      os.width(8);
+      os.fill('0');
+      os << runNo;
+      os << "\r\n";
+      std::cout << "Sending command" << std::endl;
+      _producer->SendCommand(os.str().c_str());
+      std::cout << "command sent" << std::endl;
+      _buffer_inside_acquisition = false;
+   }
+
+   void ScReader::Reset(int runNo) {
       _runNo = runNo;
       _cycleNo = -1;
       _trigID = _producer->getLdaTrigidStartsFrom() - 1;
@@ -49,21 +70,6 @@ namespace eudaq {
             _lastBuiltEventNr = -1;
             break;
       }
-      // set the connection and send "start runNo"
-      std::cout << "opening connection" << std::endl;
-      _producer->OpenConnection();
-      std::cout << "connection opened" << std::endl;
-      // using characters to send the run number
-      ostringstream os;
-      os << "RUN_START"; //newLED
-      // os << "START"; //newLED
-      os.width(8);
-      os.fill('0');
-      os << runNo;
-      os << "\r\n";
-      std::cout << "Sending command" << std::endl;
-      _producer->SendCommand(os.str().c_str());
-      std::cout << "command sent" << std::endl;
       _buffer_inside_acquisition = false;
    }
 
@@ -126,7 +132,7 @@ namespace eudaq {
       //    usleep(000);
    }
 
-   void ScReader::Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) {
+   void ScReader::Read(LdaBuffer & buf, std::deque<eudaq::EventUP> & deqEvent) {
       static const unsigned char magic_sc[2] = { 0xac, 0xdc };    // find slow control info
       static const unsigned char magic_led[2] = { 0xda, 0xc1 };    // find LED voltages info
       static const unsigned char magic_data[2] = { 0xcd, 0xcd };    // find data
@@ -134,6 +140,7 @@ namespace eudaq {
       static const unsigned char C_PKTHDR_TEMP[4] = { 0x41, 0x43, 0x7A, 0x00 };
       static const unsigned char C_PKTHDR_TIMESTAMP[4] = { 0x45, 0x4D, 0x49, 0x54 };
       static const unsigned char C_PKTHDR_ASICDATA[4] = { 0x41, 0x43, 0x48, 0x41 };
+      static const unsigned char magic_first[3] = { magic_led[0], magic_sc[0], magic_data[0] };
 
       try {
          while (1) {
@@ -166,7 +173,7 @@ namespace eudaq {
                         EUDAQ_EXTRA(" Layer=" + to_string(ledId) + " Voltage=" + to_string(ledV) + " on/off=" + to_string(ledOnOff));
                      }
                      // buf.pop_front();
-                     buf.erase(buf.begin(), buf.begin() + ibuf - 1);	//LED info from buffer already saved, therefore can be deleted from buffer.
+                     buf.consume(ibuf - 1);	//LED info from buffer already saved, therefore can be deleted from buffer.
                      continue;
                   } else {	//unknown data
                      std::cout << "ERROR: unknown data (LED)" << std::endl;
@@ -188,22 +195,24 @@ namespace eudaq {
                      //TODO this is wrong - it will break, when 0xCD will be in the slowcontrol stream
                      //TODO this is wrong again - it will brake when the complete slowcontrol will be not contained fully in the buffer
                      while (buf.size() > ibuf) {
-                        if ((unsigned char) buf[ibuf] == magic_data[0]) {
-                           if ((buf.size() > ibuf + 1)) {
-                              if ((unsigned char) buf[ibuf + 1] == magic_data[1]) {
-                                 _unfinishedPacketState = UnfinishedPacketStates::DONE;
-                                 break;
-                              }
-                           } else {
-                              throw BufferProcessigExceptions::ERR_INCOMPLETE_INFO_CYCLE;
+                        //everything up to the next 0xcd is slowcontrol
+                        size_t next = buf.findAny(magic_data, 1, ibuf);
+                        slowcontrol.insert(slowcontrol.end(), buf.data() + ibuf, buf.data() + next);
+                        ibuf = next;
+                        if (ibuf == buf.size()) break;
+                        if ((buf.size() > ibuf + 1)) {
+                           if (buf[ibuf + 1] == magic_data[1]) {
+                              _unfinishedPacketState = UnfinishedPacketStates::DONE;
+                              break;
                            }
+                        } else {
+                           throw BufferProcessigExceptions::ERR_INCOMPLETE_INFO_CYCLE;
                         }
-                        int sc = (unsigned char) buf[ibuf];
-                        slowcontrol.push_back(sc);
+                        slowcontrol.push_back(buf[ibuf]);
                         ibuf++;
                      }
                      //buf.pop_front();
-                     buf.erase(buf.begin(), buf.begin() + ibuf - 1);            //Slowcontrol data saved, therefore can be deleted from buffer.
+                     buf.consume(ibuf - 1);            //Slowcontrol data saved, therefore can be deleted from buffer.
                      continue;
                   } else {  //unknown data
                      std::cout << "ERROR: unknown data (Slowcontrol) " << to_hex(buf[0]) << " " << to_hex(buf[1])
@@ -217,8 +226,11 @@ namespace eudaq {
                   // std::cout << "AHCAL packet found" << std::endl;
                   break;//data packet will be processed outside this while loop
                }
+               //when nothing match, throw away everything up to the next byte that may start a packet
+               size_t skip = buf.findAny(magic_first, sizeof(magic_first), 1);
                std::cout << "!" << to_hex(buf[0], 2);
-               buf.pop_front();            //when nothing match, throw away
+               if (skip > 1) std::cout << "(+" << (skip - 1) << " bytes)";
+               buf.consume(skip);
             }
 
             if (buf.size() <= e_sizeLdaHeader) throw BufferProcessigExceptions::OK_ALL_READ; // all data read
@@ -359,20 +371,19 @@ namespace eudaq {
                }
                if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
                std::cout << std::endl;
-               buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+               buf.consume(length + e_sizeLdaHeader);
                continue;
             }
 
-            deque<char>::iterator it = buf.begin() + e_sizeLdaHeader;
+            const unsigned char *it = buf.data() + e_sizeLdaHeader;
 
             // ASIC DATA 0x4341 0x4148
-            if ((it[0] == C_PKTHDR_ASICDATA[0]) && (it[1] == C_PKTHDR_ASICDATA[1])
-                  && (it[2] == C_PKTHDR_ASICDATA[2]) && (it[3] == C_PKTHDR_ASICDATA[3])) {
+            if (!memcmp(it, C_PKTHDR_ASICDATA, sizeof(C_PKTHDR_ASICDATA))) {
                //std::cout << "DEBUG: Analyzing AHCAL data, ROC " << LDA_Header_cycle << std::endl;
                readAHCALData(buf, _LDAAsicData);
             } else {
                cout << "ScReader: header invalid. Received" << to_hex(it[0]) << " " << to_hex(it[1]) << " " << to_hex(it[2]) << " " << to_hex(it[3]) << " " << endl;
-               buf.pop_front();
+               buf.consume(1);
             }
 
 //            if (cycleData[0] != 0 && cycleData[2] != 0 && cycleData[4] != 0) {
@@ -387,7 +398,7 @@ namespace eudaq {
 //            }
 
             // remove used buffer
-//            buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+//            buf.consume(length + e_sizeLdaHeader);
          }
       }
       catch (BufferProcessigExceptions &e) {
@@ -508,22 +519,35 @@ namespace eudaq {
       appendOtherInfo(ev);
    }
 
+   void ScReader::addAsicBlock(eudaq::RawEvent * ev, const int *packet) {
+      ev->AddBlock(ev->NumBlocks(), packet, AsicPackets::C_WORDS * sizeof(int));
+   }
+
+   void ScReader::eraseFirstROC() {
+      std::vector<int> &words = _LDAAsicData.begin()->second.words;
+      if (_spareAsicWords.size() < 8) {
+         words.clear();
+         _spareAsicWords.push_back(std::move(words));
+      }
+      _LDAAsicData.erase(_LDAAsicData.begin());
+   }
+
    void ScReader::buildValidatedBXIDEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) {
       int keptEventCount = dumpAll ? 0 : 3; //how many ROCs to keep in the data maps
       //      keptEventCount = 100000;
       while (_LDAAsicData.size() > keptEventCount) { //at least 2 finished ROC
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+         const AsicPackets &data = _LDAAsicData.begin()->second;
          //create a table with BXIDs
-         std::map<int, std::vector<std::vector<int> > > bxids;
+         std::map<int, std::vector<const int *> > bxids; //packets in data
          //std::cout << "processing readout cycle " << roc << std::endl;
 
          //data from the readoutcycle to be sorted by BXID.
-         for (std::vector<int> &dit : data) { // = data.begin(); dit != data.end(); ++dit
+         for (size_t i = 0; i < data.size(); ++i) {
+            const int *dit = data.packet(i);
             int bxid = (int) dit[1];
             //std::cout << "bxid " << (int) dit[1] << "\t chipid: " << (int) dit[3] << std::endl;
-            std::vector<std::vector<int> >& sameBxidPackets = bxids.insert( { bxid, std::vector<std::vector<int> >() }).first->second;
-            sameBxidPackets.push_back(std::move(dit));
+            bxids[bxid].push_back(dit);
          }
 
          uint64_t startTS = 0LLU;
@@ -564,7 +588,7 @@ namespace eudaq {
          }
 
          //iterate over bxids from single ROC
-         for (std::pair<const int, std::vector<std::vector<int> > > & sameBxidPackets : bxids) {
+         for (std::pair<const int, std::vector<const int *> > & sameBxidPackets : bxids) {
             //std::cout << "bxid: " << sameBxidPackets.first << "\tsize: " << sameBxidPackets.second.size() << std::endl;
             int bxid = sameBxidPackets.first;
 
@@ -612,15 +636,8 @@ namespace eudaq {
                      nev->ClearFlagBit(eudaq::Event::Flags::FLAG_TRIG);
                      break;
                }
-               for (auto & minipacket : sameBxidPackets.second) {
-                  if (minipacket.size()) {
-                     if (triggerBxids.count(bxid) > 1) {
-                        std::cout <<
-                              nev_raw->AddBlock(nev_raw->NumBlocks(), minipacket);
-                     } else {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(minipacket));
-                     }
-                  }
+               for (const int *minipacket : sameBxidPackets.second) {
+                  addAsicBlock(nev_raw, minipacket);
                }
                EventQueue.push_back(std::move(nev));
                triggerBxids.erase(trigIt);
@@ -631,7 +648,7 @@ namespace eudaq {
                continue;
             }
          }
-         _LDAAsicData.erase(_LDAAsicData.begin());
+         eraseFirstROC();
       }
    }
 
@@ -640,18 +657,18 @@ namespace eudaq {
 //      keptEventCount = 100000;
       while (_LDAAsicData.size() > keptEventCount) { //at least 2 finished ROC
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+         const AsicPackets &data = _LDAAsicData.begin()->second;
 
          //create a table with BXIDs
-         std::map<int, std::vector<std::vector<int> > > bxids;
+         std::map<int, std::vector<const int *> > bxids; //packets in data
          //std::cout << "processing readout cycle " << roc << std::endl;
 
          //data from the readoutcycle to be sorted by BXID.
-         for (std::vector<int> &dit : data) { // = data.begin(); dit != data.end(); ++dit
+         for (size_t i = 0; i < data.size(); ++i) {
+            const int *dit = data.packet(i);
             int bxid = (int) dit[1];
             //std::cout << "bxid " << (int) dit[1] << "\t chipid: " << (int) dit[3] << std::endl;
-            std::vector<std::vector<int> >& sameBxidPackets = bxids.insert( { bxid, std::vector<std::vector<int> >() }).first->second;
-            sameBxidPackets.push_back(std::move(dit));
+            bxids[bxid].push_back(dit);
          }
 
          //get the start of acquisition timestamp
@@ -678,7 +695,7 @@ namespace eudaq {
          }
          //----------------------------------------------------------
 
-         for (std::pair<const int, std::vector<std::vector<int> > > & sameBxidPackets : bxids) {
+         for (std::pair<const int, std::vector<const int *> > & sameBxidPackets : bxids) {
             int bxid = sameBxidPackets.first;
             _RunTimesStatistics.builtBXIDs++;
             //std::cout << "bxid: " << sameBxidPackets.first << "\tsize: " << sameBxidPackets.second.size() << std::endl;
@@ -711,14 +728,12 @@ namespace eudaq {
                uint64_t ts_end = startTS + _producer->getAhcalbxid0Offset() + (bxid + 1) * _producer->getAhcalbxidWidth() + 1;
 	       nev->SetTimestamp(ts_beg, ts_end, false);
             }
-            for (auto & minipacket : sameBxidPackets.second) {
-               if (minipacket.size()) {
-                  nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(minipacket));
-               }
+            for (const int *minipacket : sameBxidPackets.second) {
+               addAsicBlock(nev_raw, minipacket);
             }
             EventQueue.push_back(std::move(nev));
          }
-         _LDAAsicData.erase(_LDAAsicData.begin());
+         eraseFirstROC();
          if (_LDATimestampData.count(roc)) {
             _LDATimestampData.erase(roc);
          }
@@ -733,17 +748,15 @@ namespace eudaq {
          while ((++_lastBuiltEventNr < _LDAAsicData.begin()->first) && _producer->getInsertDummyPackets())
             insertDummyEvent(EventQueue, _lastBuiltEventNr, -1, false);
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+         const AsicPackets &data = _LDAAsicData.begin()->second;
          eudaq::EventUP nev = eudaq::Event::MakeUnique("CaliceObject");
          eudaq::RawEvent *nev_raw = dynamic_cast<RawEvent*>(nev.get());
          prepareEudaqRawPacket(nev_raw);
          nev->SetTag("ROC", roc);
 
 //         nev->SetEventN(roc);
-         for (std::vector<std::vector<int> >::iterator idata = data.begin(); idata != data.end(); ++idata) {
-            if (idata->size()) {
-               nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(*idata));
-            }
+         for (size_t i = 0; i < data.size(); ++i) {
+            addAsicBlock(nev_raw, data.packet(i));
          }
          //nev->Print(std::cout, 0);
          if (_LDATimestampData.count(roc) && (!_producer->getIgnoreLdaTimestamps())) {
@@ -784,7 +797,7 @@ namespace eudaq {
          }
 
          EventQueue.push_back(std::move(nev));
-         _LDAAsicData.erase(_LDAAsicData.begin());
+         eraseFirstROC();
       }
    }
 
@@ -820,7 +833,7 @@ namespace eudaq {
                }
                int trigid = _LDATimestampData[roc].TriggerIDs[i];
 
-               std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+               const AsicPackets &data = _LDAAsicData.begin()->second;
                eudaq::EventUP nev = eudaq::Event::MakeUnique("CaliceObject");
                eudaq::RawEvent *nev_raw = dynamic_cast<RawEvent*>(nev.get());
                prepareEudaqRawPacket(nev_raw);
@@ -845,22 +858,8 @@ namespace eudaq {
                nev->SetTag("ROC", roc);
                nev->SetTag("ROCStartTS", _LDATimestampData[roc].TS_Start);
                //copy the ahcal data
-               if (i == (_LDATimestampData[roc].TS_Triggers.size() - 1)) {
-                  //the last triggerID in the vector
-                  //std::cout << "DEBUG EB: ScReader::buildTRIGIDEvents: moving data for trigger " << trigid << std::endl;
-                  for (std::vector<std::vector<int> >::iterator idata = data.begin(); idata != data.end(); ++idata) {
-                     if (idata->size()) {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(*idata));
-                     }
-                  }
-               } else {
-                  //only copy the last vector, because it might be copied again
-                  //std::cout << "DEBUG EB: ScReader::buildTRIGIDEvents: copying data for trigger " << trigid << std::endl;
-                  for (std::vector<std::vector<int> >::const_iterator idata = data.begin(); idata != data.end(); ++idata) {
-                     if (idata->size()) {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), *idata);
-                     }
-                  }
+               for (size_t ip = 0; ip < data.size(); ++ip) {
+                  addAsicBlock(nev_raw, data.packet(ip));
                }
 
                //copy the cycledata
@@ -887,7 +886,7 @@ namespace eudaq {
                if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
             }
          }
-         _LDAAsicData.erase(_LDAAsicData.begin());
+         eraseFirstROC();
          continue;
       }
    }
@@ -902,17 +901,17 @@ namespace eudaq {
       EventQueue.push_back(std::move(nev));
    }
 
-   void ScReader::readTemperature(std::deque<char> &buf) {
+   void ScReader::readTemperature(LdaBuffer &buf) {
       int lda = buf[6];
       int port = buf[7];
       short data = ((unsigned char) buf[23] << 8) + (unsigned char) buf[22];
       //std::cout << "DEBUG reading Temperature, length=" << length << " lda=" << lda << " port=" << port << std::endl;
       //std::cout << "DEBUG: temp LDA:" << lda << " PORT:" << port << " Temp" << data << std::endl;
       _vecTemp.push_back(make_pair(make_pair(lda, port), data));
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
-   void ScReader::readAHCALData(std::deque<char> &buf, std::map<int, std::vector<std::vector<int> > >& AHCALData) {
+   void ScReader::readAHCALData(LdaBuffer &buf, std::map<int, AsicPackets>& AHCALData) {
 //AHCALData[_cycleNo];
       unsigned int LDA_Header_cycle = (unsigned char) buf[4]; //from LDA packet header - 8 bits only!
       int8_t cycle_difference = LDA_Header_cycle - (_cycleNo & 0xFF);
@@ -938,9 +937,14 @@ namespace eudaq {
       }
 
 //data from the readoutcycle.
-      std::vector<std::vector<int> >& readoutCycle = AHCALData.insert( { _cycleNo, std::vector<std::vector<int> >() }).first->second;
+      auto inserted = AHCALData.insert( { _cycleNo, AsicPackets() });
+      AsicPackets& readoutCycle = inserted.first->second;
+      if (inserted.second && !_spareAsicWords.empty()) {
+         readoutCycle.words = std::move(_spareAsicWords.back());
+         _spareAsicWords.pop_back();
+      }
 
-      deque<char>::iterator it = buf.begin() + e_sizeLdaHeader;
+      const unsigned char *it = buf.data() + e_sizeLdaHeader;
 
 // footer check: ABAB
       if ((unsigned char) it[length - 2] != 0xab || (unsigned char) it[length - 1] != 0xab) {
@@ -954,60 +958,47 @@ namespace eudaq {
          EUDAQ_ERROR("Wrong LDA packet length = " + to_string(length) + "in Run=" + to_string(_runNo) + " ,cycle= " + to_string(_cycleNo));
          std::cout << "Wrong LDA packet length = " << length << "in Run=" << _runNo << " ,cycle= " << _cycleNo << std::endl;
 //         ev->SetTag("DAQquality", 0);
-         buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+         buf.consume(length + e_sizeLdaHeader);
          return;
       }
 
       int chipId = (unsigned char) it[length - 3] * 256 + (unsigned char) it[length - 4];
 
-      const int NChannel = 36;
+      const int NChannel = AsicPackets::C_CHANNELS;
       int nscai = (length - 8) / (NChannel * 4 + 2);
 
       it += 8;
 
       for (short tr = 0; tr < nscai; tr++) {
 // binary data: 128 words
-         vector<unsigned short> adc, tdc;
-
-         for (int np = 0; np < NChannel; np++) {
-            unsigned short tdc_value = (unsigned char) it[np * 2] + ((unsigned char) it[np * 2 + 1] << 8);
-            unsigned short adc_value =
-                  (unsigned char) it[np * 2 + NChannel * 2] + ((unsigned char) it[np * 2 + 1 + NChannel * 2] << 8);
-            tdc.push_back(tdc_value);
-            adc.push_back(adc_value);
-         }
-
-         it += NChannel * 4;
-
          int bxididx = e_sizeLdaHeader + length - 4 - (nscai - tr) * 2;
-         int bxid = (unsigned char) buf[bxididx + 1] * 256 + (unsigned char) buf[bxididx];
+         int bxid = buf[bxididx + 1] * 256 + buf[bxididx];
          if (bxid > 4096) {
             std::cout << "ERROR: processing too high BXID: " << bxid << std::endl;
             EUDAQ_WARN(" bxid = " + to_string(bxid));
          }
-         vector<int> infodata;
-         infodata.push_back((int) _cycleNo);
-         infodata.push_back(bxid);
-         infodata.push_back(nscai - tr - 1); // memory cell is inverted
-         infodata.push_back(chipId); //TODO add LDA number and port number in the higher bytes of the int
-         infodata.push_back(NChannel);
-
-         for (int n = 0; n < NChannel; n++)
-            infodata.push_back(tdc[NChannel - n - 1]); //channel ordering was inverted, now is correct
-
-         for (int n = 0; n < NChannel; n++)
-            infodata.push_back(adc[NChannel - n - 1]);
-
-//if (infodata.size() > 0) ev->AddBlock(ev->NumBlocks(), infodata); //add event (consisting from all information from single BXID (= 1 memory cell) from 1 ASIC)
-         if (infodata.size() > 0) {
-            readoutCycle.push_back(std::move(infodata));
-//            std::cout << ".";
+         //the data block of this memory cell, written in place
+         int *infodata = readoutCycle.append();
+         infodata[0] = (int) _cycleNo;
+         infodata[1] = bxid;
+         infodata[2] = nscai - tr - 1; // memory cell is inverted
+         infodata[3] = chipId; //TODO add LDA number and port number in the higher bytes of the int
+         infodata[4] = NChannel;
+
+         //channel ordering was inverted, now is correct
+         int *tdc = infodata + 5;
+         int *adc = tdc + NChannel;
+         for (int np = 0; np < NChannel; np++) {
+            tdc[NChannel - np - 1] = it[np * 2] + (it[np * 2 + 1] << 8);
+            adc[NChannel - np - 1] = it[np * 2 + NChannel * 2] + (it[np * 2 + 1 + NChannel * 2] << 8);
          }
+
+         it += NChannel * 4;
       }
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
-   void ScReader::readLDATimestamp(std::deque<char> &buf, std::map<int, LDATimeData>& LDATimestamps) {
+   void ScReader::readLDATimestamp(LdaBuffer &buf, std::map<int, LDATimeData>& LDATimestamps) {
       unsigned char TStype = buf[14]; //type of timestamp (only for Timestamp packets)
       unsigned int LDA_Header_cycle = (unsigned char) buf[4]; //from LDA packet header - 8 bits only!
       unsigned int LDA_cycle = _cycleNo; //copy from the global readout cycle.
@@ -1088,7 +1079,7 @@ namespace eudaq {
             }
             _buffer_inside_acquisition = true;
             currentROCData.TS_Start = timestamp;
-            buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+            buf.consume(length + e_sizeLdaHeader);
             return;
          }
 
@@ -1112,7 +1103,7 @@ namespace eudaq {
             }
             _buffer_inside_acquisition = false;
             currentROCData.TS_Stop = timestamp;
-            buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+            buf.consume(length + e_sizeLdaHeader);
             return;
          }
 
@@ -1143,7 +1134,7 @@ namespace eudaq {
                   if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
                   EUDAQ_ERROR("Unexpected TriggerID in run " + to_string(_runNo) + ". ROC=" + to_string(_cycleNo) + ", Expected TrigID=" +
                         to_string(_trigID + 1) + ", received:" + to_string(rawTrigID) + ". SKipping");
-                  buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+                  buf.consume(length + e_sizeLdaHeader);
                   return;
                }
             } else { //the difference is 1
@@ -1157,7 +1148,7 @@ namespace eudaq {
             currentROCData.TS_Triggers.push_back(timestamp);
          }
       }
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
    void ScReader::printLDAROCInfo(std::ostream &out) {
@@ -2,6 +2,10 @@
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
 
+namespace caribou {
+  class CLICTDFrameDecoder;
+}
+
 /**
  * Caribou event converter, converting from raw detector data to EUDAQ StandardEvent format
  * @WARNING Each Caribou device needs to register its own converter, as Peary does not force a specific data format!
@@ -31,41 +35,53 @@ namespace eudaq {
 
   class CLICTDEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
+    CLICTDEvent2StdEventConverter();
+    ~CLICTDEvent2StdEventConverter() override;
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, eudaq::ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
     static const uint32_t m_id_factory = eudaq::cstr2hash("CaribouCLICTDEvent");
   private:
-    static bool t0_seen_;
-    static bool t0_is_high_;
-    static uint64_t last_shutter_open_;
+    mutable std::unique_ptr<caribou::CLICTDFrameDecoder> decoder_;
+    mutable bool t0_seen_;
+    mutable bool t0_is_high_;
+    mutable uint64_t last_shutter_open_;
   };
 
   class CLICpix2Event2StdEventConverter: public eudaq::StdEventConverter{
   public:
+    CLICpix2Event2StdEventConverter();
+    ~CLICpix2Event2StdEventConverter() override;
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, eudaq::ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
     static const uint32_t m_id_factory = eudaq::cstr2hash("CaribouCLICpix2Event");
   private:
-    static size_t t0_seen_;
-    static uint64_t last_shutter_open_;
+    struct Decoder;
+    mutable std::unique_ptr<Decoder> decoder_;
+    mutable size_t t0_seen_;
+    mutable uint64_t last_shutter_open_;
   };
 
   class ATLASPixEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
+    ATLASPixEvent2StdEventConverter();
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, eudaq::ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
     static const uint32_t m_id_factory = eudaq::cstr2hash("CaribouATLASPixEvent");
 
 private:
     uint32_t gray_decode(uint32_t gray) const;
 
-    static uint64_t readout_ts_;
-    static double clockcycle_;
-    static uint32_t clkdivend2M_;
-    static uint64_t fpga_ts_;
-    static uint64_t fpga_ts1_;
-    static uint64_t fpga_ts2_;
-    static uint64_t fpga_ts3_;
-    static bool new_ts1_;
-    static bool new_ts2_;
-    static bool timestamps_cleared_;
+    mutable uint64_t readout_ts_;
+    mutable uint64_t fpga_ts_;
+    mutable uint64_t fpga_ts1_;
+    mutable uint64_t fpga_ts2_;
+    mutable uint64_t fpga_ts3_;
+    mutable bool new_ts1_;
+    mutable bool new_ts2_;
+    mutable bool timestamps_cleared_;
   };
 
 } // namespace eudaq
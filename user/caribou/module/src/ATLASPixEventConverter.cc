@@ -16,14 +16,21 @@ uint32_t ATLASPixEvent2StdEventConverter::gray_decode(uint32_t gray) const {
   return bin;
 }
 
-uint64_t ATLASPixEvent2StdEventConverter::readout_ts_(0);
-uint64_t ATLASPixEvent2StdEventConverter::fpga_ts_(0);
-uint64_t ATLASPixEvent2StdEventConverter::fpga_ts1_(0);
-uint64_t ATLASPixEvent2StdEventConverter::fpga_ts2_(0);
-uint64_t ATLASPixEvent2StdEventConverter::fpga_ts3_(0);
-bool ATLASPixEvent2StdEventConverter::new_ts1_(false);
-bool ATLASPixEvent2StdEventConverter::new_ts2_(false);
-bool ATLASPixEvent2StdEventConverter::timestamps_cleared_(false);
+ATLASPixEvent2StdEventConverter::ATLASPixEvent2StdEventConverter()
+  : readout_ts_(0), fpga_ts_(0), fpga_ts1_(0), fpga_ts2_(0), fpga_ts3_(0),
+    new_ts1_(false), new_ts2_(false), timestamps_cleared_(false) {}
+
+void ATLASPixEvent2StdEventConverter::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+  // Pixel data is dropped again until the timestamps of this run are cleared
+  readout_ts_ = 0;
+  fpga_ts_ = 0;
+  fpga_ts1_ = 0;
+  fpga_ts2_ = 0;
+  fpga_ts3_ = 0;
+  new_ts1_ = false;
+  new_ts2_ = false;
+  timestamps_cleared_ = false;
+}
 
 bool ATLASPixEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
   auto ev = std::dynamic_pointer_cast<const eudaq::RawEvent>(d1);
@@ -11,9 +11,19 @@ namespace{
   Register<CLICTDEvent2StdEventConverter>(CLICTDEvent2StdEventConverter::m_id_factory);
 }
 
-bool CLICTDEvent2StdEventConverter::t0_is_high_(false);
-bool CLICTDEvent2StdEventConverter::t0_seen_(false);
-uint64_t CLICTDEvent2StdEventConverter::last_shutter_open_(0);
+CLICTDEvent2StdEventConverter::CLICTDEvent2StdEventConverter()
+  : t0_seen_(false), t0_is_high_(false), last_shutter_open_(0) {}
+
+CLICTDEvent2StdEventConverter::~CLICTDEvent2StdEventConverter() {}
+
+void CLICTDEvent2StdEventConverter::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+  // The decoder is prepared with the configuration of the first event
+  decoder_.reset();
+  t0_seen_ = false;
+  t0_is_high_ = false;
+  last_shutter_open_ = 0;
+}
+
 bool CLICTDEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
   auto ev = std::dynamic_pointer_cast<const eudaq::RawEvent>(d1);
 
@@ -27,7 +37,10 @@ bool CLICTDEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standa
   auto discard_tot_below = conf->Get("discard_tot_below", -1);
   auto discard_toa_below = conf->Get("discard_toa_below", -1);
 
-  static caribou::CLICTDFrameDecoder decoder(longcnt);
+  if(!decoder_) {
+    decoder_.reset(new caribou::CLICTDFrameDecoder(longcnt));
+  }
+  auto& decoder = *decoder_;
   // No event
   if(!ev) {
     return false;
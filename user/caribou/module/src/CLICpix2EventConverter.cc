@@ -11,23 +11,13 @@ namespace{
   Register<CLICpix2Event2StdEventConverter>(CLICpix2Event2StdEventConverter::m_id_factory);
 }
 
-size_t CLICpix2Event2StdEventConverter::t0_seen_(0);
-uint64_t CLICpix2Event2StdEventConverter::last_shutter_open_(0);
-bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
-  auto ev = std::dynamic_pointer_cast<const eudaq::RawEvent>(d1);
-
-  // Retrieve matrix configuration and compression status from config:
-  auto counting = conf->Get("countingmode", true);
-  auto longcnt = conf->Get("longcnt", false);
-  auto comp = conf->Get("comp", true);
-  auto sp_comp = conf->Get("sp_comp", true);
-
-  // Integer to allow skipping pixels with certain ToT values directly when decoding
-  auto discard_tot_below = conf->Get("discard_tot_below", -1);
-  auto discard_toa_below = conf->Get("discard_toa_below", -1);
+// Matrix configuration and frame decoder, prepared once per run:
+struct CLICpix2Event2StdEventConverter::Decoder {
+  Decoder(eudaq::ConfigurationSPC conf)
+    : matrix(matrix_config(conf->Get("countingmode", true), conf->Get("longcnt", false))),
+      decoder(conf->Get("comp", true), conf->Get("sp_comp", true), matrix) {}
 
-  // Prepare matrix decoder:
-  static auto matrix_config = [counting, longcnt]() {
+  static std::map<std::pair<uint8_t, uint8_t>, caribou::pixelConfig> matrix_config(bool counting, bool longcnt) {
     std::map<std::pair<uint8_t, uint8_t>, caribou::pixelConfig> matrix;
     for(uint8_t x = 0; x < 128; x++) {
       for(uint8_t y = 0; y < 128; y++) {
@@ -36,10 +26,38 @@ bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
       }
     }
     return matrix;
-  };
+  }
+
+  std::map<std::pair<uint8_t, uint8_t>, caribou::pixelConfig> matrix;
+  caribou::clicpix2_frameDecoder decoder;
+};
+
+CLICpix2Event2StdEventConverter::CLICpix2Event2StdEventConverter()
+  : t0_seen_(0), last_shutter_open_(0) {}
+
+CLICpix2Event2StdEventConverter::~CLICpix2Event2StdEventConverter() {}
+
+void CLICpix2Event2StdEventConverter::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+  // The decoder is prepared with the configuration of the first event
+  decoder_.reset();
+  t0_seen_ = 0;
+  last_shutter_open_ = 0;
+}
+
+bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
+  auto ev = std::dynamic_pointer_cast<const eudaq::RawEvent>(d1);
+
+  // Integer to allow skipping pixels with certain ToT values directly when decoding
+  auto discard_tot_below = conf->Get("discard_tot_below", -1);
+  auto discard_toa_below = conf->Get("discard_toa_below", -1);
+
+  // Prepare matrix decoder:
+  if(!decoder_) {
+    decoder_.reset(new Decoder(conf));
+  }
+  auto& matrix = decoder_->matrix;
+  auto& decoder = decoder_->decoder;
 
-  static auto matrix = matrix_config();
-  static caribou::clicpix2_frameDecoder decoder(comp, sp_comp, matrix);
   // No event
   if(!ev) {
     return false;
@@ -53,13 +71,13 @@ bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
   if(ev->NumBlocks() == 1) {
     // New data format - timestamps and pixel data are combined in one data block
 
-    // Block 0 contains all data, split it into timestamps and pixel data, returned as std::vector<uint8_t>
-    auto datablock = ev->GetBlock(0);
+    // Block 0 contains all data, split it into timestamps and pixel data
+    auto datablock = ev->GetBlockView(0);
     LOG(DEBUG) << "CLICpix2 frame with";
 
     // Number of timestamps: first word of data
     uint32_t timestamp_words;
-    memcpy(&timestamp_words, &datablock[0], sizeof(uint32_t));
+    memcpy(&timestamp_words, datablock.data(), sizeof(uint32_t));
     LOG(DEBUG) << "        " << timestamp_words / 2 << " timestamps from header";
 
     // Calulate positions and length of data blocks:
@@ -71,7 +89,7 @@ bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
     // Timestamps:
     std::vector<uint32_t> ts_tmp;
     ts_tmp.resize(timestamp_words);
-    memcpy(&ts_tmp[0], &datablock[0] + timestamp_pos, timestamp_length);
+    memcpy(&ts_tmp[0], datablock.data() + timestamp_pos, timestamp_length);
 
     bool msb = true;
     uint64_t ts64;
@@ -87,20 +105,20 @@ bool CLICpix2Event2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
 
     // Pixel data:
     rawdata.resize(data_length / sizeof(uint32_t));
-    memcpy(&rawdata[0], &datablock[0] + data_pos, data_length);
+    memcpy(&rawdata[0], datablock.data() + data_pos, data_length);
     LOG(DEBUG) << "        " << rawdata.size() << " words of frame data";
   } else if(ev->NumBlocks() == 2) {
     // Old data format - timestamps in block 0, pixel data in block 1
 
     // Block 0 is timestamps:
-    auto time = ev->GetBlock(0);
+    auto time = ev->GetBlockView(0);
     timestamps.resize(time.size() / sizeof(uint64_t));
-    memcpy(&timestamps[0], &time[0],time.size());
+    memcpy(&timestamps[0], time.data(), time.size());
 
     // Block 1 is pixel data:
-    auto tmp = ev->GetBlock(1);
+    auto tmp = ev->GetBlockView(1);
     rawdata.resize(tmp.size() / sizeof(unsigned int));
-    memcpy(&rawdata[0], &tmp[0],tmp.size());
+    memcpy(&rawdata[0], tmp.data(), tmp.size());
   } else {
     EUDAQ_WARN("Ignoring bad frame " + std::to_string(ev->GetEventNumber()));
     return false;
@@ -8,6 +8,9 @@
 
 #include "iostream"
 #include "bitset"
+#include <map>
+#include <memory>
+#include <string>
 
 namespace eudaq {
 
@@ -16,7 +19,12 @@ namespace eudaq {
     static const uint32_t m_id_factory = eudaq::cstr2hash("CMSPixelDUT");
 
     bool Converting(EventSPC in, StandardEventSP out, ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
 
+  private:
+    // one helper per stream, created by its 0-EventN event
+    mutable std::map<uint32_t, std::unique_ptr<CMSPixelHelper>> m_helpers;
   };
 
   namespace {
@@ -25,32 +33,21 @@ namespace eudaq {
   }
 
 
+  void CMSPixelDUTConverterPlugin::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+    m_helpers.clear();
+  }
+
   bool CMSPixelDUTConverterPlugin::Converting(eudaq::EventSPC in, eudaq::StandardEventSP out, eudaq::ConfigurationSPC conf) const {
-    static CMSPixelHelper * s_converter = nullptr;
     // The EventN is set by EUDAQ2 in background.
     // First Event (in a data-taking-run for each Producer) has EventN==0 and BORE flag by EUDAQ2 default (base class).
     // Assuming you always send config tag at begin of a run (0-EventN event).
-      if (in->GetEventN() == 0) {
-          if (s_converter) {
-              std::cout << "WARN: global converter is replaced as a new 0-EventN Event arrival." << std::endl;
-              std::cout << "WARN: it is fine if you just start a new data taking." << std::endl;
-              delete s_converter;
-              s_converter = nullptr;
-              s_converter = new CMSPixelHelper(in, conf);
-          } else {
-              std::cout << "INFO: new global converter is created as a new 0-EventN Event arrival" << std::endl;
-              s_converter = new CMSPixelHelper(in, conf);
-          }
-          return true; // in case you BORE has real detector data, remove this line.
-      }
-    if (!s_converter) {
-      std::cerr << "ERROR: There must be a tagged 0-EventN Event which helps to create the global converter.\n";
-      throw;
+    auto &helper = m_helpers[in->GetStreamN()];
+    if (in->GetEventN() == 0) {
+      helper.reset(new CMSPixelHelper(in, conf));
+      return true; // in case you BORE has real detector data, remove this line.
     }
-
-    return s_converter->GetStandardSubEvent(in, out);
-
-    //****************IMPORTANTE NOTE*************************************
-    //a global converter means you are not able to run it for 2 devices data which has different configure.
+    if (!helper)
+      EUDAQ_THROW("CMSPixelDUT: no 0-EventN event of stream " + std::to_string(in->GetStreamN()) + " to set up the converter");
+    return helper->GetStandardSubEvent(in, out);
   }
 }
@@ -1,23 +1,24 @@
 #include "eudaq/DataCollector.hh"
-//#include "eudaq/Event.hh"
+#include "eudaq/ShardedEventBuilder.hh"
 
-//#include <deque>
-//#include <map>
-//#include <string>
+#include <mutex>
 
 namespace eudaq {
   class EventIDSyncDataCollector:public DataCollector{
     public:
-      using DataCollector::DataCollector;
+      EventIDSyncDataCollector(const std::string &name,
+          const std::string &rc);
+      void DoConfigure() override;
       void DoStartRun() override;
+      void DoStatus() override;
       void DoConnect(ConnectionSPC /*id*/) override;
       void DoDisconnect(ConnectionSPC /*id*/) override;
       void DoReceive(ConnectionSPC id, EventSP ev) override;
       static const uint32_t m_id_factory = eudaq::cstr2hash("EventIDSyncDataCollector");
 
     private:
-      std::map<std::string, std::deque<EventSPC>> m_que_event;
       std::mutex m_mtx_map;
+      ShardedEventBuilder m_evb;
   };
 
   namespace{
@@ -26,55 +27,50 @@ namespace eudaq {
       (EventIDSyncDataCollector::m_id_factory);
   }
 
+  EventIDSyncDataCollector::EventIDSyncDataCollector(const std::string &name,
+      const std::string &rc):
+    DataCollector(name, rc),
+    m_evb(EventBuilder::EVENT, "EventIDSyncOnline",
+        [this](EventUP ev){WriteEvent(std::move(ev));}){
+    }
+
+  void EventIDSyncDataCollector::DoConfigure(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    auto conf = GetConfiguration();
+    if(conf)
+      m_evb.Configure(*conf);
+  }
+
   void EventIDSyncDataCollector::DoStartRun(){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    for(auto &que :m_que_event){
-      que.second.clear();
-    }
+    m_evb.Reset();
+  }
+
+  void EventIDSyncDataCollector::DoStatus(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    m_evb.Poll();
+    SetStatusTag("EvbPending", std::to_string(m_evb.PendingSize()));
+    SetStatusTag("EvbPartialN", std::to_string(m_evb.PartialCount()));
+    SetStatusTag("EvbLateN", std::to_string(m_evb.LateCount()));
+    SetStatusTag("EvbOrphanN", std::to_string(m_evb.OrphanCount()));
   }
 
   void EventIDSyncDataCollector::DoConnect(ConnectionSPC id){
     std::unique_lock<std::mutex> lk(m_mtx_map);
     std::string pdc_name = id->GetName();
     EUDAQ_INFO("Producer."+pdc_name+" is connecting");
-    if(m_que_event.find(pdc_name) != m_que_event.end())
+    if(m_evb.HasStream(str2hash(pdc_name)))
       EUDAQ_THROW("DataCollector::Doconnect, multiple producers are sharing a same name");
-    m_que_event[pdc_name];
+    m_evb.AddStream(str2hash(pdc_name));
   }
 
   void EventIDSyncDataCollector::DoDisconnect(ConnectionSPC id){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    std::string pdc_name = id->GetName();
-    if(m_que_event.find(pdc_name) == m_que_event.end())
-      EUDAQ_THROW("DataCollector::DisDoconnect, the disconnecting producer was not existing in list");
-    EUDAQ_WARN("Producer."+pdc_name+" is disconnected, the remaining events are erased. ("+std::to_string(m_que_event[pdc_name].size())+ " Events)");
-    m_que_event.erase(pdc_name);
+    m_evb.RemoveStream(str2hash(id->GetName()));
   }
 
   void EventIDSyncDataCollector::DoReceive(ConnectionSPC id, EventSP ev){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    std::string pdc_name = id->GetName();
-    m_que_event[pdc_name].push_back(std::move(ev));
-    uint32_t n = 0;
-    for(auto &que :m_que_event){
-      if(!que.second.empty())
-        n++;
-    }
-    if(n==m_que_event.size()){
-      auto ev_wrap = Event::MakeUnique("EventIDSyncOnline");
-      ev_wrap->SetFlagPacket();
-      uint32_t ev_c = m_que_event.begin()->second.front()->GetEventN();
-      bool match = true;
-      for(auto &que :m_que_event){
-        if(ev_c != que.second.front()->GetEventN())
-          match = false;
-        ev_wrap->AddSubEvent(que.second.front());
-        que.second.pop_front();
-      }
-      if(!match){
-        EUDAQ_WARN("EventNumbers are Mismatched");
-      }
-      WriteEvent(std::move(ev_wrap));
-    }
+    m_evb.Push(str2hash(id->GetName()), std::move(ev));
   }
 }
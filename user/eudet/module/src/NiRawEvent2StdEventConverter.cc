@@ -6,7 +6,7 @@
 #define PIVOTPIXELOFFSET 64
 
 class NiRawEvent2StdEventConverter: public eudaq::StdEventConverter{
-  typedef std::vector<uint8_t>::const_iterator datait;
+  typedef const uint8_t *datait;
 public:
   bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
   void DecodeFrame(eudaq::StandardPlane& plane, const uint32_t fm_n,
@@ -40,14 +40,14 @@ bool NiRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standar
   }
     
   auto &rawev = *ev;
-  if (rawev.NumBlocks() < 2 || rawev.GetBlock(0).size() < 20 ||
-      rawev.GetBlock(1).size() < 20) {
+  if (rawev.NumBlocks() < 2 || rawev.GetBlockView(0).size() < 20 ||
+      rawev.GetBlockView(1).size() < 20) {
     EUDAQ_WARN("Ignoring bad event " + std::to_string(rawev.GetEventNumber()));
     return false;
   }
 
-  const std::vector<uint8_t> &data0 = rawev.GetBlock(0);
-  const std::vector<uint8_t> &data1 = rawev.GetBlock(1);
+  auto data0 = rawev.GetBlockView(0);
+  auto data1 = rawev.GetBlockView(1);
   uint32_t header0 = eudaq::getlittleendian<uint32_t>(&data0[0]);
   uint32_t header1 = eudaq::getlittleendian<uint32_t>(&data1[0]);
   uint16_t pivot = eudaq::getlittleendian<uint16_t>(&data0[4]);
@@ -91,8 +91,7 @@ bool NiRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standar
     }
 
     eudaq::StandardPlane plane(id, "NI", "MIMOSA26");
-    plane.SetSizeZS(1152, 576, 0, 2, eudaq::StandardPlane::FLAG_WITHPIVOT |
-		    eudaq::StandardPlane::FLAG_DIFFCOORDS);
+    plane.SetSizeCompact(1152, 576, eudaq::PixelHits::COL_PIVOT, 2);
     plane.SetPivotPixel((9216 + pivot + PIVOTPIXELOFFSET) % 9216);
     DecodeFrame(plane, 0, &it0[8], len0);
     DecodeFrame(plane, 1, &it1[8], len1);
@@ -136,6 +135,8 @@ void NiRawEvent2StdEventConverter::DecodeFrame(eudaq::StandardPlane& plane, cons
   }
 
   size_t lvec = vec.size();
+  auto &hits = plane.Hits(fm_n);
+  hits.Reserve(hits.Size() + lvec);
   for (size_t i = 0; i+1 < lvec; ++i) {
     uint16_t numstates = vec[i] & 0x000f;
     uint16_t row = vec[i] >> 4 & 0x7ff;
@@ -148,7 +149,7 @@ void NiRawEvent2StdEventConverter::DecodeFrame(eudaq::StandardPlane& plane, cons
       uint16_t column = v >> 2 & 0x7ff;
       uint16_t num = v & 3;
       for (uint16_t j = 0; j < num + 1; ++j) {
-        plane.PushPixel(column + j, row, 1,0, pivot, fm_n);
+        hits.Push(column + j, row, 1, 0, pivot);
       }
     }
   }
@@ -1,9 +1,8 @@
 #include "eudaq/DataCollector.hh"
+#include "eudaq/ShardedEventBuilder.hh"
 
-//#include <mutex>
-//#include <deque>
-//#include <map>
-#include <set>
+#include <mutex>
+#include <map>
 
 namespace eudaq {
   class TriggerIDSyncDataCollector:public DataCollector{
@@ -13,14 +12,16 @@ namespace eudaq {
       void DoConnect(ConnectionSPC id) override;
       void DoDisconnect(ConnectionSPC id) override;
       void DoConfigure() override;
+      void DoStartRun() override;
       void DoReset() override;
+      void DoStatus() override;
       void DoReceive(ConnectionSPC id, EventSP ev) override;
       static const uint32_t m_id_factory = cstr2hash("TriggerIDSyncDataCollector");
 
     private:
       std::mutex m_mtx_map;
-      std::map<ConnectionSPC, std::deque<EventSPC>> m_conn_evque;
-      std::set<ConnectionSPC> m_conn_inactive;
+      ShardedEventBuilder m_evb;
+      std::map<uint32_t, std::string> m_names;
       uint32_t m_noprint;
   };
 
@@ -32,84 +33,68 @@ namespace eudaq {
 
   TriggerIDSyncDataCollector::TriggerIDSyncDataCollector(const std::string &name,
       const std::string &rc):
-    DataCollector(name, rc){
+    DataCollector(name, rc),
+    m_evb(EventBuilder::TRIGGER, "TriggerIDSyncOnline",
+        [this](EventUP ev){
+          if(!m_noprint)
+            ev->Print(std::cout);
+          WriteEvent(std::move(ev));
+        }),
+    m_noprint(0){
     }
 
   void TriggerIDSyncDataCollector::DoConnect(ConnectionSPC idx){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    m_conn_evque[idx].clear();
-    m_conn_inactive.erase(idx);
+    m_names[str2hash(idx->GetName())] = idx->GetName();
+    m_evb.AddStream(str2hash(idx->GetName()));
   }
 
   void TriggerIDSyncDataCollector::DoDisconnect(ConnectionSPC idx){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    m_conn_inactive.insert(idx);
-    if(m_conn_inactive.size() == m_conn_evque.size()){
-      m_conn_inactive.clear();
-      m_conn_evque.clear();
-    }
+    m_evb.RemoveStream(str2hash(idx->GetName()));
   }
 
   void TriggerIDSyncDataCollector::DoConfigure(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
     m_noprint = 0;
     auto conf = GetConfiguration();
     if(conf){
       conf->Print();
       m_noprint = conf->Get("DISABLE_PRINT", 0);
+      m_evb.Configure(*conf);
     }
   }
 
+  void TriggerIDSyncDataCollector::DoStartRun(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    m_evb.Reset();
+  }
+
   void TriggerIDSyncDataCollector::DoReset(){
     std::unique_lock<std::mutex> lk(m_mtx_map);
     m_noprint = 0;
-    m_conn_evque.clear();
-    m_conn_inactive.clear();
+    m_evb.Reset();
   }
 
-  void TriggerIDSyncDataCollector::DoReceive(ConnectionSPC idx, EventSP evsp){
+  void TriggerIDSyncDataCollector::DoStatus(){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    if(!evsp->IsFlagTrigger()){
-      EUDAQ_THROW("!evsp->IsFlagTrigger()");
-    }
-    m_conn_evque[idx].push_back(evsp);
-
-    uint32_t trigger_n = -1;
-    for(auto &conn_evque: m_conn_evque){
-      if(conn_evque.second.empty())
-        return;
-      else{
-        uint32_t trigger_n_ev = conn_evque.second.front()->GetTriggerN();
-        if(trigger_n_ev< trigger_n)
-          trigger_n = trigger_n_ev;
-      }
-    }
-
-    auto ev_sync = Event::MakeUnique("TriggerIDSyncOnline");
-    ev_sync->SetFlagPacket();
-    ev_sync->SetTriggerN(trigger_n);
-    for(auto &conn_evque: m_conn_evque){
-      auto &ev_front = conn_evque.second.front(); 
-      if(ev_front->GetTriggerN() == trigger_n){
-        ev_sync->AddSubEvent(ev_front);
-        conn_evque.second.pop_front();
-      }
+    m_evb.Poll();
+    SetStatusTag("EvbPending", std::to_string(m_evb.PendingSize()));
+    SetStatusTag("EvbPartialN", std::to_string(m_evb.PartialCount()));
+    SetStatusTag("EvbLateN", std::to_string(m_evb.LateCount()));
+    SetStatusTag("EvbOrphanN", std::to_string(m_evb.OrphanCount()));
+    // which producers the incomplete events were missing
+    std::string missing;
+    for(auto &e: m_evb.MissingCounts()){
+      if(!missing.empty())
+        missing += ",";
+      missing += m_names[e.first] + ":" + std::to_string(e.second);
     }
+    SetStatusTag("EvbMissing", missing);
+  }
 
-    if(!m_conn_inactive.empty()){
-      std::set<ConnectionSPC> conn_inactive_empty;
-      for(auto &conn: m_conn_inactive){
-        if(m_conn_evque.find(conn) != m_conn_evque.end() && 
-            m_conn_evque[conn].empty()){
-          m_conn_evque.erase(conn);
-          conn_inactive_empty.insert(conn);	
-        }
-      }
-      for(auto &conn: conn_inactive_empty){
-        m_conn_inactive.erase(conn);
-      }
-    }
-    if(!m_noprint)
-      ev_sync->Print(std::cout);
-    WriteEvent(std::move(ev_sync));
+  void TriggerIDSyncDataCollector::DoReceive(ConnectionSPC idx, EventSP evsp){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    m_evb.Push(str2hash(idx->GetName()), std::move(evsp));
   }
 }
@@ -1,9 +1,7 @@
 #include "eudaq/DataCollector.hh"
+#include "eudaq/EventBuilder.hh"
 
 #include <mutex>
-#include <deque>
-#include <map>
-#include <set>
 
 class Ex0TgDataCollector:public eudaq::DataCollector{
 public:
@@ -12,14 +10,14 @@ class Ex0TgDataCollector:public eudaq::DataCollector{
   void DoConnect(eudaq::ConnectionSPC id) override;
   void DoDisconnect(eudaq::ConnectionSPC id) override;
   void DoConfigure() override;
+  void DoStartRun() override;
   void DoReset() override;
   void DoReceive(eudaq::ConnectionSPC id, eudaq::EventSP ev) override;
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("Ex0TgDataCollector");
 private:
   std::mutex m_mtx_map;
-  std::map<eudaq::ConnectionSPC, std::deque<eudaq::EventSPC>> m_conn_evque;
-  std::set<eudaq::ConnectionSPC> m_conn_inactive;
+  eudaq::EventBuilder m_evb;
   uint32_t m_noprint;
 };
 
@@ -31,83 +29,49 @@ namespace{
 
 Ex0TgDataCollector::Ex0TgDataCollector(const std::string &name,
 				       const std::string &rc):
-  DataCollector(name, rc){
+  DataCollector(name, rc),
+  m_evb(eudaq::EventBuilder::TRIGGER, "Ex0Tg",
+	[this](eudaq::EventUP ev){
+	  if(!m_noprint)
+	    ev->Print(std::cout);
+	  WriteEvent(std::move(ev));
+	}),
+  m_noprint(0){
 }
 
 void Ex0TgDataCollector::DoConnect(eudaq::ConnectionSPC idx){
   std::unique_lock<std::mutex> lk(m_mtx_map);
-  m_conn_evque[idx].clear();
-  m_conn_inactive.erase(idx);
+  m_evb.AddStream(eudaq::str2hash(idx->GetName()));
 }
 
 void Ex0TgDataCollector::DoDisconnect(eudaq::ConnectionSPC idx){
   std::unique_lock<std::mutex> lk(m_mtx_map);
-  m_conn_inactive.insert(idx);
-  if(m_conn_inactive.size() == m_conn_evque.size()){
-    m_conn_inactive.clear();
-    m_conn_evque.clear();
-  }
+  m_evb.RemoveStream(eudaq::str2hash(idx->GetName()));
 }
 
 void Ex0TgDataCollector::DoConfigure(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
   m_noprint = 0;
   auto conf = GetConfiguration();
   if(conf){
     conf->Print();
     m_noprint = conf->Get("EX0_DISABLE_PRINT", 0);
+    m_evb.Configure(*conf);
   }
 }
 
+void Ex0TgDataCollector::DoStartRun(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  m_evb.Reset();
+}
+
 void Ex0TgDataCollector::DoReset(){
   std::unique_lock<std::mutex> lk(m_mtx_map);
   m_noprint = 0;
-  m_conn_evque.clear();
-  m_conn_inactive.clear();
+  m_evb.Reset();
 }
 
 void Ex0TgDataCollector::DoReceive(eudaq::ConnectionSPC idx, eudaq::EventSP evsp){
   std::unique_lock<std::mutex> lk(m_mtx_map);
-  if(!evsp->IsFlagTrigger()){
-    EUDAQ_THROW("!evsp->IsFlagTrigger()");
-  }
-  m_conn_evque[idx].push_back(evsp);
-
-  uint32_t trigger_n = -1;
-  for(auto &conn_evque: m_conn_evque){
-    if(conn_evque.second.empty())
-      return;
-    else{
-      uint32_t trigger_n_ev = conn_evque.second.front()->GetTriggerN();
-      if(trigger_n_ev< trigger_n)
-	trigger_n = trigger_n_ev;
-    }
-  }
-
-  auto ev_sync = eudaq::Event::MakeUnique("Ex0Tg");
-  ev_sync->SetFlagPacket();
-  ev_sync->SetTriggerN(trigger_n);
-  for(auto &conn_evque: m_conn_evque){
-    auto &ev_front = conn_evque.second.front(); 
-    if(ev_front->GetTriggerN() == trigger_n){
-      ev_sync->AddSubEvent(ev_front);
-      conn_evque.second.pop_front();
-    }
-  }
-  
-  if(!m_conn_inactive.empty()){
-    std::set<eudaq::ConnectionSPC> conn_inactive_empty;
-    for(auto &conn: m_conn_inactive){
-      if(m_conn_evque.find(conn) != m_conn_evque.end() && 
-	 m_conn_evque[conn].empty()){
-	m_conn_evque.erase(conn);
-	conn_inactive_empty.insert(conn);	
-      }
-    }
-    for(auto &conn: conn_inactive_empty){
-      m_conn_inactive.erase(conn);
-    }
-  }
-  if(!m_noprint)
-    ev_sync->Print(std::cout);
-  WriteEvent(std::move(ev_sync));
+  m_evb.Push(eudaq::str2hash(idx->GetName()), std::move(evsp));
 }
@@ -7,21 +7,34 @@
 * SPIDR provides two event types, pixel data and trigger information events.
 */
 namespace eudaq {
+  // The timestamps are decoded relative to the heartbeat packets seen before,
+  // this state is kept per stream (i.e. per SPIDR device) and run.
   class Timepix3RawEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, eudaq::ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3RawEvent");
   private:
-    static uint64_t m_syncTime;
-    static bool m_clearedHeader;
+    struct StreamState {
+      uint64_t m_syncTime = 0;
+      bool m_clearedHeader = false;
+    };
+    mutable std::map<uint32_t, StreamState> m_streams;
   };
 
   class Timepix3TrigEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void BeginRun(uint32_t run_n, eudaq::ConfigurationSPC conf) override;
+    bool KeepsStreamState() const override {return true;};
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3TrigEvent");
-    static long long int m_syncTimeTDC;
-    static int m_TDCoverflowCounter;
+  private:
+    struct StreamState {
+      long long int m_syncTimeTDC = 0;
+      int m_TDCoverflowCounter = 0;
+    };
+    mutable std::map<uint32_t, StreamState> m_streams;
   };
 
 } // namespace eudaq
@@ -9,8 +9,10 @@ namespace {
   Register<Timepix3TrigEvent2StdEventConverter>(Timepix3TrigEvent2StdEventConverter::m_id_factory);
 }
 
-long long int Timepix3TrigEvent2StdEventConverter::m_syncTimeTDC(0);
-int Timepix3TrigEvent2StdEventConverter::m_TDCoverflowCounter(0);
+void Timepix3TrigEvent2StdEventConverter::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+  m_streams.clear();
+}
+
 bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
   // Bad event
@@ -21,12 +23,12 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
 
   // Retrieve data from Block 0:
   uint64_t trigdata;
-  auto data = ev->GetBlock(0);
+  auto data = ev->GetBlockView(0);
   if(data.size() / sizeof(uint64_t) > 1) {
     EUDAQ_WARN("Ignoring packet " + std::to_string(ev->GetEventNumber()) + " with unexpected data");
     return false;
   }
-  memcpy(&trigdata, &data[0],data.size());
+  memcpy(&trigdata, data.data(), data.size());
 
   // Get the header (first 4 bits): 0x4 is the "heartbeat" signal, 0xA and 0xB are pixel data
   const uint8_t header = static_cast<uint8_t>((trigdata & 0xF000000000000000) >> 60) & 0xF;
@@ -48,12 +50,14 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
     return false;
   }
 
+  auto& state = m_streams[ev->GetStreamN()];
+
   // if jump back in time is larger than 1 sec, overflow detected...
-  if((m_syncTimeTDC - timestamp_raw) > 0x1312d000) {
-    m_TDCoverflowCounter++;
+  if((state.m_syncTimeTDC - timestamp_raw) > 0x1312d000) {
+    state.m_TDCoverflowCounter++;
   }
-  m_syncTimeTDC = timestamp_raw;
-  timestamp = timestamp_raw + (static_cast<long long int>(m_TDCoverflowCounter) << 35);
+  state.m_syncTimeTDC = timestamp_raw;
+  timestamp = timestamp_raw + (static_cast<long long int>(state.m_TDCoverflowCounter) << 35);
 
   // Calculate timestamp in picoseconds assuming 320 MHz clock:
   uint64_t triggerTime = (timestamp + static_cast<long long int>(stamp) / 12) * 3125;
@@ -64,8 +68,10 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
   return true;
 }
 
-uint64_t Timepix3RawEvent2StdEventConverter::m_syncTime(0);
-bool Timepix3RawEvent2StdEventConverter::m_clearedHeader(false);
+void Timepix3RawEvent2StdEventConverter::BeginRun(uint32_t, eudaq::ConfigurationSPC) {
+  m_streams.clear();
+}
+
 bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
   bool data_found = false;
@@ -76,19 +82,23 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
   }
 
   // Retrieve data from Block 0:
-  std::vector<uint64_t> vpixdata;
-  auto data = ev->GetBlock(0);
-  vpixdata.resize(data.size() / sizeof(uint64_t));
-  memcpy(&vpixdata[0], &data[0], data.size());
+  auto data = ev->GetBlockView(0);
+  auto& state = m_streams[ev->GetStreamN()];
+  size_t n_pixdata = data.size() / sizeof(uint64_t);
 
   // Create a StandardPlane representing one sensor plane
   eudaq::StandardPlane plane(0, "SPIDR", "Timepix3");
-  plane.SetSizeZS(256, 256, 0);
+  plane.SetSizeCompact(256, 256, eudaq::PixelHits::COL_VALUE | eudaq::PixelHits::COL_TIME);
+  auto& hits = plane.Hits();
+  hits.Reserve(n_pixdata);
 
   // Event time stamps, defined by first and last pixel timestamp found in the data block:
   uint64_t event_begin = std::numeric_limits<uint64_t>::max(), event_end = std::numeric_limits<uint64_t>::lowest();
 
-  for(const auto& pixdata : vpixdata) {
+  for(size_t i = 0; i < n_pixdata; i++) {
+    uint64_t pixdata;
+    memcpy(&pixdata, data.data() + i * sizeof(uint64_t), sizeof(pixdata));
+
     // Get the header (first 4 bits): 0x4 is the "heartbeat" signal, 0xA and 0xB are pixel data
     const uint8_t header = static_cast<uint8_t>((pixdata & 0xF000000000000000) >> 60) & 0xF;
 
@@ -108,22 +118,22 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       // 0x4 is the least significant part of the timestamp
       if(header2 == 0x4) {
         // The data is shifted 16 bits to the right, then 12 to the left in order to match the timestamp format (net 4 right)
-        m_syncTime = (m_syncTime & 0xFFFFF00000000000) + ((pixdata & 0x0000FFFFFFFF0000) >> 4);
+        state.m_syncTime = (state.m_syncTime & 0xFFFFF00000000000) + ((pixdata & 0x0000FFFFFFFF0000) >> 4);
       }
       // 0x5 is the most significant part of the timestamp
       if(header2 == 0x5) {
         // The data is shifted 16 bits to the right, then 44 to the left in order to match the timestamp format (net 28 left)
-        m_syncTime = (m_syncTime & 0x00000FFFFFFFFFFF) + ((pixdata & 0x00000000FFFF0000) << 28);
+        state.m_syncTime = (state.m_syncTime & 0x00000FFFFFFFFFFF) + ((pixdata & 0x00000000FFFF0000) << 28);
 
-        if(!m_clearedHeader && (m_syncTime / 4096 / 40) < 6000000) {
-          m_clearedHeader = true;
+        if(!state.m_clearedHeader && (state.m_syncTime / 4096 / 40) < 6000000) {
+          state.m_clearedHeader = true;
         }
       }
     }
 
     // Sometimes there is still data left in the buffers at the start of a run. For that reason we keep skipping data until
     // this "header" data has been cleared, when the heart beat signal starts from a low number (~few seconds max)
-    if(!m_clearedHeader) {
+    if(!state.m_clearedHeader) {
         continue;
     }
 
@@ -146,14 +156,14 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       const uint64_t toa((data & 0x0FFFC000) >> 14);
 
       // Calculate the timestamp.
-      uint64_t time = (((spidrTime << 18) + (toa << 4) + (15 - ftoa)) << 8) + (m_syncTime & 0xFFFFFC0000000000);
+      uint64_t time = (((spidrTime << 18) + (toa << 4) + (15 - ftoa)) << 8) + (state.m_syncTime & 0xFFFFFC0000000000);
 
       // Adjusting phases for double column shift
       time += ((static_cast<uint64_t>(col) / 2 - 1) % 16) * 256;
 
       // The time from the pixels has a maximum value of ~26 seconds. We compare the pixel time to the "heartbeat"
       // signal (which has an overflow of ~4 years) and check if the pixel time has wrapped back around to 0
-      while(static_cast<long long>(m_syncTime) - static_cast<long long>(time) > 0x0000020000000000) {
+      while(static_cast<long long>(state.m_syncTime) - static_cast<long long>(time) > 0x0000020000000000) {
         time += 0x0000040000000000;
       }
 
@@ -165,7 +175,7 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       event_end = (timestamp > event_end) ? timestamp : event_end;
 
       // creating new pixel object with non-calibrated values of tot and toa
-      plane.PushPixel(col, row, tot, timestamp);
+      hits.Push(col, row, static_cast<int32_t>(tot), timestamp);
     }
   }
 
@@ -1,9 +1,49 @@
 #include "eudaq/OptionParser.hh"
 #include "eudaq/FileReader.hh"
 #include "eudaq/StdEventConverter.hh"
+#include "eudaq/EventBatch.hh"
+
+#include "AidaTluRecord.hh"
 
 #include <iostream>
 
+namespace {
+  void PrintTrigger(std::ostream &os, const eudaq::Event &ev, uint32_t eventNumber,
+                    uint32_t triggerNumber, uint64_t timeStampBegin, uint64_t timeStampEnd,
+                    const eudaq::BlockView &record, bool withTags){
+    auto tag = [&](const std::string &name){
+      return withTags ? ev.GetTag(name, "NAN") : std::string("NAN");
+    };
+    os << ev.GetRunNumber() << "," << eventNumber << "," << triggerNumber << ","
+       << timeStampBegin << "," << timeStampEnd << "," << tag("PARTICLES") << ",";
+    // files written before the binary trigger records have tags instead
+    bool binary = record.size() >= tlu::AidaTluRecord::SIZE;
+    tlu::AidaTluRecord rec;
+    if(binary)
+      rec = tlu::AidaTluRecord::Read(record.data());
+    os << (binary ? rec.TriggerString() : tag("TRIGGER"));
+    for(int i = 0; i < 6; i++)
+      os << "," << tag("SCALER" + std::to_string(i));
+    for(int i = 0; i < 6; i++)
+      os << "," << (binary ? std::to_string(rec.finets[i]) : tag("FINE_TS" + std::to_string(i)));
+    os << std::endl;
+  }
+
+  void PrintTlu(std::ostream &os, const eudaq::EventSPC &ev){
+    if(ev->IsFlagBatch()){
+      eudaq::EventBatch batch(ev);
+      for(size_t i = 0; i < batch.Size(); i++)
+        PrintTrigger(os, *ev, ev->GetEventNumber() + i, batch.GetTriggerN(i),
+                     batch.GetTimestampBegin(i), batch.GetTimestampEnd(i),
+                     batch.GetPayload(i), i == 0);
+    }
+    else
+      PrintTrigger(os, *ev, ev->GetEventNumber(), ev->GetTriggerN(),
+                   ev->GetTimestampBegin(), ev->GetTimestampEnd(),
+                   ev->NumBlocks() ? ev->GetBlockView(0) : eudaq::BlockView(), true);
+  }
+}
+
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line FileReader modified for TLU data", "2.1", "EUDAQ FileReader (TLU)");
   eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "input file");
@@ -73,76 +113,14 @@ int main(int /*argc*/, const char **argv) {
     else
       in_range_tsn = true;
 
-    if (ev->GetDescription()=="TluRawDataEvent" && in_range_evn) {
-      auto runNumber = ev->GetRunNumber();
-      auto eventNumber = ev->GetEventNumber();
-      auto triggerNumber = ev->GetTriggerN();
-      auto timeStampBegin = ev->GetTimestampBegin();
-      auto timeStampEnd = ev->GetTimestampEnd();
-      auto particles = ev->GetTag("PARTICLES", "NAN");
-      auto triggersFired = ev->GetTag("TRIGGER", "NAN");
-      auto scaler0 = ev->GetTag("SCALER0", "NAN"); 
-      auto scaler1 = ev->GetTag("SCALER1", "NAN"); 
-      auto scaler2 = ev->GetTag("SCALER2", "NAN");
-      auto scaler3 = ev->GetTag("SCALER3", "NAN");
-      auto scaler4 = ev->GetTag("SCALER4", "NAN");
-      auto scaler5 = ev->GetTag("SCALER5", "NAN");
-      auto finets0 = ev->GetTag("FINE_TS0", "NAN");
-      auto finets1 = ev->GetTag("FINE_TS1", "NAN");
-      auto finets2 = ev->GetTag("FINE_TS2", "NAN");
-      auto finets3 = ev->GetTag("FINE_TS3", "NAN");
-      auto finets4 = ev->GetTag("FINE_TS4", "NAN");
-      auto finets5 = ev->GetTag("FINE_TS5", "NAN");
-      std::cout << runNumber << "," << 
-      		   eventNumber << "," << 
-		   triggerNumber << "," << 
-		   timeStampBegin << "," << 
-		   timeStampEnd << "," << 
-		   particles << "," <<
-		   triggersFired << "," << 
-		   scaler0 << "," << scaler1 << "," << scaler2 << "," << scaler3 << "," << scaler4 << "," << scaler5 << "," << 
-		   finets0 << "," << finets1 << "," << finets2 << "," << finets3 << "," << finets4 << "," << finets5 << 
-		   std::endl;
-      // ev->Print(std::cout);
-    }
+    if (ev->GetDescription()=="TluRawDataEvent" && in_range_evn)
+      PrintTlu(std::cout, ev);
 
     auto subevents = ev->GetSubEvents();
-      for (auto &subev: subevents) {
-        auto subeventDescription = subev->GetDescription();
-        // std::cout<< subeventDescription << std::endl;
-        if (subeventDescription=="TluRawDataEvent" && in_range_evn) {
-	  auto runNumber = subev->GetRunNumber();
-	  auto eventNumber = subev->GetEventNumber();
-	  auto triggerNumber = subev->GetTriggerN();
-	  auto timeStampBegin = subev->GetTimestampBegin();
-	  auto timeStampEnd = subev->GetTimestampEnd();
-          auto particles = subev->GetTag("PARTICLES", "NAN");
-	  auto triggersFired = subev->GetTag("TRIGGER" , "NAN");
-          auto scaler0 = ev->GetTag("SCALER0", "NAN"); 
-          auto scaler1 = ev->GetTag("SCALER1", "NAN"); 
-          auto scaler2 = ev->GetTag("SCALER2", "NAN");
-          auto scaler3 = ev->GetTag("SCALER3", "NAN");
-          auto scaler4 = ev->GetTag("SCALER4", "NAN");
-          auto scaler5 = ev->GetTag("SCALER5", "NAN");
-          auto finets0 = ev->GetTag("FINE_TS0", "NAN");
-          auto finets1 = ev->GetTag("FINE_TS1", "NAN");
-          auto finets2 = ev->GetTag("FINE_TS2", "NAN");
-          auto finets3 = ev->GetTag("FINE_TS3", "NAN");
-          auto finets4 = ev->GetTag("FINE_TS4", "NAN");
-          auto finets5 = ev->GetTag("FINE_TS5", "NAN");
-          std::cout << runNumber << "," << 
-      		   eventNumber << "," << 
-		   triggerNumber << "," << 
-		   timeStampBegin << "," << 
-		   timeStampEnd << "," << 
-		   particles << "," <<
-		   triggersFired << "," << 
-		   scaler0 << "," << scaler1 << "," << scaler2 << "," << scaler3 << "," << scaler4 << "," << scaler5 << "," << 
-		   finets0 << "," << finets1 << "," << finets2 << "," << finets3 << "," << finets4 << "," << finets5 << 
-		   std::endl;
-          //subev->Print(std::cout);
-          }
-        }
+    for (auto &subev: subevents) {
+      if (subev->GetDescription()=="TluRawDataEvent" && in_range_evn)
+        PrintTlu(std::cout, subev);
+    }
       event_count++;
     }
   std::cout << "There are " << event_count << " Events" << std::endl;
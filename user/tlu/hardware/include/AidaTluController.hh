@@ -2,9 +2,11 @@
 #define H_AIDATLUCONTROLLER_HH
 
 #include <deque>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <iostream>
+#include "AidaTluFifo.hh"
 #include "AidaTluI2c.hh"
 #include "AidaTluHardware.hh"
 #include "AidaTluPowerModule.hh"
@@ -21,7 +23,7 @@ namespace tlu {
 
   class fmctludata;
 
-  class AidaTluController {
+  class AidaTluController: public AidaTluFifo {
   public:
     AidaTluController(const std::string & connectionFilename, const std::string & deviceName);
     ~AidaTluController(){ResetEventsBuffer();};
@@ -145,6 +147,9 @@ namespace tlu {
     fmctludata* PopFrontEvent();
     bool IsBufferEmpty(){return m_data.empty();};
     void ReceiveEvents(uint8_t verbose);
+    uint32_t FifoFillLevel() override;
+    uint32_t FifoStatus() override;
+    size_t FifoRead(uint32_t *words, size_t n) override;
     void ResetEventsBuffer();
     void DefineConst(int nDUTs, int nTrigInputs);
     void DumpEventsBuffer();
@@ -200,6 +205,7 @@ namespace tlu {
 
 
     HwInterface * m_hw; //Instance of IPBus
+    std::mutex m_mtx_hw; // IPbus access from the readout and the control thread
     i2cCore *m_i2c; //Instance of I2C
     std::string m_IPaddress;
 
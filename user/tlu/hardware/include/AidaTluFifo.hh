@@ -0,0 +1,28 @@
+#ifndef H_AIDATLUFIFO_HH
+#define H_AIDATLUFIFO_HH
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tlu {
+
+  /*
+    Access to the event FIFO of the AIDA TLU, implemented by the IPbus
+    controller and by a simulation. Every call is one IPbus transaction.
+  */
+  class AidaTluFifo{
+  public:
+    static const uint32_t WORDS_PER_EVENT = 6;
+    static const uint32_t DEPTH = 8192; // words
+
+    virtual ~AidaTluFifo(){};
+    virtual uint32_t FifoFillLevel() = 0;
+    // CSR bits: 0x1 empty, 0x2 almost empty, 0x4 almost full, 0x8 full
+    virtual uint32_t FifoStatus() = 0;
+    // Reads n words into words, returns the number of words read
+    virtual size_t FifoRead(uint32_t *words, size_t n) = 0;
+  };
+
+}
+
+#endif
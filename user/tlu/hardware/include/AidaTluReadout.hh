@@ -0,0 +1,79 @@
+#ifndef H_AIDATLUREADOUT_HH
+#define H_AIDATLUREADOUT_HH
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AidaTluFifo.hh"
+#include "AidaTluController.hh"
+
+namespace tlu {
+
+  /*
+    Reads the event FIFO of the TLU on its own thread into a preallocated
+    ring of raw event words, which the packaging thread consumes.
+    Each poll asks for the fill level and reads all complete events in one
+    block, as many as fit into the ring. The poll interval shrinks while the
+    FIFO fills up and grows while it is empty. The fill level seen by every
+    poll is histogrammed to show how close the readout gets to the FIFO
+    depth. One thread polls, one thread consumes.
+  */
+  class AidaTluReadout{
+  public:
+    static const size_t HISTO_BINS = 64;
+
+    AidaTluReadout(AidaTluFifo &fifo, size_t events = 1<<15);
+    ~AidaTluReadout();
+
+    void Start();
+    // Stops polling after reading what is left in the FIFO
+    void Stop();
+    bool IsRunning() const {return m_running;};
+    void SetMaxInterval(std::chrono::microseconds t){m_max_interval = t;};
+
+    // Waits up to timeout for events, returns the number of events ready
+    size_t Wait(std::chrono::milliseconds timeout);
+    bool Empty() const;
+    fmctludata Front() const;
+    void Pop();
+    // Drops the events in the ring and resets the statistics
+    void Clear();
+
+    std::vector<uint64_t> FifoHistogram() const;
+    uint32_t FifoMaxLevel() const {return m_fifo_max;};
+    uint64_t FifoFullCount() const {return m_fifo_full;};
+    uint64_t RingFullCount() const {return m_ring_full;};
+    uint64_t EventCount() const {return m_head;};
+
+  private:
+    void Running();
+    // Reads one block, returns the number of events read and whether the
+    // FIFO holds more
+    size_t Poll(bool &more);
+
+    AidaTluFifo &m_fifo;
+    std::vector<uint32_t> m_ring;
+    size_t m_events;
+    std::atomic<uint64_t> m_head; // events written by the poll thread
+    std::atomic<uint64_t> m_tail; // events consumed
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_exit;
+    std::thread m_thread;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::chrono::microseconds m_max_interval;
+
+    std::atomic<uint64_t> m_histo[HISTO_BINS];
+    std::atomic<uint32_t> m_fifo_max;
+    std::atomic<uint64_t> m_fifo_full;
+    std::atomic<uint64_t> m_ring_full;
+  };
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef H_AIDATLURECORD_HH
+#define H_AIDATLURECORD_HH
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace tlu {
+
+  /*
+    Binary payload of one AIDA TLU trigger in a TluRawDataEvent (block 0),
+    replacing the TRIGGER, FINE_TS0..5 and TYPE tags. The trigger number and
+    the timestamps are in the event, or in the record header of a batch.
+    Byte 0: event type, byte 1: inputs fired (bit i = input i),
+    bytes 2-7: fine timestamps of inputs 0-5.
+  */
+  struct AidaTluRecord{
+    static const size_t SIZE = 8;
+
+    uint8_t type = 0;
+    uint8_t inputs = 0;
+    uint8_t finets[6] = {0, 0, 0, 0, 0, 0};
+
+    void Write(uint8_t *p) const {
+      p[0] = type;
+      p[1] = inputs;
+      for(size_t i = 0; i < 6; i++)
+        p[2+i] = finets[i];
+    }
+
+    static AidaTluRecord Read(const uint8_t *p){
+      AidaTluRecord r;
+      r.type = p[0];
+      r.inputs = p[1];
+      for(size_t i = 0; i < 6; i++)
+        r.finets[i] = p[2+i];
+      return r;
+    }
+
+    // inputs fired as in the former TRIGGER tag, input 5 first
+    std::string TriggerString() const {
+      std::string s(6, '0');
+      for(size_t i = 0; i < 6; i++)
+        if(inputs & (1 << i))
+          s[5-i] = '1';
+      return s;
+    }
+  };
+
+}
+
+#endif
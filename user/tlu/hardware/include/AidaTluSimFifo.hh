@@ -0,0 +1,54 @@
+#ifndef H_AIDATLUSIMFIFO_HH
+#define H_AIDATLUSIMFIFO_HH
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+
+#include "AidaTluFifo.hh"
+
+namespace tlu {
+
+  /*
+    Stand-in for the IPbus event FIFO, to exercise the readout without a TLU.
+    Triggers arrive at random with the given mean rate and are filled into a
+    FIFO of the hardware depth, triggers finding it full are lost. Every call
+    takes the given transaction latency.
+  */
+  class AidaTluSimFifo: public AidaTluFifo{
+  public:
+    AidaTluSimFifo(double rate_hz, std::chrono::microseconds latency, uint32_t seed = 1);
+
+    uint32_t FifoFillLevel() override;
+    uint32_t FifoStatus() override;
+    size_t FifoRead(uint32_t *words, size_t n) override;
+
+    // Stops the triggers, the FIFO keeps what it holds
+    void Veto(bool veto);
+    // 40 MHz ticks, as the timestamps of the triggers
+    uint64_t CurrentTimestamp();
+    uint64_t TriggerCount();
+    uint64_t LostCount();
+
+  private:
+    void Transaction();
+    void Generate();
+
+    double m_rate;
+    std::chrono::microseconds m_latency;
+    std::mt19937_64 m_rng;
+    std::exponential_distribution<double> m_interval;
+    std::mutex m_mtx;
+    std::deque<uint32_t> m_words;
+    std::chrono::steady_clock::time_point m_start;
+    double m_next; // time of the next trigger, s since m_start
+    bool m_veto;
+    bool m_full;
+    uint64_t m_triggers;
+    uint64_t m_lost;
+  };
+
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <string>
 #include <bitset>
+#include <algorithm>
 #include <iomanip>
 #include "eudaq/Logger.hh"
 
@@ -627,6 +628,7 @@ namespace tlu {
   }
 
   uint32_t AidaTluController::ReadRRegister(const std::string & name) {
+    std::unique_lock<std::mutex> lk(m_mtx_hw);
     try {
       ValWord< uint32_t > test = m_hw->getNode(name).read();
       m_hw->dispatch();
@@ -651,25 +653,46 @@ namespace tlu {
     if (nevent*6 == 0x3FEA) std::cout << "WARNING! fmctlu hardware FIFO is full" << std::endl; //0x7D00 ?
     // if(0){ // no read
     if(nevent){
-      ValVector< uint32_t > fifoContent = m_hw->getNode("eventBuffer.EventFifoData").readBlock(nevent*6);
-      m_hw->dispatch();
-      if(fifoContent.valid()) {
-        if (verbose > 0){
-          std::cout<< "TLU events required: "<<nevent<<" events received: " << fifoContent.size()/6<<std::endl;
-        }
-        if(fifoContent.size()%6 !=0){
-          std::cout<<"receive error"<<std::endl;
-        }
-        for ( std::vector<uint32_t>::const_iterator i ( fifoContent.begin() ); i!=fifoContent.end(); i+=6 ) { //0123
-          m_data.push_back(new fmctludata(*i, *(i+1), *(i+2), *(i+3), *(i+4), *(i+5)));
-          if (verbose > 1){
-            std::cout<< *(m_data.back());
-          }
+      std::vector<uint32_t> fifoContent(nevent*6);
+      fifoContent.resize(FifoRead(fifoContent.data(), fifoContent.size()));
+      if (verbose > 0){
+        std::cout<< "TLU events required: "<<nevent<<" events received: " << fifoContent.size()/6<<std::endl;
+      }
+      if(fifoContent.size()%6 !=0){
+        std::cout<<"receive error"<<std::endl;
+      }
+      for ( std::vector<uint32_t>::const_iterator i ( fifoContent.begin() ); i+6<=fifoContent.end(); i+=6 ) { //0123
+        m_data.push_back(new fmctludata(*i, *(i+1), *(i+2), *(i+3), *(i+4), *(i+5)));
+        if (verbose > 1){
+          std::cout<< *(m_data.back());
         }
       }
     }
   }
 
+  uint32_t AidaTluController::FifoFillLevel(){
+    return GetEventFifoFillLevel();
+  }
+
+  uint32_t AidaTluController::FifoStatus(){
+    return ReadRRegister("eventBuffer.EventFifoCSR");
+  }
+
+  size_t AidaTluController::FifoRead(uint32_t *words, size_t n){
+    std::unique_lock<std::mutex> lk(m_mtx_hw);
+    try {
+      ValVector< uint32_t > fifoContent = m_hw->getNode("eventBuffer.EventFifoData").readBlock(n);
+      m_hw->dispatch();
+      if(!fifoContent.valid())
+        return 0;
+      n = std::min<size_t>(n, fifoContent.size());
+      std::copy(fifoContent.begin(), fifoContent.begin() + n, words);
+      return n;
+    } catch (...) {
+      return 0;
+    }
+  }
+
   void AidaTluController::ResetEventsBuffer(){
     for(auto &&i: m_data){
       delete i;
@@ -1087,6 +1110,7 @@ namespace tlu {
   }
 
   void AidaTluController::SetWRegister(const std::string & name, int value){
+    std::unique_lock<std::mutex> lk(m_mtx_hw);
     try {
       m_hw->getNode(name).write(static_cast< uint32_t >(value));
       m_hw->dispatch();
@@ -0,0 +1,161 @@
+#include "AidaTluReadout.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+
+namespace tlu {
+  namespace{
+    const uint32_t WORDS = AidaTluFifo::WORDS_PER_EVENT;
+    // level of the FIFO's programmable full flag
+    const uint32_t PROG_FULL = 8181;
+  }
+
+  AidaTluReadout::AidaTluReadout(AidaTluFifo &fifo, size_t events)
+    :m_fifo(fifo), m_ring(std::max<size_t>(events, 1)*WORDS), m_events(std::max<size_t>(events, 1)),
+     m_head(0), m_tail(0), m_running(false), m_exit(false), m_max_interval(1000),
+     m_fifo_max(0), m_fifo_full(0), m_ring_full(0){
+    for(auto &h: m_histo)
+      h = 0;
+  }
+
+  AidaTluReadout::~AidaTluReadout(){
+    Stop();
+  }
+
+  void AidaTluReadout::Start(){
+    if(m_thread.joinable())
+      return;
+    m_exit = false;
+    m_running = true;
+    m_thread = std::thread(&AidaTluReadout::Running, this);
+  }
+
+  void AidaTluReadout::Stop(){
+    if(!m_thread.joinable())
+      return;
+    {
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_exit = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+  }
+
+  size_t AidaTluReadout::Poll(bool &more){
+    uint32_t level = m_fifo.FifoFillLevel();
+    m_histo[std::min<size_t>(uint64_t(level)*HISTO_BINS/AidaTluFifo::DEPTH, HISTO_BINS-1)]++;
+    if(level > m_fifo_max)
+      m_fifo_max = level;
+    if(level >= PROG_FULL && (m_fifo.FifoStatus() & 0x8)){
+      uint64_t n = ++m_fifo_full;
+      if(!(n & (n - 1)))
+        EUDAQ_WARN("TLU: hardware event FIFO found full "+std::to_string(n)+" times, triggers were lost");
+    }
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+    size_t avail = level / WORDS;
+    size_t space = m_events - (head - tail);
+    size_t pos = head % m_events;
+    // one contiguous block, the part behind the end of the ring comes next
+    size_t n = std::min(std::min(avail, space), m_events - pos);
+    if(avail && !space)
+      m_ring_full++;
+    if(n){
+      size_t words = m_fifo.FifoRead(&m_ring[pos*WORDS], n*WORDS);
+      if(words % WORDS)
+        EUDAQ_WARN("TLU: incomplete event read from the FIFO");
+      n = words / WORDS;
+      {
+        std::unique_lock<std::mutex> lk(m_mtx);
+        m_head.store(head + n, std::memory_order_release);
+      }
+      m_cv.notify_all();
+    }
+    more = n < avail;
+    return n;
+  }
+
+  void AidaTluReadout::Running(){
+    using us = std::chrono::microseconds;
+    auto last = std::chrono::steady_clock::now();
+    us interval(0);
+    bool more = false;
+    try{
+      while(!m_exit){
+        size_t n = Poll(more);
+        if(more)
+          continue;
+        auto now = std::chrono::steady_clock::now();
+        if(n){
+          // poll again before the FIFO is an eighth full at the current rate
+          auto dt = std::chrono::duration_cast<us>(now - last);
+          interval = std::min(m_max_interval, us(dt.count()*(AidaTluFifo::DEPTH/8/WORDS)/n/2));
+        }
+        else
+          interval = std::min(m_max_interval, std::max(interval*2, us(10)));
+        last = now;
+        std::unique_lock<std::mutex> lk(m_mtx);
+        m_cv.wait_for(lk, interval, [this]{return m_exit.load();});
+      }
+      // triggers are vetoed by now, read the rest as long as the ring takes it
+      size_t n;
+      do
+        n = Poll(more);
+      while(more && n);
+      if(more)
+        EUDAQ_WARN("TLU: readout stopped with events left in the FIFO");
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(std::string("TLU: readout failed: ") + e.what());
+    }
+    {
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_running = false;
+    }
+    m_cv.notify_all();
+  }
+
+  size_t AidaTluReadout::Wait(std::chrono::milliseconds timeout){
+    auto ready = [this]{
+      return m_head.load(std::memory_order_acquire) != m_tail.load(std::memory_order_relaxed) || !m_running;
+    };
+    if(!ready()){
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_cv.wait_for(lk, timeout, ready);
+    }
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+  }
+
+  bool AidaTluReadout::Empty() const{
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+  }
+
+  fmctludata AidaTluReadout::Front() const{
+    const uint32_t *w = &m_ring[(m_tail.load(std::memory_order_relaxed) % m_events)*WORDS];
+    return fmctludata(w[0], w[1], w[2], w[3], w[4], w[5]);
+  }
+
+  void AidaTluReadout::Pop(){
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  void AidaTluReadout::Clear(){
+    if(m_thread.joinable())
+      Stop();
+    m_head = 0;
+    m_tail = 0;
+    for(auto &h: m_histo)
+      h = 0;
+    m_fifo_max = 0;
+    m_fifo_full = 0;
+    m_ring_full = 0;
+  }
+
+  std::vector<uint64_t> AidaTluReadout::FifoHistogram() const{
+    std::vector<uint64_t> h(HISTO_BINS);
+    for(size_t i = 0; i < HISTO_BINS; i++)
+      h[i] = m_histo[i];
+    return h;
+  }
+}
@@ -0,0 +1,99 @@
+#include "AidaTluSimFifo.hh"
+
+#include <algorithm>
+#include <thread>
+
+namespace tlu {
+
+  AidaTluSimFifo::AidaTluSimFifo(double rate_hz, std::chrono::microseconds latency, uint32_t seed)
+    :m_rate(rate_hz), m_latency(latency), m_rng(seed), m_interval(rate_hz > 0 ? rate_hz : 1),
+     m_start(std::chrono::steady_clock::now()), m_veto(false), m_full(false),
+     m_triggers(0), m_lost(0){
+    m_next = m_interval(m_rng);
+  }
+
+  void AidaTluSimFifo::Transaction(){
+    if(m_latency.count())
+      std::this_thread::sleep_for(m_latency);
+  }
+
+  void AidaTluSimFifo::Generate(){
+    double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    if(m_veto || m_rate <= 0){
+      m_next = std::max(m_next, now);
+      return;
+    }
+    for(; m_next <= now; m_next += m_interval(m_rng)){
+      if(m_words.size() + WORDS_PER_EVENT > DEPTH){
+        m_full = true;
+        m_lost++;
+        continue;
+      }
+      // 40 MHz coarse timestamp, words as decoded by fmctludata
+      uint64_t ts = uint64_t(m_next * 4e7);
+      uint32_t inputs = 1 << (m_triggers % 6);
+      uint32_t fine = m_triggers & 0xff;
+      m_words.push_back((0x3u << 28) | (inputs << 16) | uint32_t((ts >> 32) & 0xffff));
+      m_words.push_back(uint32_t(ts));
+      m_words.push_back(fine << 24 | fine << 16 | fine << 8 | fine);
+      m_words.push_back(uint32_t(m_triggers));
+      m_words.push_back(fine << 24 | fine << 16);
+      m_words.push_back(0);
+      m_triggers++;
+    }
+  }
+
+  uint32_t AidaTluSimFifo::FifoFillLevel(){
+    Transaction();
+    std::unique_lock<std::mutex> lk(m_mtx);
+    Generate();
+    return uint32_t(m_words.size());
+  }
+
+  uint32_t AidaTluSimFifo::FifoStatus(){
+    Transaction();
+    std::unique_lock<std::mutex> lk(m_mtx);
+    Generate();
+    uint32_t level = uint32_t(m_words.size());
+    uint32_t csr = 0;
+    if(!level)
+      csr |= 0x1;
+    if(level <= WORDS_PER_EVENT)
+      csr |= 0x2;
+    if(level + WORDS_PER_EVENT >= DEPTH)
+      csr |= 0x4;
+    if(m_full)
+      csr |= 0x8;
+    m_full = false;
+    return csr;
+  }
+
+  size_t AidaTluSimFifo::FifoRead(uint32_t *words, size_t n){
+    Transaction();
+    std::unique_lock<std::mutex> lk(m_mtx);
+    n = std::min(n, m_words.size());
+    std::copy(m_words.begin(), m_words.begin() + n, words);
+    m_words.erase(m_words.begin(), m_words.begin() + n);
+    return n;
+  }
+
+  void AidaTluSimFifo::Veto(bool veto){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    Generate();
+    m_veto = veto;
+  }
+
+  uint64_t AidaTluSimFifo::CurrentTimestamp(){
+    return uint64_t(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() * 4e7);
+  }
+
+  uint64_t AidaTluSimFifo::TriggerCount(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    return m_triggers;
+  }
+
+  uint64_t AidaTluSimFifo::LostCount(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    return m_lost;
+  }
+}
@@ -1,11 +1,16 @@
 #include "eudaq/Producer.hh"
+#include "eudaq/EventBatch.hh"
 
 #include "AidaTluController.hh"
 #include "AidaTluHardware.hh"
 #include "AidaTluPowerModule.hh"
+#include "AidaTluRecord.hh"
+#include "AidaTluReadout.hh"
+#include "AidaTluSimFifo.hh"
 
 #include <iostream>
 #include <ostream>
+#include <atomic>
 #include <vector>
 #include <chrono>
 #include <thread>
@@ -22,6 +27,7 @@ class AidaTluProducer: public eudaq::Producer {
   void DoReset() override;
   void DoStatus() override;
   void RunLoop() override;
+  uint64_t CurrentTimestamp();
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("AidaTluProducer");
 private:
@@ -29,70 +35,140 @@ class AidaTluProducer: public eudaq::Producer {
   std::mutex m_mtx_tlu; //prevent to reset tlu during the RunLoop thread
 
   std::unique_ptr<tlu::AidaTluController> m_tlu;
-  uint64_t m_starttime;
-  uint64_t m_lasttime;
+  std::unique_ptr<tlu::AidaTluSimFifo> m_sim; // replaces m_tlu without hardware
+  std::unique_ptr<tlu::AidaTluReadout> m_readout;
+  std::atomic<uint64_t> m_starttime;
+  std::atomic<uint64_t> m_lasttime;
   double m_duration;
 
   uint8_t m_verbose;
   uint32_t m_delayStart;
+  uint32_t m_batch_size;
+  eudaq::EventBatchWriter m_batch;
 };
 
 namespace{
   auto dummy0 = eudaq::Factory<eudaq::Producer>::
     Register<AidaTluProducer, const std::string&, const std::string&>(AidaTluProducer::m_id_factory);
+
+  // polls seen at each eighth of the FIFO depth
+  std::string FifoOccupancy(const tlu::AidaTluReadout &readout){
+    auto histo = readout.FifoHistogram();
+    std::string s;
+    for(size_t i = 0; i < 8; i++){
+      uint64_t n = 0;
+      for(size_t j = i*histo.size()/8; j < (i+1)*histo.size()/8; j++)
+        n += histo[j];
+      s += (i ? ":" : "") + std::to_string(n);
+    }
+    return s;
+  }
 }
 
 
 AidaTluProducer::AidaTluProducer(const std::string name, const std::string &runcontrol)
-  :eudaq::Producer(name, runcontrol){
+  :eudaq::Producer(name, runcontrol), m_batch(tlu::AidaTluRecord::SIZE){
   m_duration = 0;
+  m_batch_size = 1;
   m_starttime = 0;
   m_lasttime = 0;
 }
 
+uint64_t AidaTluProducer::CurrentTimestamp(){
+  return m_tlu ? m_tlu->GetCurrentTimestamp() : m_sim->CurrentTimestamp();
+}
+
 void AidaTluProducer::RunLoop(){
   std::unique_lock<std::mutex> lk(m_mtx_tlu);
   bool isbegin = true;
-  m_tlu->ResetCounters();
-  m_tlu->ResetEventsBuffer();
-  m_tlu->ResetFIFO();
+  m_readout->Clear();
+  if(m_tlu){
+    m_tlu->ResetCounters();
+    m_tlu->ResetEventsBuffer();
+    m_tlu->ResetFIFO();
+  }
 
   // Pause the TLU to allow slow devices to get ready after the euRunControl has
   // issued the DoStart() command
   std::this_thread::sleep_for( std::chrono::milliseconds( m_delayStart ) );
 
-  // Send reset pulse to all DUTs and reset internal counters
-  m_tlu->SetRunActive(1, 1);
+  if(m_tlu){
+    // Send reset pulse to all DUTs and reset internal counters
+    m_tlu->SetRunActive(1, 1);
 
-  // Enable triggers
-  m_tlu->SetTriggerVeto(0, m_verbose);
-
-  while(!m_exit_of_run) {
-    m_lasttime=m_tlu->GetCurrentTimestamp()*25;
-    if(isbegin) m_starttime = m_lasttime;
-    m_tlu->ReceiveEvents(m_verbose);
-    while (!m_tlu->IsBufferEmpty()){
-      tlu::fmctludata *data = m_tlu->PopFrontEvent();
-      uint32_t trigger_n = data->eventnumber;
-      uint64_t ts_raw = data->timestamp;
+    // Enable triggers
+    m_tlu->SetTriggerVeto(0, m_verbose);
+  }
+  else
+    m_sim->Veto(false);
+
+  // The FIFO is read on the readout thread, this one packages the events
+  m_readout->Start();
+  m_starttime = CurrentTimestamp()*25;
+  m_lasttime = m_starttime.load();
+  auto scaler_time = std::chrono::steady_clock::now();
+  bool stopping = false;
+  bool eore_sent = false;
+  while(true){
+    if(m_exit_of_run && !stopping){
+      stopping = true;
+      if(m_tlu)
+        m_tlu->SetTriggerVeto(1, m_verbose);
+      else
+        m_sim->Veto(true);
+      // reads what is left in the FIFO
+      m_readout->Stop();
+    }
+    if(!m_readout->Wait(std::chrono::milliseconds(100))){
+      if(stopping)
+        break;
+      if(!m_readout->IsRunning()) // failed, the error is logged
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      m_lasttime = CurrentTimestamp()*25;
+      continue;
+    }
+    while (!m_readout->Empty()){
+      tlu::fmctludata data = m_readout->Front();
+      m_readout->Pop();
+      uint32_t trigger_n = data.eventnumber;
+      uint64_t ts_raw = data.timestamp;
       uint64_t ts_ns = ts_raw*25;
-      auto ev = eudaq::Event::MakeUnique("TluRawDataEvent");
-      ev->SetTimestamp(ts_ns, ts_ns+25, false);
-      ev->SetTriggerN(trigger_n);
-
-      std::stringstream triggerss;
-      //triggerss<< data->input5 << data->input4 << data->input3 << data->input2 << data->input1 << data->input0;
-      triggerss<< std::to_string(data->input5) << std::to_string(data->input4) << std::to_string(data->input3) << std::to_string(data->input2) << std::to_string(data->input1) << std::to_string(data->input0);
-      ev->SetTag("TRIGGER", triggerss.str());
-      ev->SetTag("FINE_TS0", std::to_string(data->sc0));
-      ev->SetTag("FINE_TS1", std::to_string(data->sc1));
-      ev->SetTag("FINE_TS2", std::to_string(data->sc2));
-      ev->SetTag("FINE_TS3", std::to_string(data->sc3));
-      ev->SetTag("FINE_TS4", std::to_string(data->sc4));
-      ev->SetTag("FINE_TS5", std::to_string(data->sc5));
-      ev->SetTag("TYPE", std::to_string(data->eventtype));
-
-      if(m_tlu->IsBufferEmpty()){
+      m_lasttime = ts_ns;
+      tlu::AidaTluRecord rec;
+      rec.type = data.eventtype;
+      rec.inputs = data.input0 | data.input1<<1 | data.input2<<2 |
+        data.input3<<3 | data.input4<<4 | data.input5<<5;
+      rec.finets[0] = data.sc0;
+      rec.finets[1] = data.sc1;
+      rec.finets[2] = data.sc2;
+      rec.finets[3] = data.sc3;
+      rec.finets[4] = data.sc4;
+      rec.finets[5] = data.sc5;
+
+      eudaq::EventUP ev;
+      if(m_batch_size > 1){
+        // send when the batch is full or the readout buffer is drained
+        rec.Write(m_batch.Add(trigger_n, ts_ns, ts_ns+25));
+        if(m_batch.Size() < m_batch_size && !m_readout->Empty())
+          continue;
+        ev = eudaq::Event::MakeUnique("TluRawDataEvent");
+        m_batch.Fill(*ev);
+        ev->ClearFlagBit(eudaq::Event::FLAG_TIME);
+      }
+      else{
+        ev = eudaq::Event::MakeUnique("TluRawDataEvent");
+        ev->SetTimestamp(ts_ns, ts_ns+25, false);
+        ev->SetTriggerN(trigger_n);
+        uint8_t block[tlu::AidaTluRecord::SIZE];
+        rec.Write(block);
+        ev->AddBlock(0, block, sizeof(block));
+      }
+
+      // the readout has stopped, this is the last event of the run
+      bool last = stopping && m_readout->Empty();
+      auto now = std::chrono::steady_clock::now();
+      if(m_tlu && m_readout->Empty() && (last || now - scaler_time >= std::chrono::seconds(1))){
+        scaler_time = now;
       	uint32_t sl0,sl1,sl2,sl3, sl4, sl5, pt;
       	m_tlu->GetScaler(sl0,sl1,sl2,sl3,sl4,sl5);
       	pt=m_tlu->GetPreVetoTriggers();
@@ -103,24 +179,41 @@ void AidaTluProducer::RunLoop(){
       	ev->SetTag("SCALER3", std::to_string(sl3));
         ev->SetTag("SCALER4", std::to_string(sl4));
         ev->SetTag("SCALER5", std::to_string(sl5));
-        if(m_exit_of_run){
-          ev->SetEORE();
-        }
+      }
+      if(last){
+        ev->SetEORE();
+        eore_sent = true;
       }
 
       if(isbegin){
         isbegin = false;
 	      ev->SetBORE();
-        ev->SetTag("FirmwareID", std::to_string(m_tlu->GetFirmwareVersion()));
-        ev->SetTag("BoardID", std::to_string(m_tlu->GetBoardID()));
+        if(m_tlu){
+          ev->SetTag("FirmwareID", std::to_string(m_tlu->GetFirmwareVersion()));
+          ev->SetTag("BoardID", std::to_string(m_tlu->GetBoardID()));
+        }
       }
       SendEvent(std::move(ev));
-      delete data;
     }
   }
-  m_tlu->SetTriggerVeto(1, m_verbose);
-  // Set TLU internal logic to stop.
-  m_tlu->SetRunActive(0, 1);
+  if(!eore_sent){
+    // no trigger came after the veto, the end of run is sent without data
+    auto ev = eudaq::Event::MakeUnique("TluRawDataEvent");
+    ev->SetEORE();
+    if(isbegin)
+      ev->SetBORE();
+    SendEvent(std::move(ev));
+  }
+  if(m_tlu){
+    // Set TLU internal logic to stop.
+    m_tlu->SetRunActive(0, 1);
+  }
+  EUDAQ_INFO("TLU FIFO: max. level " + std::to_string(m_readout->FifoMaxLevel()) + "/" +
+             std::to_string(tlu::AidaTluFifo::DEPTH) + ", full " + std::to_string(m_readout->FifoFullCount()) +
+             " times, polls per eighth of the depth " + FifoOccupancy(*m_readout));
+  if(m_readout->RingFullCount())
+    EUDAQ_WARN("TLU: readout buffer full in " + std::to_string(m_readout->RingFullCount()) +
+               " polls, increase ReadoutBufferSize");
 }
 
 void AidaTluProducer::DoInitialise(){
@@ -136,7 +229,19 @@ void AidaTluProducer::DoInitialise(){
   std::string uhal_node;
   uhal_conn = ini->Get("ConnectionFile", uhal_conn);
   uhal_node = ini->Get("DeviceName",uhal_node);
+  m_readout.reset();
+  m_tlu.reset();
+  m_sim.reset();
+  double sim_rate = ini->Get("SimulateTriggerRate", 0.0);
+  if(sim_rate > 0){
+    m_sim.reset(new tlu::AidaTluSimFifo(sim_rate, std::chrono::microseconds(ini->Get("SimulateLatency", 100))));
+    m_sim->Veto(true);
+    m_readout.reset(new tlu::AidaTluReadout(*m_sim, ini->Get("ReadoutBufferSize", 1<<15)));
+    EUDAQ_INFO("TLU SIMULATED WITH " + std::to_string(sim_rate) + " Hz OF TRIGGERS");
+    return;
+  }
   m_tlu = std::unique_ptr<tlu::AidaTluController>(new tlu::AidaTluController(uhal_conn, uhal_node));
+  m_readout.reset(new tlu::AidaTluReadout(*m_tlu, ini->Get("ReadoutBufferSize", 1<<15)));
 
   if( ini->Get("skipini", false) ){
     EUDAQ_INFO("TLU SKIPPING INITIALIZATION (skipini = 1)");
@@ -207,7 +312,12 @@ void AidaTluProducer::DoConfigure() {
   EUDAQ_INFO("TLU VERBOSITY SET TO: " + std::to_string(m_verbose));
   m_delayStart = conf->Get("delayStart", 0);
   EUDAQ_INFO("TLU DELAY START SET TO: " + std::to_string(m_delayStart) + " ms");
+  m_batch_size = conf->Get("BatchSize", 1);
+  EUDAQ_INFO("TLU TRIGGERS PER EVENT SET TO: " + std::to_string(m_batch_size));
+  m_readout->SetMaxInterval(std::chrono::microseconds(conf->Get("ReadoutMaxInterval", 1000)));
 
+  if(!m_tlu)
+    return;
   m_tlu->SetTriggerVeto(1, m_verbose);
   if( conf->Get("skipconf", false) ){
     EUDAQ_INFO("TLU SKIPPING CONFIGURATION (skipconf = 1)");
@@ -313,21 +423,32 @@ void AidaTluProducer::DoReset(){
   m_exit_of_run = true;
   EUDAQ_INFO("TLU RESET command received");
   std::unique_lock<std::mutex> lk(m_mtx_tlu); //waiting for the runloop's return
+  m_readout.reset();
   m_tlu.reset();
+  m_sim.reset();
 }
 
 void AidaTluProducer::DoStatus() {
-  if (m_tlu) {
+  if (m_tlu || m_sim) {
     m_duration = double(m_lasttime - m_starttime) / 1000000000; // in seconds
-    uint32_t sl0, sl1, sl2, sl3, sl4, sl5, pret, post;
-    pret = m_tlu->GetPreVetoTriggers();
-    post = m_tlu->GetPostVetoTriggers();
-    m_tlu->GetScaler(sl0, sl1, sl2, sl3, sl4, sl5);
-    //Is tlu controller safe to be accessed by 2 threads (RunLoop and DoStatus) at some time?
+    uint32_t sl0 = 0, sl1 = 0, sl2 = 0, sl3 = 0, sl4 = 0, sl5 = 0, pret, post;
+    if (m_tlu) {
+      pret = m_tlu->GetPreVetoTriggers();
+      post = m_tlu->GetPostVetoTriggers();
+      m_tlu->GetScaler(sl0, sl1, sl2, sl3, sl4, sl5);
+    }
+    else {
+      pret = m_sim->TriggerCount();
+      post = pret - m_sim->LostCount();
+    }
     SetStatusTag("IDTrig", std::to_string(post));
     SetStatusTag("Freq. (avg.) [kHz]", std::to_string(post/m_duration/1000));
     SetStatusTag("Run duration [s]", std::to_string(m_duration));
     SetStatusTag("Particles", std::to_string(pret));
     SetStatusTag("Scaler", std::to_string(sl0) + ":" + std::to_string(sl1) + ":" + std::to_string(sl2) + ":" + std::to_string(sl3) + ":" + std::to_string(sl4) + ":" + std::to_string(sl5));
   }
+  if (m_readout) {
+    SetStatusTag("FIFO max. level", std::to_string(m_readout->FifoMaxLevel()) + "/" + std::to_string(tlu::AidaTluFifo::DEPTH));
+    SetStatusTag("FIFO occupancy [1/8]", FifoOccupancy(*m_readout));
+  }
 }
@@ -1,5 +1,6 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "eudaq/EventBatch.hh"
 
 class TluRawEvent2StdEventConverter: public eudaq::StdEventConverter{
 public:
@@ -30,6 +31,12 @@ bool TluRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standa
     d2->SetTag(TLU+stm+"_TRG", std::to_string(d1->GetTriggerN()));
   }
 
+  // An unsplit batch of triggers spans from its first to its last trigger
+  if(d1->IsFlagBatch()){
+    d2->SetTag("TLU_TRIGGERS", std::to_string(eudaq::EventBatch(d1).Size()));
+    d2->ClearFlagBit(eudaq::Event::FLAG_BATCH);
+  }
+
   // Set times for StdEvent in picoseconds (timestamps provided in nanoseconds):
   d2->SetTimeBegin(d1->GetTimestampBegin() * 1000);
   d2->SetTimeEnd(d1->GetTimestampEnd() * 1000);
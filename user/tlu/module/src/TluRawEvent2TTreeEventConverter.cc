@@ -0,0 +1,75 @@
+#include "eudaq/TTreeEventConverter.hh"
+#include "eudaq/EventBatch.hh"
+#include "eudaq/RawEvent.hh"
+
+#include "AidaTluRecord.hh"
+
+class TluRawEvent2TTreeEventConverter: public eudaq::TTreeEventConverter{
+public:
+  bool Converting(eudaq::EventSPC d1, eudaq::TTreeEventSP d2, eudaq::ConfigSPC conf) const override;
+  static const uint32_t m_id_factory = eudaq::cstr2hash("TluRawDataEvent");
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::TTreeEventConverter>::
+    Register<TluRawEvent2TTreeEventConverter>(TluRawEvent2TTreeEventConverter::m_id_factory);
+
+  // one tree entry per trigger
+  struct TluBranches{
+    UInt_t trigger_n;
+    ULong64_t ts_begin;
+    ULong64_t ts_end;
+    UChar_t type;
+    UChar_t inputs;
+    UChar_t finets[6];
+  };
+
+  void SetBranches(TTree &tree, TluBranches &b){
+    if(tree.GetListOfBranches()->FindObject("tlu_trigger_n")){
+      tree.SetBranchAddress("tlu_trigger_n", &b.trigger_n);
+      tree.SetBranchAddress("tlu_ts_begin", &b.ts_begin);
+      tree.SetBranchAddress("tlu_ts_end", &b.ts_end);
+      tree.SetBranchAddress("tlu_type", &b.type);
+      tree.SetBranchAddress("tlu_inputs", &b.inputs);
+      tree.SetBranchAddress("tlu_finets", b.finets);
+    }
+    else{
+      tree.Branch("tlu_trigger_n", &b.trigger_n, "tlu_trigger_n/i");
+      tree.Branch("tlu_ts_begin", &b.ts_begin, "tlu_ts_begin/l");
+      tree.Branch("tlu_ts_end", &b.ts_end, "tlu_ts_end/l");
+      tree.Branch("tlu_type", &b.type, "tlu_type/b");
+      tree.Branch("tlu_inputs", &b.inputs, "tlu_inputs/b");
+      tree.Branch("tlu_finets", b.finets, "tlu_finets[6]/b");
+    }
+  }
+
+  void Fill(TTree &tree, TluBranches &b, uint32_t tg, uint64_t tsb, uint64_t tse,
+            const eudaq::BlockView &payload){
+    if(payload.size() < tlu::AidaTluRecord::SIZE)
+      return;
+    auto rec = tlu::AidaTluRecord::Read(payload.data());
+    b.trigger_n = tg;
+    b.ts_begin = tsb;
+    b.ts_end = tse;
+    b.type = rec.type;
+    b.inputs = rec.inputs;
+    for(size_t i = 0; i < 6; i++)
+      b.finets[i] = rec.finets[i];
+    tree.Fill();
+  }
+}
+
+bool TluRawEvent2TTreeEventConverter::Converting(eudaq::EventSPC d1, eudaq::TTreeEventSP d2, eudaq::ConfigSPC conf) const{
+  static thread_local TluBranches b;
+  SetBranches(*d2, b);
+  if(d1->IsFlagBatch()){
+    eudaq::EventBatch batch(d1);
+    for(size_t i = 0; i < batch.Size(); i++)
+      Fill(*d2, b, batch.GetTriggerN(i), batch.GetTimestampBegin(i),
+           batch.GetTimestampEnd(i), batch.GetPayload(i));
+  }
+  else if(d1->NumBlocks())
+    Fill(*d2, b, d1->GetTriggerN(), d1->GetTimestampBegin(),
+         d1->GetTimestampEnd(), d1->GetBlockView(0));
+  return true;
+}